@@ -0,0 +1,67 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+const size_t mirror::value_arena::default_chunk_size;
+
+mirror::value_arena::value_arena(
+    size_t chunk_size
+) : m_cur(0), m_end(0), m_chunk_size(chunk_size), m_reserved(0) {
+    assert(chunk_size > 0);
+}
+
+mirror::value_arena::~value_arena() {
+    release();
+}
+
+void mirror::value_arena::release() {
+    for(auto&& c : m_chunks) { std::free(c); }
+    m_chunks.clear();
+    m_cur = m_end = 0;
+    m_reserved = 0;
+}
+
+void* mirror::value_arena::allocate_chunk(
+    size_t size,
+    size_t align
+) {
+    // oversized requests get a chunk on their own; the current chunk
+    // stays active for the following small allocations
+    auto chunk_size = std::max(m_chunk_size, size + align);
+    auto chunk = std::malloc(chunk_size);
+    if(!chunk) { throw std::bad_alloc(); }
+    m_chunks.push_back(chunk);
+    m_reserved += chunk_size;
+
+    auto begin = reinterpret_cast<uintptr_t>(chunk);
+    auto p = ((begin + (align - 1)) & ~static_cast<uintptr_t>(align - 1));
+    if(chunk_size == m_chunk_size) {
+        m_cur = p + size;
+        m_end = begin + chunk_size;
+    }
+    return reinterpret_cast<void*>(p);
+}
@@ -0,0 +1,113 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include "mirror-cpp.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace mirror {
+
+    /// A monotonic allocator: memory is handed out from large chunks by
+    /// bumping a pointer, deallocation is a no-op, and all chunks are
+    /// released at once when the arena gets destroyed (or `release()`d).
+    ///
+    /// An arena makes building a value tree cheap and turns the frees of
+    /// its nodes into no-ops; strings copy their characters into the arena
+    /// and are not reference counted, while tearing down the arrays and
+    /// dicts still runs the destructor (and the reference count decrement)
+    /// of every node. All values allocated from an arena need to be
+    /// destroyed before the arena itself. An arena must not be
+    /// used from several threads at once.
+    struct MIRROR_API value_arena {
+        static const size_t default_chunk_size = 64 * 1024;
+
+        explicit value_arena(size_t chunk_size = default_chunk_size);
+        ~value_arena();
+
+        inline void* allocate(size_t size, size_t align) {
+            assert((align & (align - 1)) == 0);
+            auto p = ((m_cur + (align - 1)) & ~static_cast<uintptr_t>(align - 1));
+            if(p + size > m_end) { return allocate_chunk(size, align); }
+            m_cur = p + size;
+            return reinterpret_cast<void*>(p);
+        }
+
+        /// Frees all chunks; all values allocated from this arena need to be
+        /// destroyed already.
+        void release();
+
+        inline size_t chunk_count()     const { return m_chunks.size(); }
+        inline size_t bytes_reserved()  const { return m_reserved; }
+
+    private:
+        value_arena(value_arena const&) = delete;
+        value_arena& operator=(value_arena const&) = delete;
+
+        void* allocate_chunk(size_t size, size_t align);
+
+        uintptr_t           m_cur;
+        uintptr_t           m_end;
+        size_t const        m_chunk_size;
+        size_t              m_reserved;
+        std::vector<void*>  m_chunks;
+    };
+
+    /// A (C++11 style) polymorphic allocator: allocates from the given
+    /// `value_arena`, or from the global heap if no arena is set.
+    template<typename T>
+    struct arena_allocator {
+        typedef T value_type;
+
+        inline arena_allocator() MIRROR_CPP_NOEXCEPT : m_arena(nullptr) { }
+        inline explicit arena_allocator(value_arena* a) MIRROR_CPP_NOEXCEPT : m_arena(a) { }
+
+        template<typename U>
+        inline arena_allocator(arena_allocator<U> const& o) MIRROR_CPP_NOEXCEPT : m_arena(o.arena()) { }
+
+        inline T* allocate(size_t n) {
+            if(m_arena) { return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T))); }
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        inline void deallocate(T* p, size_t) MIRROR_CPP_NOEXCEPT {
+            if(!m_arena) { ::operator delete(p); }
+        }
+
+        inline value_arena* arena() const MIRROR_CPP_NOEXCEPT { return m_arena; }
+
+        template<typename U>
+        inline bool operator==(arena_allocator<U> const& o) const MIRROR_CPP_NOEXCEPT { return (m_arena == o.arena()); }
+        template<typename U>
+        inline bool operator!=(arena_allocator<U> const& o) const MIRROR_CPP_NOEXCEPT { return (m_arena != o.arena()); }
+
+    private:
+        value_arena* m_arena; // no owning pointer
+    };
+
+} // namespace mirror
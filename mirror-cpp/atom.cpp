@@ -0,0 +1,169 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "atom.hpp"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+    // the symbol table is split into several independently locked shards
+    // to reduce contention if many threads intern strings concurrently
+    static const size_t SHARD_COUNT = 16;
+
+    inline uint64_t hash_of(char const* s, size_t len) {
+        auto h = uint64_t(14695981039346656037ull); // FNV-1a
+        for(size_t i = 0; i < len; ++i) { h = (h ^ static_cast<unsigned char>(s[i])) * 1099511628211ull; }
+        return h;
+    }
+
+    // Lookups never lock or allocate: each shard publishes an open
+    // addressing index whose slots are filled at most once (and never
+    // changed or cleared afterwards), so a reader sees either an empty slot
+    // or a complete entry. Writers fill slots under the shard mutex and
+    // publish a bigger copy of the index once it gets half full; replaced
+    // indexes stay alive with the shard since readers might still probe
+    // them (all of them together are smaller than the current one).
+    template<typename ENTRY>
+    struct symbol_table {
+        struct index {
+            inline explicit index(size_t capacity) : mask(capacity - 1), count(0), slots(new std::atomic<ENTRY const*>[capacity]) {
+                for(size_t i = 0; i < capacity; ++i) { slots[i].store(nullptr, std::memory_order_relaxed); }
+            }
+
+            inline ENTRY const* find(uint64_t h, char const* s, size_t len) const {
+                for(auto i = size_t(h >> 4);; ++i) {
+                    auto e = slots[i & mask].load(std::memory_order_acquire);
+                    if(!e) { return nullptr; }
+                    if((e->str.size() == len) && (std::memcmp(e->str.data(), s, len) == 0)) { return e; }
+                }
+            }
+
+            // writers only
+            inline void insert(uint64_t h, ENTRY const* e) {
+                auto i = size_t(h >> 4);
+                while(slots[i & mask].load(std::memory_order_relaxed)) { ++i; }
+                slots[i & mask].store(e, std::memory_order_release);
+                ++count;
+            }
+
+            size_t const                                    mask;
+            size_t                                          count;
+            std::unique_ptr<std::atomic<ENTRY const*>[]>    slots;
+        };
+
+        struct shard {
+            inline shard() : current(nullptr) {
+                indexes.emplace_back(new index(64));
+                current.store(indexes.back().get(), std::memory_order_release);
+            }
+
+            std::mutex                          mutex;
+            std::deque<ENTRY>                   entries; // stable addresses
+            std::vector<std::unique_ptr<index>> indexes; // the last one is `current`
+            std::atomic<index const*>           current;
+        };
+
+        std::atomic<uint32_t>   next_id;
+        shard                   shards[SHARD_COUNT];
+
+        inline symbol_table() : next_id(1) { }
+
+        // the low bits pick the shard, the remaining ones the slot
+        inline shard& shard_for(uint64_t h) { return shards[h % SHARD_COUNT]; }
+
+        inline ENTRY const* find(char const* s, size_t len) {
+            auto h = hash_of(s, len);
+            return shard_for(h).current.load(std::memory_order_acquire)->find(h, s, len);
+        }
+
+        inline ENTRY const* intern(char const* s, size_t len) {
+            auto h = hash_of(s, len);
+            auto& sh = shard_for(h);
+            if(auto e = sh.current.load(std::memory_order_acquire)->find(h, s, len)) { return e; }
+
+            std::lock_guard<std::mutex> lock(sh.mutex);
+            auto idx = sh.indexes.back().get();
+            if(auto e = idx->find(h, s, len)) { return e; }
+
+            auto id = next_id.fetch_add(1);
+            sh.entries.push_back(ENTRY{ std::string(s, len), id });
+            auto e = &sh.entries.back();
+
+            if(2 * (idx->count + 1) > idx->mask + 1) {
+                auto bigger = std::unique_ptr<index>(new index(2 * (idx->mask + 1)));
+                for(auto&& x : sh.entries) { bigger->insert(hash_of(x.str.data(), x.str.size()), &x); }
+                sh.indexes.push_back(std::move(bigger));
+                sh.current.store(sh.indexes.back().get(), std::memory_order_release);
+            } else {
+                idx->insert(h, e);
+            }
+            return e;
+        }
+    };
+
+} // namespace
+
+template<typename ENTRY>
+static symbol_table<ENTRY>& table() {
+    static symbol_table<ENTRY> t;
+    return t;
+}
+
+bool mirror::atom::find(
+    std::string const& s,
+    atom& result
+) {
+    return find(s.data(), s.size(), result);
+}
+
+bool mirror::atom::find(
+    char const* s,
+    size_t len,
+    atom& result
+) {
+    if(len == 0) { result = atom(); return true; }
+
+    auto e = table<entry>().find(s, len);
+    if(!e) { return false; }
+
+    result.m_entry = e;
+    return true;
+}
+
+mirror::atom::entry const* mirror::atom::intern(
+    char const* s,
+    size_t len
+) {
+    if(len == 0) { return nullptr; }
+    return table<entry>().intern(s, len);
+}
+
+std::string const& mirror::atom::empty_string() {
+    static const std::string s;
+    return s;
+}
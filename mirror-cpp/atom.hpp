@@ -0,0 +1,133 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include "mirror-cpp.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace mirror {
+
+    /// An interned string. All atoms created from equal strings share the
+    /// same entry in a global (thread-safe) symbol table, so comparing two
+    /// atoms is a single pointer compare and copying one is free. Interned
+    /// strings live until the end of the process. Looking up (or creating an
+    /// atom for) an already interned string never locks or allocates; only
+    /// interning a new string locks a shard of the table.
+    ///
+    /// The default constructed atom represents the empty string and has the
+    /// id 0; all other atoms get a unique id > 0 in the order they have been
+    /// interned first.
+    struct MIRROR_API atom {
+        inline atom() : m_entry(nullptr) { }
+        inline atom(std::string const& s) : m_entry(intern(s.data(), s.size())) { }
+        inline atom(char const* s) : m_entry(s ? intern(s, std::char_traits<char>::length(s)) : nullptr) { }
+        inline atom(char const* s, size_t len) : m_entry(intern(s, len)) { }
+
+        /// Looks up an already interned string without adding it to the
+        /// symbol table; returns `false` if `s` has never been interned.
+        static bool find(std::string const& s, atom& result);
+        static bool find(char const* s, size_t len, atom& result);
+        static inline bool find(char const* s, atom& result) { return find(s, (s ? std::char_traits<char>::length(s) : 0), result); }
+
+        inline uint32_t             id()    const { return (m_entry ? m_entry->id : 0); }
+        inline std::string const&   str()   const { return (m_entry ? m_entry->str : empty_string()); }
+        inline bool                 empty() const { return (m_entry == nullptr); }
+
+        inline operator std::string const&() const { return str(); }
+
+        inline bool operator==(atom const& o) const { return (m_entry == o.m_entry); }
+        inline bool operator!=(atom const& o) const { return (m_entry != o.m_entry); }
+        inline bool operator< (atom const& o) const { return ((m_entry != o.m_entry) && (str() < o.str())); } ///< lexicographic, independent of the intern order
+
+    private:
+        struct entry {
+            std::string const   str;
+            uint32_t const      id;
+        };
+
+        static entry const* intern(char const* s, size_t len);
+        static std::string const& empty_string();
+
+        entry const* m_entry; // no owning pointer
+    };
+
+    inline bool operator==(atom const& a, std::string const& b) { return (a.str() == b); }
+    inline bool operator==(std::string const& a, atom const& b) { return (a == b.str()); }
+    inline bool operator==(atom const& a, char const* b)        { return (a.str() == b); }
+    inline bool operator==(char const* a, atom const& b)        { return (a == b.str()); }
+    inline bool operator!=(atom const& a, std::string const& b) { return !(a == b); }
+    inline bool operator!=(std::string const& a, atom const& b) { return !(a == b); }
+    inline bool operator!=(atom const& a, char const* b)        { return !(a == b); }
+    inline bool operator!=(char const* a, atom const& b)        { return !(a == b); }
+
+    inline std::ostream& operator<<(std::ostream& os, atom const& a) { return (os << a.str()); }
+
+    /// Small direct mapped cache in front of the global symbol table for
+    /// interning many repeated strings, e.g. the dict keys of a document
+    /// while parsing it. Not thread-safe; meant to live for the
+    /// duration of a single parse/decode.
+    struct atom_cache {
+        inline atom get(char const* s, size_t n) {
+            auto h = uint32_t(2166136261u); // FNV-1a
+            for(size_t i = 0; i < n; ++i) { h = (h ^ static_cast<unsigned char>(s[i])) * 16777619u; }
+
+            auto& e = m_entries[h & (SIZE - 1)];
+            if((e.hash == h) && (e.key.str().size() == n) && (std::memcmp(e.key.str().data(), s, n) == 0)) {
+                return e.key;
+            }
+
+            e.hash = h;
+            e.key = atom(s, n);
+            return e.key;
+        }
+
+    private:
+        static const size_t SIZE = 256;
+
+        struct entry {
+            inline entry() : hash(0) { }
+
+            uint32_t    hash;
+            atom        key;
+        };
+
+        entry m_entries[SIZE];
+    };
+
+} // namespace mirror
+
+namespace std {
+
+    template<>
+    struct hash<mirror::atom> {
+        // the ids are dense and unique, so they are a perfect hash by themselves
+        inline size_t operator()(mirror::atom const& a) const { return a.id(); }
+    };
+
+} // namespace std
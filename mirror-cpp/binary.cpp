@@ -0,0 +1,816 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "binary.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(WIN32)
+#   include <windows.h>
+#else // defined(WIN32)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif // defined(WIN32)
+
+namespace {
+
+    using mirror::binary_tag;
+
+    static const char   MAGIC[]         = { 'M', 'R', 'B' };
+    static const size_t HEADER_SIZE     = 4;
+    static const int    MAX_DEPTH       = 512;
+
+    inline uint8_t tag_byte(binary_tag t) { return static_cast<uint8_t>(t); }
+
+    inline size_t varint_size(uint64_t v) {
+        size_t n = 1;
+        while(v >= 0x80) { v >>= 7; ++n; }
+        return n;
+    }
+
+    inline uint64_t zigzag(int64_t v)    { return ((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+    inline int64_t  unzigzag(uint64_t v) { return static_cast<int64_t>((v >> 1) ^ (0 - (v & 1))); }
+
+    inline char* put_varint(char* p, uint64_t v) {
+        while(v >= 0x80) { *p++ = static_cast<char>((v & 0x7F) | 0x80); v >>= 7; }
+        *p++ = static_cast<char>(v);
+        return p;
+    }
+
+    // byte wise stores/loads get combined into single (unaligned) moves on
+    // little endian targets and stay correct on big endian ones
+    inline char* put_uint(char* p, uint64_t v, size_t width) {
+        for(size_t i = 0; i < width; ++i) { p[i] = static_cast<char>(v >> (8 * i)); }
+        return p + width;
+    }
+
+    inline uint64_t get_uint(char const* p, size_t width) {
+        uint64_t v = 0;
+        for(size_t i = 0; i < width; ++i) { v |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i); }
+        return v;
+    }
+
+    inline uint64_t double_bits(double d)   { uint64_t u; std::memcpy(&u, &d, sizeof(u)); return u; }
+    inline double   bits_double(uint64_t u) { double d;   std::memcpy(&d, &u, sizeof(d)); return d; }
+
+    // offsets in the index of a container with `bytes` bytes of elements
+    inline size_t offset_width(size_t bytes) { return ((static_cast<uint64_t>(bytes) <= 0xFFFFFFFFull) ? 4 : 8); }
+
+    // lexicographic order of the key bytes (same as `std::string::compare()`)
+    inline int compare_keys(char const* a, size_t an, char const* b, size_t bn) {
+        auto c = std::memcmp(a, b, std::min(an, bn));
+        return ((c != 0) ? c : ((an < bn) ? -1 : ((an > bn) ? 1 : 0)));
+    }
+
+    // first pass: computes the node sizes and records the size of the
+    // elements of each container in pre-order; second pass: writes the
+    // nodes consuming the recorded sizes in the same order
+    struct binary_encoder {
+        inline explicit binary_encoder(
+            mirror::binary_layout layout
+        ) : m_indexed(layout == mirror::binary_layout::indexed), m_next(0) { }
+
+        size_t measure(mirror::value const& v) {
+            using mirror::value_kind;
+            switch(v.kind()) {
+                case value_kind::null:
+                case value_kind::boolean:   return 1;
+                case value_kind::integer:   return 1 + varint_size(zigzag(v.as_int()));
+                case value_kind::floating:  return 1 + 8;
+                case value_kind::string:
+                case value_kind::string_ref: {
+                    auto n = v.as_string_ref().size;
+                    return 1 + varint_size(n) + n;
+                }
+                case value_kind::array: {
+                    auto&& a = v.as_array();
+                    auto idx = m_sizes.size();
+                    m_sizes.push_back(0);
+                    size_t bytes = 0;
+                    for(auto&& e : a) { bytes += measure(e); }
+                    m_sizes[idx] = bytes;
+                    auto body = body_size(a.size(), bytes);
+                    return 1 + varint_size(a.size()) + varint_size(body) + body;
+                }
+                case value_kind::dict: {
+                    auto&& d = v.as_dict();
+                    auto idx = m_sizes.size();
+                    m_sizes.push_back(0);
+                    size_t bytes = 0;
+                    for(auto&& e : d) {
+                        auto n = e.first.str().size();
+                        bytes += varint_size(n) + n + measure(e.second);
+                    }
+                    m_sizes[idx] = bytes;
+                    auto body = body_size(d.size(), bytes);
+                    return 1 + varint_size(d.size()) + varint_size(body) + body;
+                }
+                case value_kind::int_array:     return 1 + varint_size(v.size()) + 8 * v.size();
+                case value_kind::double_array:  return 1 + varint_size(v.size()) + 8 * v.size();
+                case value_kind::bool_array:    return 1 + varint_size(v.size()) + (v.size() + 7) / 8;
+                case value_kind::object:        break;
+            }
+            throw std::runtime_error(std::string("binary encoding: can not serialize an object of type: ") + v.m_type->name());
+        }
+
+        char* write(mirror::value const& v, char* p) {
+            using mirror::value_kind;
+            switch(v.kind()) {
+                case value_kind::null:      *p++ = tag_byte(binary_tag::null); break;
+                case value_kind::boolean:   *p++ = tag_byte(v.as_bool() ? binary_tag::true_ : binary_tag::false_); break;
+                case value_kind::integer:
+                    *p++ = tag_byte(binary_tag::integer);
+                    p = put_varint(p, zigzag(v.as_int()));
+                    break;
+                case value_kind::floating:
+                    *p++ = tag_byte(binary_tag::floating);
+                    p = put_uint(p, double_bits(v.as_double()), 8);
+                    break;
+                case value_kind::string:
+                case value_kind::string_ref: {
+                    auto s = v.as_string_ref();
+                    *p++ = tag_byte(binary_tag::string);
+                    p = put_varint(p, s.size);
+                    std::memcpy(p, s.data, s.size);
+                    p += s.size;
+                    break;
+                }
+                case value_kind::array: {
+                    auto&& a = v.as_array();
+                    auto bytes = m_sizes[m_next++];
+                    index_writer idx(*this, p, binary_tag::array, binary_tag::indexed_array, a.size(), bytes);
+                    for(auto&& e : a) { idx.next(p); p = write(e, p); }
+                    break;
+                }
+                case value_kind::dict: {
+                    auto&& d = v.as_dict();
+                    auto bytes = m_sizes[m_next++];
+                    index_writer idx(*this, p, binary_tag::dict, binary_tag::indexed_dict, d.size(), bytes);
+                    // dicts iterate in key byte order, as required by the index
+                    for(auto&& e : d) {
+                        idx.next(p);
+                        auto&& k = e.first.str();
+                        p = put_varint(p, k.size());
+                        std::memcpy(p, k.data(), k.size());
+                        p = write(e.second, p + k.size());
+                    }
+                    break;
+                }
+                case value_kind::int_array: {
+                    auto&& a = v.as_int_array();
+                    *p++ = tag_byte(binary_tag::int_array);
+                    p = put_varint(p, a.size());
+                    for(auto e : a) { p = put_uint(p, static_cast<uint64_t>(e), 8); }
+                    break;
+                }
+                case value_kind::double_array: {
+                    auto&& a = v.as_double_array();
+                    *p++ = tag_byte(binary_tag::double_array);
+                    p = put_varint(p, a.size());
+                    for(auto e : a) { p = put_uint(p, double_bits(e), 8); }
+                    break;
+                }
+                case value_kind::bool_array: {
+                    auto&& a = v.as_bool_array();
+                    *p++ = tag_byte(binary_tag::bool_array);
+                    p = put_varint(p, a.size());
+                    auto bytes = (a.size() + 7) / 8;
+                    std::memset(p, 0, bytes);
+                    for(size_t i = 0; i < a.size(); ++i) {
+                        if(a[i]) { p[i / 8] = static_cast<char>(p[i / 8] | (1 << (i % 8))); }
+                    }
+                    p += bytes;
+                    break;
+                }
+                case value_kind::object:
+                    assert(false); // rejected by measure()
+                    break;
+            }
+            return p;
+        }
+
+    private:
+        inline bool use_index(size_t count) const { return (m_indexed && (count >= mirror::binary_index_min_size)); }
+
+        inline size_t body_size(size_t count, size_t bytes) const {
+            return (use_index(count) ? (1 + offset_width(bytes) * count + bytes) : bytes);
+        }
+
+        // writes the container header and (for indexed containers) fills
+        // in the offset of each element when `next()` gets called
+        struct index_writer {
+            inline index_writer(
+                binary_encoder const& enc, char*& p,
+                binary_tag compact_tag, binary_tag indexed_tag,
+                size_t count, size_t bytes
+            ) : m_table(nullptr), m_data(nullptr), m_width(0) {
+                auto indexed = enc.use_index(count);
+                *p++ = tag_byte(indexed ? indexed_tag : compact_tag);
+                p = put_varint(p, count);
+                p = put_varint(p, enc.body_size(count, bytes));
+                if(indexed) {
+                    m_width = offset_width(bytes);
+                    *p++ = static_cast<char>(m_width);
+                    m_table = p;
+                    p += m_width * count;
+                    m_data = p;
+                }
+            }
+
+            inline void next(char const* p) {
+                if(m_table) { m_table = put_uint(m_table, static_cast<uint64_t>(p - m_data), m_width); }
+            }
+
+            char*       m_table;
+            char const* m_data;
+            size_t      m_width;
+        };
+
+        bool const          m_indexed;
+        std::vector<size_t> m_sizes;
+        size_t              m_next;
+    };
+
+    // bounds checked reading of the encoded bytes
+    struct reader {
+        inline reader(
+            char const* begin, char const* cur, char const* end
+        ) : m_begin(begin), m_cur(cur), m_end(end) { }
+
+        void error(char const* msg, char const* pos) const {
+            throw mirror::binary_format_error(msg, static_cast<size_t>(pos - m_begin));
+        }
+
+        inline size_t remaining() const { return static_cast<size_t>(m_end - m_cur); }
+
+        inline binary_tag tag() {
+            if(m_cur == m_end) { error("unexpected end of input", m_cur); }
+            return static_cast<binary_tag>(*m_cur++);
+        }
+
+        inline uint64_t varint() {
+            auto start = m_cur;
+            uint64_t v = 0;
+            for(int shift = 0; shift < 64; shift += 7) {
+                if(m_cur == m_end) { error("unexpected end of input", m_cur); }
+                auto b = static_cast<unsigned char>(*m_cur++);
+                v |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if(b < 0x80) { return v; }
+            }
+            error("invalid varint", start);
+            return 0;
+        }
+
+        // a count of elements needing at least `min_bytes` each
+        inline size_t count(size_t min_bytes) {
+            auto start = m_cur;
+            auto n = varint();
+            if((min_bytes > 0) && (n > remaining() / min_bytes)) { error("element count exceeds the input size", start); }
+            return static_cast<size_t>(n);
+        }
+
+        inline char const* skip(size_t n) {
+            if(n > remaining()) { error("unexpected end of input", m_cur); }
+            auto p = m_cur;
+            m_cur += n;
+            return p;
+        }
+
+        inline size_t bool_count() {
+            auto start = m_cur;
+            auto n = varint();
+            if((n / 8 + ((n % 8) != 0 ? 1 : 0)) > remaining()) { error("element count exceeds the input size", start); }
+            return static_cast<size_t>(n);
+        }
+
+        char const* const   m_begin;
+        char const*         m_cur;
+        char const* const   m_end;
+    };
+
+    // header of an array or dict; `m_cur` of the reader is expected
+    // right behind the tag
+    struct container {
+        inline container(reader& r, binary_tag tag) : table(nullptr), width(0) {
+            auto indexed = ((tag == binary_tag::indexed_array) || (tag == binary_tag::indexed_dict));
+            auto is_dict = ((tag == binary_tag::dict) || (tag == binary_tag::indexed_dict));
+            count = r.count(is_dict ? 2 : 1);
+            auto body = r.count(1);
+            end = r.m_cur + body;
+            if(indexed) {
+                width = static_cast<unsigned char>(*r.skip(1));
+                if((width != 4) && (width != 8)) { r.error("invalid offset size", r.m_cur - 1); }
+                if(count > r.remaining() / width) { r.error("element count exceeds the input size", r.m_cur); }
+                table = r.skip(width * count);
+                if(r.m_cur > end) { r.error("container size mismatch", r.m_cur); }
+            }
+            data = r.m_cur;
+        }
+
+        // start of element `i` of an indexed container
+        inline char const* element(reader const& r, size_t i) const {
+            assert(table && (i < count));
+            auto off = get_uint(table + width * i, width);
+            if(off >= static_cast<uint64_t>(end - data)) { r.error("invalid offset", table + width * i); }
+            return data + off;
+        }
+
+        size_t      count;
+        char const* table;  // offsets (or null)
+        size_t      width;  // of the offsets
+        char const* data;   // first element
+        char const* end;    // end of the container
+    };
+
+    void skip_node(reader& r) {
+        auto tag_pos = r.m_cur;
+        auto tag = r.tag();
+        switch(tag) {
+            case binary_tag::null:
+            case binary_tag::false_:
+            case binary_tag::true_:         return;
+            case binary_tag::integer:       r.varint(); return;
+            case binary_tag::floating:      r.skip(8); return;
+            case binary_tag::string:        r.skip(r.count(1)); return;
+            case binary_tag::array:
+            case binary_tag::dict:
+            case binary_tag::indexed_array:
+            case binary_tag::indexed_dict:  r.varint(); r.skip(r.count(1)); return;
+            case binary_tag::int_array:
+            case binary_tag::double_array:  r.skip(8 * r.count(8)); return;
+            case binary_tag::bool_array:    { auto n = r.bool_count(); r.skip(n / 8 + ((n % 8) != 0 ? 1 : 0)); return; }
+        }
+        r.error("invalid tag", tag_pos);
+    }
+
+    inline void check_header(reader& r) {
+        if((r.remaining() < HEADER_SIZE) || (std::memcmp(r.m_cur, MAGIC, sizeof(MAGIC)) != 0)) {
+            r.error("not a binary mirror-cpp document", r.m_cur);
+        }
+        if(static_cast<uint8_t>(r.m_cur[3]) != mirror::binary_version) { r.error("unsupported version", r.m_cur + 3); }
+        r.m_cur += HEADER_SIZE;
+    }
+
+    // emits the events of the decoded nodes to a `HANDLER` (either a
+    // `value_handler` or the concrete (final) `value_builder`)
+    template<typename HANDLER>
+    struct binary_decoder {
+        inline binary_decoder(
+            reader const& r,
+            HANDLER& handler
+        ) : m_reader(r), m_handler(handler) { }
+
+        inline void decode_document() {
+            auto& r = m_reader;
+            check_header(r);
+            decode_node(0);
+            if(r.m_cur != r.m_end) { r.error("unexpected trailing bytes", r.m_cur); }
+        }
+
+        void decode_node(int depth) {
+            auto& r = m_reader;
+            auto tag_pos = r.m_cur;
+            auto tag = r.tag();
+
+            switch(tag) {
+                case binary_tag::null:      m_handler.null(); return;
+                case binary_tag::false_:    m_handler.boolean(false); return;
+                case binary_tag::true_:     m_handler.boolean(true); return;
+                case binary_tag::integer:   m_handler.int64(unzigzag(r.varint())); return;
+                case binary_tag::floating:  m_handler.float64(bits_double(get_uint(r.skip(8), 8))); return;
+                case binary_tag::string: {
+                    auto n = r.count(1);
+                    m_handler.string(mirror::string_ref(r.skip(n), n));
+                    return;
+                }
+                case binary_tag::array:
+                case binary_tag::indexed_array: {
+                    if(depth >= MAX_DEPTH) { r.error("nesting too deep", tag_pos); }
+                    auto c = container(r, tag);
+                    m_handler.begin_array(c.count);
+                    for(size_t i = 0; i < c.count; ++i) {
+                        check_offset(c, i);
+                        decode_node(depth + 1);
+                    }
+                    check_end(c);
+                    m_handler.end_array();
+                    return;
+                }
+                case binary_tag::dict:
+                case binary_tag::indexed_dict: {
+                    if(depth >= MAX_DEPTH) { r.error("nesting too deep", tag_pos); }
+                    auto c = container(r, tag);
+                    m_handler.begin_dict(c.count);
+                    for(size_t i = 0; i < c.count; ++i) {
+                        check_offset(c, i);
+                        auto len = r.count(1);
+                        m_handler.key(mirror::string_ref(r.skip(len), len));
+                        decode_node(depth + 1);
+                    }
+                    check_end(c);
+                    m_handler.end_dict();
+                    return;
+                }
+                case binary_tag::int_array: {
+                    auto n = r.count(8);
+                    auto p = r.skip(8 * n);
+                    m_ints.resize(n);
+                    for(size_t i = 0; i < n; ++i) { m_ints[i] = static_cast<int64_t>(get_uint(p + 8 * i, 8)); }
+                    m_handler.int_array(m_ints.data(), n);
+                    return;
+                }
+                case binary_tag::double_array: {
+                    auto n = r.count(8);
+                    auto p = r.skip(8 * n);
+                    m_doubles.resize(n);
+                    for(size_t i = 0; i < n; ++i) { m_doubles[i] = bits_double(get_uint(p + 8 * i, 8)); }
+                    m_handler.double_array(m_doubles.data(), n);
+                    return;
+                }
+                case binary_tag::bool_array: {
+                    auto n = r.bool_count();
+                    auto p = r.skip(n / 8 + ((n % 8) != 0 ? 1 : 0));
+                    m_handler.bool_array(reinterpret_cast<uint8_t const*>(p), n);
+                    return;
+                }
+            }
+
+            r.error("invalid tag", tag_pos);
+        }
+
+    private:
+        // the offset tables have to match the actual positions, so a
+        // `value_view` of a successfully decoded document is consistent
+        inline void check_offset(container const& c, size_t i) const {
+            if(c.table && (c.element(m_reader, i) != m_reader.m_cur)) { m_reader.error("invalid offset", c.table + c.width * i); }
+        }
+
+        inline void check_end(container const& c) const {
+            if(m_reader.m_cur != c.end) { m_reader.error("container size mismatch", c.data); }
+        }
+
+        reader                  m_reader;
+        HANDLER&                m_handler;
+        std::vector<int64_t>    m_ints;     // scratch buffers for typed arrays
+        std::vector<double>     m_doubles;
+    };
+
+    inline bool is_array_tag(binary_tag t) { return ((t == binary_tag::array) || (t == binary_tag::indexed_array)); }
+    inline bool is_dict_tag(binary_tag t)  { return ((t == binary_tag::dict)  || (t == binary_tag::indexed_dict));  }
+
+} // namespace
+
+mirror::binary_format_error::binary_format_error(
+    std::string const& msg,
+    size_t off
+) : std::runtime_error(msg + " at offset " + std::to_string(off)), offset(off) { }
+
+size_t mirror::binary_size(
+    value const& v,
+    binary_layout layout
+) {
+    return HEADER_SIZE + binary_encoder(layout).measure(v);
+}
+
+std::string mirror::to_binary(
+    value const& v,
+    binary_layout layout
+) {
+    std::string out;
+    to_binary(v, out, layout);
+    return out;
+}
+
+void mirror::to_binary(
+    value const& v,
+    std::string& out,
+    binary_layout layout
+) {
+    binary_encoder enc(layout);
+    auto size = HEADER_SIZE + enc.measure(v);
+
+    auto old_size = out.size();
+    out.resize(old_size + size);
+    auto p = &out[old_size];
+    std::memcpy(p, MAGIC, sizeof(MAGIC));
+    p[3] = static_cast<char>(binary_version);
+
+    auto end = enc.write(v, p + HEADER_SIZE);
+    (void)end;
+    assert(end == p + size);
+}
+
+mirror::value mirror::from_binary(
+    char const* data,
+    size_t size,
+    binary_strings strings,
+    value_arena* arena
+) {
+    assert(data || (size == 0));
+    value_builder builder(arena);
+    builder.borrow_strings(strings == binary_strings::borrow);
+    binary_decoder<value_builder>(reader(data, data, data + size), builder).decode_document();
+    return builder.take();
+}
+
+mirror::value mirror::from_binary(
+    std::string const& data,
+    binary_strings strings,
+    value_arena* arena
+) {
+    return from_binary(data.data(), data.size(), strings, arena);
+}
+
+void mirror::from_binary(
+    char const* data,
+    size_t size,
+    value_handler& handler
+) {
+    assert(data || (size == 0));
+    binary_decoder<value_handler>(reader(data, data, data + size), handler).decode_document();
+}
+
+void mirror::from_binary(
+    std::string const& data,
+    value_handler& handler
+) {
+    from_binary(data.data(), data.size(), handler);
+}
+
+//
+// value_view
+//
+
+mirror::value_view mirror::value_view::document(
+    char const* data,
+    size_t size
+) {
+    assert(data || (size == 0));
+    reader r(data, data, data + size);
+    check_header(r);
+    if(r.remaining() == 0) { r.error("unexpected end of input", r.m_cur); }
+    return value_view(data, data + HEADER_SIZE, data + size);
+}
+
+mirror::value_kind mirror::value_view::kind(
+) const {
+    if(!m_node) { return value_kind::null; }
+    switch(static_cast<binary_tag>(*m_node)) {
+        case binary_tag::null:          return value_kind::null;
+        case binary_tag::false_:
+        case binary_tag::true_:         return value_kind::boolean;
+        case binary_tag::integer:       return value_kind::integer;
+        case binary_tag::floating:      return value_kind::floating;
+        case binary_tag::string:        return value_kind::string;
+        case binary_tag::array:
+        case binary_tag::indexed_array: return value_kind::array;
+        case binary_tag::dict:
+        case binary_tag::indexed_dict:  return value_kind::dict;
+        case binary_tag::int_array:     return value_kind::int_array;
+        case binary_tag::double_array:  return value_kind::double_array;
+        case binary_tag::bool_array:    return value_kind::bool_array;
+    }
+    reader(m_doc, m_node, m_end).error("invalid tag", m_node);
+    return value_kind::null;
+}
+
+bool mirror::value_view::as_bool(
+) const {
+    return (m_node && (static_cast<binary_tag>(*m_node) == binary_tag::true_));
+}
+
+int64_t mirror::value_view::as_int(
+) const {
+    if(!is_int()) { return 0; }
+    return unzigzag(reader(m_doc, m_node + 1, m_end).varint());
+}
+
+double mirror::value_view::as_double(
+) const {
+    if(!is_double()) { return 0.0; }
+    return bits_double(get_uint(reader(m_doc, m_node + 1, m_end).skip(8), 8));
+}
+
+mirror::string_ref mirror::value_view::as_string(
+) const {
+    if(!is_string()) { return string_ref(); }
+    reader r(m_doc, m_node + 1, m_end);
+    auto n = r.count(1);
+    return string_ref(r.skip(n), n);
+}
+
+size_t mirror::value_view::size(
+) const {
+    switch(kind()) {
+        case value_kind::array:
+        case value_kind::dict:
+        case value_kind::int_array:
+        case value_kind::double_array:
+        case value_kind::bool_array:    return static_cast<size_t>(reader(m_doc, m_node + 1, m_end).varint());
+        default:                        return 0;
+    }
+}
+
+mirror::value_view mirror::value_view::at(
+    size_t i
+) const {
+    if(!m_node || !is_array_tag(static_cast<binary_tag>(*m_node))) { throw std::out_of_range("value_view::at: not an array"); }
+
+    reader r(m_doc, m_node + 1, m_end);
+    auto c = container(r, static_cast<binary_tag>(*m_node));
+    if(i >= c.count) { throw std::out_of_range("value_view::at: index out of range"); }
+    if(c.table) { return value_view(m_doc, c.element(r, i), m_end); }
+
+    for(; i > 0; --i) { skip_node(r); }
+    return value_view(m_doc, r.m_cur, m_end);
+}
+
+int64_t mirror::value_view::int_at(
+    size_t i
+) const {
+    if(!is_int_array()) { throw std::out_of_range("value_view::int_at: not an int array"); }
+    reader r(m_doc, m_node + 1, m_end);
+    auto n = r.count(8);
+    if(i >= n) { throw std::out_of_range("value_view::int_at: index out of range"); }
+    return static_cast<int64_t>(get_uint(r.m_cur + 8 * i, 8));
+}
+
+double mirror::value_view::double_at(
+    size_t i
+) const {
+    if(!is_double_array()) { throw std::out_of_range("value_view::double_at: not a double array"); }
+    reader r(m_doc, m_node + 1, m_end);
+    auto n = r.count(8);
+    if(i >= n) { throw std::out_of_range("value_view::double_at: index out of range"); }
+    return bits_double(get_uint(r.m_cur + 8 * i, 8));
+}
+
+bool mirror::value_view::bool_at(
+    size_t i
+) const {
+    if(!is_bool_array()) { throw std::out_of_range("value_view::bool_at: not a bool array"); }
+    reader r(m_doc, m_node + 1, m_end);
+    auto n = r.bool_count();
+    if(i >= n) { throw std::out_of_range("value_view::bool_at: index out of range"); }
+    return (((static_cast<unsigned char>(r.m_cur[i / 8]) >> (i % 8)) & 1) != 0);
+}
+
+bool mirror::value_view::find(
+    string_ref key,
+    value_view& result
+) const {
+    if(!m_node || !is_dict_tag(static_cast<binary_tag>(*m_node))) { return false; }
+
+    reader r(m_doc, m_node + 1, m_end);
+    auto c = container(r, static_cast<binary_tag>(*m_node));
+
+    if(c.table) { // binary search over the sorted entries
+        size_t lo = 0, hi = c.count;
+        while(lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            reader e(m_doc, c.element(r, mid), m_end);
+            auto len = e.count(1);
+            auto k = e.skip(len);
+            auto cmp = compare_keys(k, len, key.data, key.size);
+            if(cmp == 0) { result = value_view(m_doc, e.m_cur, m_end); return true; }
+            if(cmp < 0) { lo = mid + 1; } else { hi = mid; }
+        }
+        return false;
+    }
+
+    for(size_t i = 0; i < c.count; ++i) {
+        auto len = r.count(1);
+        auto k = r.skip(len);
+        if((len == key.size) && (std::memcmp(k, key.data, len) == 0)) { result = value_view(m_doc, r.m_cur, m_end); return true; }
+        skip_node(r);
+    }
+    return false;
+}
+
+mirror::string_ref mirror::value_view::key_at(
+    size_t i
+) const {
+    if(!m_node || !is_dict_tag(static_cast<binary_tag>(*m_node))) { throw std::out_of_range("value_view::key_at: not a dict"); }
+
+    reader r(m_doc, m_node + 1, m_end);
+    auto c = container(r, static_cast<binary_tag>(*m_node));
+    if(i >= c.count) { throw std::out_of_range("value_view::key_at: index out of range"); }
+
+    if(c.table) {
+        r.m_cur = c.element(r, i);
+    } else {
+        for(; i > 0; --i) { r.skip(r.count(1)); skip_node(r); }
+    }
+    auto len = r.count(1);
+    return string_ref(r.skip(len), len);
+}
+
+mirror::value_view mirror::value_view::value_at(
+    size_t i
+) const {
+    auto k = key_at(i);
+    return value_view(m_doc, k.data + k.size, m_end);
+}
+
+mirror::value mirror::value_view::to_value(
+    binary_strings strings,
+    value_arena* arena
+) const {
+    value_builder builder(arena);
+    builder.borrow_strings(strings == binary_strings::borrow);
+    walk(*this, builder);
+    return builder.take();
+}
+
+void mirror::walk(
+    value_view const& view,
+    value_handler& handler
+) {
+    if(!view.m_node) { handler.null(); return; }
+    binary_decoder<value_handler>(reader(view.m_doc, view.m_node, view.m_end), handler).decode_node(0);
+}
+
+//
+// mapped_file
+//
+
+#if defined(WIN32)
+
+mirror::mapped_file::mapped_file(
+    std::string const& path
+) : m_data(nullptr), m_size(0), m_mapping(nullptr) {
+    auto file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) { throw std::runtime_error("mapped_file: can not open file: " + path); }
+
+    LARGE_INTEGER size;
+    if(!::GetFileSizeEx(file, &size)) { ::CloseHandle(file); throw std::runtime_error("mapped_file: can not determine the size of file: " + path); }
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    if(m_size > 0) {
+        m_mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(m_mapping) { m_data = static_cast<char const*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)); }
+    }
+    ::CloseHandle(file);
+
+    if((m_size > 0) && !m_data) {
+        if(m_mapping) { ::CloseHandle(m_mapping); }
+        throw std::runtime_error("mapped_file: can not map file: " + path);
+    }
+}
+
+mirror::mapped_file::~mapped_file() {
+    if(m_data)    { ::UnmapViewOfFile(m_data); }
+    if(m_mapping) { ::CloseHandle(m_mapping); }
+}
+
+#else // defined(WIN32)
+
+mirror::mapped_file::mapped_file(
+    std::string const& path
+) : m_data(nullptr), m_size(0) {
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) { throw std::runtime_error("mapped_file: can not open file: " + path); }
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0) { ::close(fd); throw std::runtime_error("mapped_file: can not determine the size of file: " + path); }
+    m_size = static_cast<size_t>(st.st_size);
+
+    if(m_size > 0) {
+        auto p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED) { ::close(fd); throw std::runtime_error("mapped_file: can not map file: " + path); }
+        m_data = static_cast<char const*>(p);
+    }
+    ::close(fd);
+}
+
+mirror::mapped_file::~mapped_file() {
+    if(m_data) { ::munmap(const_cast<char*>(m_data), m_size); }
+}
+
+#endif // defined(WIN32)
@@ -0,0 +1,222 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include "mirror-cpp.hpp"
+#include "handler.hpp"
+#include "value.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace mirror {
+
+    /// Compact binary encoding of values, meant for caches and IPC between
+    /// processes of the same build (version 1):
+    ///
+    ///     document := 'M' 'R' 'B' version:u8 node
+    ///     node     := tag:u8 payload
+    ///
+    ///     tag  kind      payload
+    ///     0    null      -
+    ///     1    false     -
+    ///     2    true      -
+    ///     3    int       zigzag encoded varint
+    ///     4    double    8 bytes IEEE 754
+    ///     5    string    varint byte count, bytes
+    ///     6    array     varint element count, varint body size, nodes
+    ///     7    dict      varint entry count, varint body size, (varint key size, key bytes, node)*
+    ///     8    ints      varint element count, 8 bytes each
+    ///     9    doubles   varint element count, 8 bytes each
+    ///     10   bools     varint element count, (count + 7) / 8 bytes, least significant bit first
+    ///     11   array     varint element count, varint body size, offset size:u8, offsets, nodes
+    ///     12   dict      varint entry count, varint body size, offset size:u8, offsets, entries
+    ///
+    /// Varints are LEB128 encoded, fixed size numbers are little endian. The
+    /// body size (the number of bytes following it) of containers allows
+    /// skipping them without decoding. Indexed containers (tags 11 and 12)
+    /// start with a table of 4 or 8 byte offsets of their elements (relative
+    /// to the first element) and keep the entries of dicts sorted by their
+    /// key bytes, which allows O(1) indexing and O(log n) key lookups in
+    /// place (see `value_view`).
+    enum class binary_tag : uint8_t {
+        null,
+        false_,
+        true_,
+        integer,
+        floating,
+        string,
+        array,
+        dict,
+        int_array,
+        double_array,
+        bool_array,
+        indexed_array,
+        indexed_dict
+    };
+
+    /// `compact` writes containers without offset tables (smallest output,
+    /// linear navigation in a `value_view`); `indexed` adds offset tables to
+    /// arrays and dicts with at least `binary_index_min_size` elements.
+    enum class binary_layout {
+        compact,
+        indexed
+    };
+
+    static const size_t binary_index_min_size = 8;
+
+    static const uint8_t binary_version = 1;
+
+    /// Thrown by `from_binary()`; `offset` is the byte offset of the error
+    /// in the input.
+    struct MIRROR_API binary_format_error : std::runtime_error {
+        binary_format_error(std::string const& msg, size_t off);
+
+        size_t const offset;
+    };
+
+    /// Whether decoded strings copy their characters or refer to them in
+    /// the input buffer (as `value_kind::string_ref`); borrowed strings
+    /// require the input to outlive the decoded values.
+    enum class binary_strings {
+        copy,
+        borrow
+    };
+
+    /// Exact size of the binary encoding of `v` in bytes.
+    MIRROR_API size_t binary_size(value const& v, binary_layout layout = binary_layout::compact);
+
+    /// Encodes `v` in a single pass into one contiguous block: the sizes of
+    /// all containers are computed up front. Object pointers can not be
+    /// encoded and lead to a `std::runtime_error`.
+    MIRROR_API std::string to_binary(value const& v, binary_layout layout = binary_layout::compact);
+    MIRROR_API void        to_binary(value const& v, std::string& out, binary_layout layout = binary_layout::compact); ///< appends to `out`
+
+    /// Decodes a document created by `to_binary()`; arrays, dicts and copied
+    /// strings are allocated from `arena` if given. Throws a
+    /// `binary_format_error` for invalid or truncated input.
+    MIRROR_API value from_binary(char const* data, size_t size, binary_strings strings = binary_strings::copy, value_arena* arena = nullptr);
+    MIRROR_API value from_binary(std::string const& data, binary_strings strings = binary_strings::copy, value_arena* arena = nullptr);
+
+    /// Decodes a document emitting its events to `handler`; the sizes passed
+    /// to `begin_array()`/`begin_dict()` are exact. Note: there is no
+    /// streaming encoder, as the format needs the size of each container up
+    /// front; build a `value` (or use `json_writer`) instead.
+    MIRROR_API void from_binary(char const* data, size_t size, value_handler& handler);
+    MIRROR_API void from_binary(std::string const& data, value_handler& handler);
+
+    /// Read-only view of a node of a binary document which interprets the
+    /// encoded bytes in place: nothing gets decoded up front and no accessor
+    /// allocates. Views are cheap to copy (three pointers) and stay valid as
+    /// long as the underlying buffer does; all strings are borrowed from it.
+    ///
+    /// Elements of indexed arrays and dicts are found in O(1) and O(log n)
+    /// respectively; compact containers get scanned linearly. Accessors
+    /// return defaults on a kind mismatch (like `value`); malformed input is
+    /// reported by a `binary_format_error`.
+    struct MIRROR_API value_view {
+        inline value_view() : m_doc(nullptr), m_node(nullptr), m_end(nullptr) { }
+
+        /// View of the root node of the document in `data`; checks the header.
+        static value_view document(char const* data, size_t size);
+
+        value_kind kind() const; ///< never `value_kind::string_ref` or `value_kind::object`
+
+        inline bool is_null()         const { return (kind() == value_kind::null);          }
+        inline bool is_bool()         const { return (kind() == value_kind::boolean);       }
+        inline bool is_int()          const { return (kind() == value_kind::integer);       }
+        inline bool is_double()       const { return (kind() == value_kind::floating);      }
+        inline bool is_string()       const { return (kind() == value_kind::string);        }
+        inline bool is_array()        const { return (kind() == value_kind::array);         }
+        inline bool is_dict()         const { return (kind() == value_kind::dict);          }
+        inline bool is_int_array()    const { return (kind() == value_kind::int_array);     }
+        inline bool is_double_array() const { return (kind() == value_kind::double_array);  }
+        inline bool is_bool_array()   const { return (kind() == value_kind::bool_array);    }
+
+        bool        as_bool()   const;
+        int64_t     as_int()    const;
+        double      as_double() const;
+        string_ref  as_string() const;
+
+        /// Number of elements of an array (of any kind) or dict; 0 otherwise.
+        size_t size() const;
+
+        /// Element `i` of a generic array; throws `std::out_of_range`.
+        value_view at(size_t i) const;
+
+        /// Elements of typed arrays; throw `std::out_of_range`.
+        int64_t int_at(size_t i)    const;
+        double  double_at(size_t i) const;
+        bool    bool_at(size_t i)   const;
+
+        /// Looks up `key` in a dict; returns `false` if it is not there.
+        bool find(string_ref key, value_view& result) const;
+
+        /// The value for `key` in a dict or a null view.
+        inline value_view operator[](string_ref key) const { value_view res; find(key, res); return res; }
+
+        /// Key and value of the `i`th entry of a dict (in encoded order);
+        /// throw `std::out_of_range`.
+        string_ref key_at(size_t i)   const;
+        value_view value_at(size_t i) const;
+
+        /// Decodes the node (and all its children) into a `value`.
+        value to_value(binary_strings strings = binary_strings::copy, value_arena* arena = nullptr) const;
+
+    private:
+        friend void walk(value_view const& view, value_handler& handler);
+
+        inline value_view(char const* doc, char const* node, char const* end) : m_doc(doc), m_node(node), m_end(end) { }
+
+        char const* m_doc;  // start of the document (for error offsets)
+        char const* m_node; // tag of this node (or null)
+        char const* m_end;  // end of the document
+    };
+
+    /// Emits the events for the node of `view` (and all its children) to
+    /// `handler` without materializing it.
+    MIRROR_API void walk(value_view const& view, value_handler& handler);
+
+    /// Read-only memory mapping of a whole file, e.g. to create a
+    /// `value_view` of a document on disk; throws a `std::runtime_error` if
+    /// the file can not be mapped.
+    struct MIRROR_API mapped_file {
+        explicit mapped_file(std::string const& path);
+        ~mapped_file();
+
+        inline char const*  data() const { return m_data; }
+        inline size_t       size() const { return m_size; }
+
+    private:
+        mapped_file(mapped_file const&) = delete;
+        mapped_file& operator=(mapped_file const&) = delete;
+
+        char const* m_data;
+        size_t      m_size;
+#if defined(WIN32)
+        void*       m_mapping;
+#endif // defined(WIN32)
+    };
+
+} // namespace mirror
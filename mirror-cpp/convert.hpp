@@ -0,0 +1,257 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include "mirror-cpp.hpp"
+#include "value.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace mirror {
+
+    [[noreturn]] inline void throw_conversion_error(value const& v, std::type_info const& expected) {
+        throw std::invalid_argument(std::string("cannot convert value of type '") + v.m_type->name() + "' to '" + expected.name() + "'");
+    }
+
+    /// How well a value of some kind converts to an argument type; used to
+    /// pick among overloaded methods, lower is better.
+    enum class conversion_rank : uint8_t {
+        exact,
+        promotion,  ///< e.g., an integer to a floating point argument
+        generic,    ///< any value, e.g., to a `value` argument
+        none
+    };
+
+    /// Compile-time conversion between `value` and C++ types, used to
+    /// unpack the arguments of reflected method calls and to pack their
+    /// results. `from_value()` throws `std::invalid_argument` if the value
+    /// does not hold something convertible to `T`.
+    ///
+    /// Supported are `bool`, all integral, enum and floating point types,
+    /// `std::string`, `string_ref`, `value` itself, `std::shared_ptr<U>` and
+    /// `U*` for objects, and objects (returned by reference for arguments and
+    /// copied into a shared object for results); `char const*` only converts
+    /// to a value. Specialize `convert` for further types; a specialization
+    /// may provide `rank(value_kind)` for overload resolution, otherwise it
+    /// accepts all kinds generically. For all other types `convert` has no
+    /// members, see `can_convert_from_value` and `can_convert_to_value`.
+    template<typename T, typename ENABLE = void>
+    struct convert;
+
+    namespace detail {
+
+        template<typename T, bool OBJECT = std::is_class<T>::value>
+        struct convert_object { };
+
+        template<typename T>
+        struct convert_object<T, true> {
+            static inline T& from_value(value const& v) {
+                if(!v.is_ptr_type<T>()) { throw_conversion_error(v, typeid(T)); }
+                return *static_cast<T*>(v.m_obj.get());
+            }
+
+            static inline conversion_rank rank(value_kind k) { return ((k == value_kind::object) ? conversion_rank::exact : conversion_rank::none); }
+
+            static inline value to_value(T v) { return value(std::make_shared<T>(std::move(v))); }
+        };
+
+    } // namespace detail
+
+    template<typename T, typename ENABLE>
+    struct convert : detail::convert_object<T> { };
+
+    template<>
+    struct convert<bool> {
+        static inline bool from_value(value const& v) {
+            if(!v.is_bool()) { throw_conversion_error(v, typeid(bool)); }
+            return v.as_bool();
+        }
+
+        static inline conversion_rank rank(value_kind k) { return ((k == value_kind::boolean) ? conversion_rank::exact : conversion_rank::none); }
+
+        static inline value to_value(bool v) { return value(v); }
+    };
+
+    template<typename T>
+    struct convert<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+        static inline T from_value(value const& v) {
+            if(!v.is_int() || !fits(v.as_int())) { throw_conversion_error(v, typeid(T)); }
+            return static_cast<T>(v.as_int());
+        }
+
+        static inline conversion_rank rank(value_kind k) { return ((k == value_kind::integer) ? conversion_rank::exact : conversion_rank::none); }
+
+        /// Out of range values get rejected instead of wrapping around.
+        static inline bool fits(int64_t i) {
+            typedef std::numeric_limits<T> limits;
+            return (std::is_signed<T>::value
+                ? ((i >= static_cast<int64_t>(limits::min())) && (i <= static_cast<int64_t>(limits::max())))
+                : ((i >= 0) && (static_cast<uint64_t>(i) <= static_cast<uint64_t>(limits::max())))
+            );
+        }
+
+        static inline value to_value(T v) { return value(static_cast<int64_t>(v)); }
+    };
+
+    /// Enums convert like their underlying integral type.
+    template<typename T>
+    struct convert<T, typename std::enable_if<std::is_enum<T>::value>::type> {
+        typedef typename std::underlying_type<T>::type underlying_type;
+
+        static inline T from_value(value const& v) {
+            if(!v.is_int() || !convert<underlying_type>::fits(v.as_int())) { throw_conversion_error(v, typeid(T)); }
+            return static_cast<T>(v.as_int());
+        }
+
+        static inline conversion_rank rank(value_kind k) { return convert<underlying_type>::rank(k); }
+
+        static inline value to_value(T v) { return convert<underlying_type>::to_value(static_cast<underlying_type>(v)); }
+    };
+
+    template<typename T>
+    struct convert<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+        static inline T from_value(value const& v) {
+            if(v.is_double()) { return static_cast<T>(v.as_double()); }
+            if(v.is_int())    { return static_cast<T>(v.as_int()); }
+            throw_conversion_error(v, typeid(T));
+        }
+
+        static inline conversion_rank rank(value_kind k) {
+            if(k == value_kind::floating) { return conversion_rank::exact; }
+            if(k == value_kind::integer)  { return conversion_rank::promotion; }
+            return conversion_rank::none;
+        }
+
+        static inline value to_value(T v) { return value(static_cast<double>(v)); }
+    };
+
+    template<>
+    struct convert<value> {
+        static inline value const& from_value(value const& v) { return v; }
+        static inline conversion_rank rank(value_kind) { return conversion_rank::generic; }
+        static inline value to_value(value v) { return v; }
+    };
+
+    template<>
+    struct convert<string_ref> {
+        static inline string_ref from_value(value const& v) {
+            if(!v.is_any_string()) { throw_conversion_error(v, typeid(string_ref)); }
+            return v.as_string_ref();
+        }
+
+        static inline conversion_rank rank(value_kind k) { return (((k == value_kind::string) || (k == value_kind::string_ref)) ? conversion_rank::exact : conversion_rank::none); }
+
+        static inline value to_value(string_ref v) { return value(v.str()); }
+    };
+
+    template<>
+    struct convert<std::string> {
+        static inline std::string from_value(value const& v) { return convert<string_ref>::from_value(v).str(); }
+        static inline conversion_rank rank(value_kind k) { return convert<string_ref>::rank(k); }
+        static inline value to_value(std::string v) { return value(std::move(v)); }
+    };
+
+    template<>
+    struct convert<char const*> {
+        static inline value to_value(char const* v) { return value(v); }
+    };
+
+    template<typename U>
+    struct convert<std::shared_ptr<U>> {
+        typedef typename std::remove_const<U>::type object_type;
+
+        static inline std::shared_ptr<U> from_value(value const& v) {
+            if(v.is_null()) { return nullptr; }
+            if(!v.is_ptr_type<object_type>()) { throw_conversion_error(v, typeid(object_type)); }
+            return std::static_pointer_cast<object_type>(v.m_obj);
+        }
+
+        static inline conversion_rank rank(value_kind k) {
+            if(k == value_kind::object) { return conversion_rank::exact; }
+            if(k == value_kind::null)   { return conversion_rank::promotion; }
+            return conversion_rank::none;
+        }
+
+        static inline value to_value(std::shared_ptr<U> v) { return value(std::const_pointer_cast<object_type>(std::move(v))); }
+    };
+
+    template<typename U>
+    struct convert<U*, typename std::enable_if<std::is_class<U>::value>::type> {
+        typedef typename std::remove_const<U>::type object_type;
+
+        static inline U* from_value(value const& v) {
+            if(v.is_null()) { return nullptr; }
+            if(!v.is_ptr_type<object_type>()) { throw_conversion_error(v, typeid(object_type)); }
+            return static_cast<object_type*>(v.m_obj.get());
+        }
+
+        static inline conversion_rank rank(value_kind k) {
+            if(k == value_kind::object) { return conversion_rank::exact; }
+            if(k == value_kind::null)   { return conversion_rank::promotion; }
+            return conversion_rank::none;
+        }
+    };
+
+    namespace detail {
+
+        template<typename T>
+        inline auto convert_rank(value_kind k, int) -> decltype(convert<T>::rank(k)) { return convert<T>::rank(k); }
+
+        template<typename T>
+        inline conversion_rank convert_rank(value_kind, long) { return conversion_rank::generic; }
+
+        template<typename T>
+        inline auto has_from_value(int) -> decltype(convert<T>::from_value(std::declval<value const&>()), std::true_type()) { return std::true_type(); }
+
+        template<typename T>
+        inline std::false_type has_from_value(long) { return std::false_type(); }
+
+        template<typename T>
+        inline auto has_to_value(int) -> decltype(convert<T>::to_value(std::declval<T>()), std::true_type()) { return std::true_type(); }
+
+        template<typename T>
+        inline std::false_type has_to_value(long) { return std::false_type(); }
+
+    } // namespace detail
+
+    /// Whether `convert<T>` unpacks values into a `T` or packs a `T` into a
+    /// value, respectively.
+    template<typename T>
+    struct can_convert_from_value : decltype(detail::has_from_value<T>(0)) { };
+
+    template<typename T>
+    struct can_convert_to_value : decltype(detail::has_to_value<T>(0)) { };
+
+    /// The rank of converting a value of kind `k` to `T`.
+    template<typename T>
+    inline conversion_rank rank_of(value_kind k) { return detail::convert_rank<T>(k, 0); }
+
+} // namespace mirror
@@ -0,0 +1,216 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include "mirror-cpp.hpp"
+#include "mirror.hpp"
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace mirror {
+
+    template<typename PTR>
+    struct member_pointer_traits;
+
+    template<typename T, typename MEMBER>
+    struct member_pointer_traits<MEMBER T::*> {
+        typedef T       owner_type;
+        typedef MEMBER  member_type;
+    };
+
+    /// Compile-time description of a data member; the member pointer is a
+    /// template argument, so accessing it via `get()` inlines to a plain
+    /// member access.
+    template<typename PTR, PTR P>
+    struct field_descriptor {
+        typedef typename member_pointer_traits<PTR>::owner_type  owner_type;
+        typedef typename member_pointer_traits<PTR>::member_type member_type;
+        static_assert(!std::is_function<member_type>::value, "mirror::field_descriptor: not a data member");
+
+        static inline PTR pointer() { return P; }
+        static inline member_type&       get(owner_type& obj)       { return (obj.*P); }
+        static inline member_type const& get(owner_type const& obj) { return (obj.*P); }
+
+        char const* name;
+    };
+
+    /// Compile-time description of a member function; see `field_descriptor`.
+    template<typename PTR, PTR P>
+    struct method_descriptor {
+        typedef typename member_pointer_traits<PTR>::owner_type owner_type;
+        static_assert(std::is_member_function_pointer<PTR>::value, "mirror::method_descriptor: not a member function");
+
+        static inline PTR pointer() { return P; }
+
+        template<typename OBJ, typename... ARGS>
+        static inline auto call(OBJ&& obj, ARGS&&... args) -> decltype((std::forward<OBJ>(obj).*P)(std::forward<ARGS>(args)...)) {
+            return (std::forward<OBJ>(obj).*P)(std::forward<ARGS>(args)...);
+        }
+
+        char const* name;
+    };
+
+    template<typename PTR, PTR P>
+    inline field_descriptor<PTR, P> make_field_descriptor(char const* name) { field_descriptor<PTR, P> d = { name }; return d; }
+
+    template<typename PTR, PTR P>
+    inline method_descriptor<PTR, P> make_method_descriptor(char const* name) { method_descriptor<PTR, P> d = { name }; return d; }
+
+    /// Describes the members of `T` at compile time; specialize it via the
+    /// `MIRROR_DESCRIBE()` macros below. A specialization provides:
+    ///   - `type` and `base_type` (`void` if none),
+    ///   - `name()`,
+    ///   - `members()`, returning a tuple of field and method descriptors.
+    template<typename T>
+    struct descriptor {
+        static const bool described = false;
+    };
+
+    template<typename T>
+    struct is_described : std::integral_constant<bool, descriptor<T>::described> { };
+
+    namespace detail {
+
+        template<typename TUPLE, typename VISITOR, size_t... I>
+        inline void for_each_in_tuple(TUPLE const& t, VISITOR& vis, indices<I...>) {
+            int expand[] = { 0, (vis(std::get<I>(t)), 0)... };
+            (void)expand;
+        }
+
+        // forwards field descriptors only
+        template<typename VISITOR>
+        struct field_filter {
+            VISITOR& vis;
+
+            template<typename PTR, PTR P>
+            inline void operator()(field_descriptor<PTR, P> const& d) const { vis(d); }
+
+            template<typename PTR, PTR P>
+            inline void operator()(method_descriptor<PTR, P> const&) const { }
+        };
+
+    } // namespace detail
+
+    /// Calls `vis(d)` for the descriptor `d` of each member of `T` in
+    /// declaration order, excluding the members of its base classes.
+    template<typename T, typename VISITOR>
+    inline void for_each_member(VISITOR&& vis) {
+        static_assert(is_described<T>::value, "mirror::for_each_member: type has no descriptor");
+        typedef decltype(descriptor<T>::members()) members_type;
+        detail::for_each_in_tuple(descriptor<T>::members(), vis, typename detail::make_indices<std::tuple_size<members_type>::value>::type());
+    }
+
+    /// Like `for_each_member()`, but for the field descriptors only.
+    template<typename T, typename VISITOR>
+    inline void for_each_field(VISITOR&& vis) {
+        detail::field_filter<typename std::remove_reference<VISITOR>::type> filter = { vis };
+        for_each_member<T>(filter);
+    }
+
+    namespace detail {
+
+        template<typename T>
+        struct class_builder {
+            std::shared_ptr<class_info<T>>& cls;
+
+            template<typename PTR, PTR P>
+            inline void operator()(field_descriptor<PTR, P> const& d) const { cls->add_property(d.name, P); }
+
+            template<typename PTR, PTR P>
+            inline void operator()(method_descriptor<PTR, P> const& d) const { cls->add_method(d.name, P); }
+        };
+
+        template<typename T>
+        inline std::shared_ptr<class_info<T>> make_described_class(std::false_type /* no base */) {
+            return make_class<T>(descriptor<T>::name());
+        }
+
+        template<typename T>
+        inline std::shared_ptr<class_info<T>> make_described_class(std::true_type /* base */);
+
+    } // namespace detail
+
+    /// The runtime class info generated from the descriptor of `T`; built
+    /// once on first use (including the class infos of the described base
+    /// classes) and shared afterwards.
+    template<typename T>
+    inline std::shared_ptr<class_info<T>> const& class_of() {
+        static_assert(is_described<T>::value, "mirror::class_of: type has no descriptor");
+        static const std::shared_ptr<class_info<T>> cls = []() {
+            typedef typename descriptor<T>::base_type base_type;
+            auto res = detail::make_described_class<T>(std::integral_constant<bool, !std::is_void<base_type>::value>());
+            detail::class_builder<T> builder = { res };
+            for_each_member<T>(builder);
+            return res;
+        }();
+        return cls;
+    }
+
+    namespace detail {
+
+        template<typename T>
+        inline std::shared_ptr<class_info<T>> make_described_class(std::true_type /* base */) {
+            return make_class<T>(descriptor<T>::name(), class_of<typename descriptor<T>::base_type>());
+        }
+
+        template<typename T>
+        inline class_base_ptr build_described_class(atom const&) { return class_of<T>(); }
+
+    } // namespace detail
+
+    /// Registers `T` lazily; its class info gets generated from the
+    /// descriptor on the first lookup.
+    template<typename T>
+    inline void add_described_class(class_registry& reg) {
+        static_assert(is_described<T>::value, "mirror::add_described_class: type has no descriptor");
+        reg.add_lazy_class<T>(descriptor<T>::name(), &detail::build_described_class<T>);
+    }
+
+} // namespace mirror
+
+/// Describes the members of `TYPE` at compile time; needs to be used at
+/// global scope. The members are listed via `MIRROR_FIELD()` and
+/// `MIRROR_METHOD()` (overloaded methods cannot be described), e.g.
+///   MIRROR_DESCRIBE(point, MIRROR_FIELD(point, x), MIRROR_METHOD(point, length))
+#define MIRROR_DESCRIBE(TYPE, ...)                      MIRROR_DESCRIBE_DERIVED(TYPE, void, __VA_ARGS__)
+
+/// Like `MIRROR_DESCRIBE()` for a class derived from the described class `BASE`.
+#define MIRROR_DESCRIBE_DERIVED(TYPE, BASE, ...)                                                        \
+    namespace mirror {                                                                                  \
+        template<>                                                                                      \
+        struct descriptor<TYPE> {                                                                       \
+            static const bool described = true;                                                         \
+            typedef TYPE type;                                                                          \
+            typedef BASE base_type;                                                                     \
+            static inline char const* name() { return #TYPE; }                                          \
+            static inline auto members() -> decltype(std::make_tuple(__VA_ARGS__)) {                    \
+                return std::make_tuple(__VA_ARGS__);                                                    \
+            }                                                                                           \
+        };                                                                                              \
+    }
+
+#define MIRROR_FIELD(TYPE, MEMBER)  ::mirror::make_field_descriptor<decltype(&TYPE::MEMBER), &TYPE::MEMBER>(#MEMBER)
+#define MIRROR_METHOD(TYPE, MEMBER) ::mirror::make_method_descriptor<decltype(&TYPE::MEMBER), &TYPE::MEMBER>(#MEMBER)
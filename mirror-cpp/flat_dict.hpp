@@ -0,0 +1,266 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include "mirror-cpp.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace mirror {
+
+    /// Customization point for looking up a `flat_dict` by a key of another
+    /// type `K` without creating a `KEY` for it if no entry can match (e.g.
+    /// a string that has never been interned as an atom); `find()` returns
+    /// `false` in that case.
+    template<typename KEY>
+    struct flat_dict_key {
+        template<typename K>
+        static inline bool find(K const& key, KEY& result) { result = KEY(key); return true; }
+    };
+
+    /// A `std::map` like associative container which stores its entries in a
+    /// single sorted vector. Lookups in small dicts use a binary search over
+    /// the contiguous entries; once a dict grows beyond `hash_threshold`
+    /// entries an open-addressing hash index (linear probing) over the entry
+    /// positions is maintained in addition. `insert()` and `erase()` update
+    /// only the index slots of the entries behind the changed position, so
+    /// appending (e.g. inserting in key order) touches a single slot.
+    ///
+    /// Note: unlike `std::map` iterators are invalidated by `insert()` and
+    /// `erase()`, and the key of an entry must not be modified through an
+    /// iterator.
+    template<
+        typename KEY, typename VALUE,
+        typename HASH = std::hash<KEY>, typename LESS = std::less<KEY>,
+        typename ALLOC = std::allocator<std::pair<KEY, VALUE>>
+    >
+    struct flat_dict {
+        typedef KEY                                     key_type;
+        typedef VALUE                                   mapped_type;
+        typedef std::pair<KEY, VALUE>                   value_type;
+        typedef ALLOC                                   allocator_type;
+        typedef std::vector<value_type, typename std::allocator_traits<ALLOC>::template rebind_alloc<value_type>> storage_type;
+        typedef std::vector<uint32_t,   typename std::allocator_traits<ALLOC>::template rebind_alloc<uint32_t>>   index_type;
+        typedef typename storage_type::iterator         iterator;
+        typedef typename storage_type::const_iterator   const_iterator;
+        typedef typename storage_type::size_type        size_type;
+
+        static const size_type hash_threshold = 32;
+
+        inline flat_dict() { }
+        inline explicit flat_dict(ALLOC const& a) : m_entries(a), m_index(a) { }
+
+        inline allocator_type get_allocator() const { return m_entries.get_allocator(); }
+
+        inline iterator         begin()         { return m_entries.begin();  }
+        inline iterator         end()           { return m_entries.end();    }
+        inline const_iterator   begin()   const { return m_entries.begin();  }
+        inline const_iterator   end()     const { return m_entries.end();    }
+        inline const_iterator   cbegin()  const { return m_entries.cbegin(); }
+        inline const_iterator   cend()    const { return m_entries.cend();   }
+
+        inline size_type    size()  const { return m_entries.size();  }
+        inline bool         empty() const { return m_entries.empty(); }
+
+        inline void clear()             { m_entries.clear(); m_index.clear(); }
+        inline void reserve(size_type n){ m_entries.reserve(n); }
+
+        inline iterator       find(KEY const& key)       { return m_entries.begin() + find_pos(key); }
+        inline const_iterator find(KEY const& key) const { return m_entries.begin() + find_pos(key); }
+
+        inline size_type count(KEY const& key) const { return ((find_pos(key) != size()) ? 1 : 0); }
+
+        template<typename K>
+        inline iterator       find(K const& key)       { KEY k; return (flat_dict_key<KEY>::find(key, k) ? find(k) : end()); }
+        template<typename K>
+        inline const_iterator find(K const& key) const { KEY k; return (flat_dict_key<KEY>::find(key, k) ? find(k) : end()); }
+        template<typename K>
+        inline size_type      count(K const& key) const { KEY k; return (flat_dict_key<KEY>::find(key, k) ? count(k) : 0); }
+
+        inline VALUE& at(KEY const& key) {
+            auto pos = find_pos(key);
+            if(pos == size()) { throw std::out_of_range("flat_dict::at(): key not found"); }
+            return m_entries[pos].second;
+        }
+        inline VALUE const& at(KEY const& key) const {
+            auto pos = find_pos(key);
+            if(pos == size()) { throw std::out_of_range("flat_dict::at(): key not found"); }
+            return m_entries[pos].second;
+        }
+        template<typename K>
+        inline VALUE& at(K const& key) {
+            KEY k;
+            if(!flat_dict_key<KEY>::find(key, k)) { throw std::out_of_range("flat_dict::at(): key not found"); }
+            return at(k);
+        }
+        template<typename K>
+        inline VALUE const& at(K const& key) const {
+            KEY k;
+            if(!flat_dict_key<KEY>::find(key, k)) { throw std::out_of_range("flat_dict::at(): key not found"); }
+            return at(k);
+        }
+
+        inline VALUE& operator[](KEY const& key) { return emplace(key, VALUE()).first->second; }
+        inline VALUE& operator[](KEY&& key)      { return emplace(std::move(key), VALUE()).first->second; }
+
+        inline std::pair<iterator, bool> insert(value_type v) { return emplace(std::move(v.first), std::move(v.second)); }
+
+        template<typename K, typename... ARGS>
+        inline std::pair<iterator, bool> emplace(K&& key, ARGS&&... args) {
+            auto pos = find_pos(key);
+            if(pos != size()) { return std::make_pair(m_entries.begin() + pos, false); }
+
+            auto it = std::lower_bound(
+                m_entries.begin(), m_entries.end(), key,
+                [](value_type const& e, KEY const& k) { return LESS()(e.first, k); }
+            );
+            pos = static_cast<size_type>(it - m_entries.begin());
+            it = m_entries.emplace(it, value_type(std::forward<K>(key), VALUE(std::forward<ARGS>(args)...)));
+            index_inserted(pos);
+            return std::make_pair(it, true);
+        }
+
+        inline iterator erase(const_iterator it) {
+            auto pos = static_cast<size_type>(it - m_entries.cbegin());
+            index_erased(pos);
+            return m_entries.erase(m_entries.begin() + pos);
+        }
+
+        inline size_type erase(KEY const& key) {
+            auto pos = find_pos(key);
+            if(pos == size()) { return 0; }
+            erase(m_entries.cbegin() + pos);
+            return 1;
+        }
+
+        inline bool operator==(flat_dict const& o) const { return (m_entries == o.m_entries); }
+        inline bool operator!=(flat_dict const& o) const { return (m_entries != o.m_entries); }
+
+    private:
+        static const uint32_t empty_slot = 0xFFFFFFFFu;
+
+        inline size_type find_pos(KEY const& key) const {
+            if(m_index.empty()) {
+                auto it = std::lower_bound(
+                    m_entries.begin(), m_entries.end(), key,
+                    [](value_type const& e, KEY const& k) { return LESS()(e.first, k); }
+                );
+                if((it != m_entries.end()) && !LESS()(key, it->first)) {
+                    return static_cast<size_type>(it - m_entries.begin());
+                }
+                return size();
+            }
+
+            auto mask = m_index.size() - 1;
+            for(auto slot = (HASH()(key) & mask); ; slot = ((slot + 1) & mask)) {
+                auto idx = m_index[slot];
+                if(idx == empty_slot) { return size(); }
+                if(m_entries[idx].first == key) { return idx; }
+            }
+        }
+
+        inline size_type home_slot(KEY const& key) const {
+            return (HASH()(key) & (m_index.size() - 1));
+        }
+
+        /// Slot referring to the entry position `idx`; `key` is the key
+        /// stored under that position (which may already have been moved).
+        inline size_type slot_of(KEY const& key, uint32_t idx) const {
+            auto mask = m_index.size() - 1;
+            auto slot = home_slot(key);
+            while(m_index[slot] != idx) { assert(m_index[slot] != empty_slot); slot = ((slot + 1) & mask); }
+            return slot;
+        }
+
+        inline void index_slot(uint32_t idx) {
+            auto mask = m_index.size() - 1;
+            auto slot = home_slot(m_entries[idx].first);
+            while(m_index[slot] != empty_slot) { slot = ((slot + 1) & mask); }
+            m_index[slot] = idx;
+        }
+
+        inline void index_inserted(size_type pos) {
+            if(m_index.empty() || (2 * size() > m_index.size())) { rebuild_index(); return; }
+
+            // the entries behind the new one moved one position to the back;
+            // renumber them back to front so that positions stay unique
+            for(auto q = size() - 1; q > pos; --q) {
+                m_index[slot_of(m_entries[q].first, static_cast<uint32_t>(q - 1))] = static_cast<uint32_t>(q);
+            }
+            index_slot(static_cast<uint32_t>(pos));
+        }
+
+        /// Called before the entry at `pos` gets removed from `m_entries`.
+        inline void index_erased(size_type pos) {
+            if(m_index.empty()) { return; }
+            if(size() - 1 <= hash_threshold) { m_index.clear(); return; }
+
+            // backward shift deletion keeps the probe sequences intact
+            // without leaving tombstones behind
+            auto mask = m_index.size() - 1;
+            auto hole = slot_of(m_entries[pos].first, static_cast<uint32_t>(pos));
+            for(auto slot = ((hole + 1) & mask); m_index[slot] != empty_slot; slot = ((slot + 1) & mask)) {
+                auto home = home_slot(m_entries[m_index[slot]].first);
+                if(((slot - home) & mask) >= ((slot - hole) & mask)) {
+                    m_index[hole] = m_index[slot];
+                    hole = slot;
+                }
+            }
+            m_index[hole] = empty_slot;
+
+            // the entries behind the erased one will move one position to the front
+            for(auto q = pos + 1, n = size(); q < n; ++q) {
+                m_index[slot_of(m_entries[q].first, static_cast<uint32_t>(q))] = static_cast<uint32_t>(q - 1);
+            }
+        }
+
+        inline void rebuild_index() {
+            m_index.clear();
+            if(size() <= hash_threshold) { return; }
+
+            // keep the load factor of the linear probing table below 50%
+            size_type cap = 2 * hash_threshold;
+            while(cap < 4 * size()) { cap *= 2; }
+            m_index.assign(cap, empty_slot);
+            for(size_type i = 0, n = size(); i < n; ++i) { index_slot(static_cast<uint32_t>(i)); }
+        }
+
+        storage_type    m_entries;
+        index_type      m_index;
+    };
+
+    template<typename KEY, typename VALUE, typename HASH, typename LESS, typename ALLOC>
+    const typename flat_dict<KEY, VALUE, HASH, LESS, ALLOC>::size_type flat_dict<KEY, VALUE, HASH, LESS, ALLOC>::hash_threshold;
+
+    template<typename KEY, typename VALUE, typename HASH, typename LESS, typename ALLOC>
+    const uint32_t flat_dict<KEY, VALUE, HASH, LESS, ALLOC>::empty_slot;
+
+} // namespace mirror
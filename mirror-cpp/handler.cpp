@@ -0,0 +1,296 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "handler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+//
+// value_handler
+//
+
+const size_t mirror::value_handler::unknown_size;
+
+mirror::value_handler::~value_handler() { }
+
+void mirror::value_handler::int_array(
+    int64_t const* data,
+    size_t size
+) {
+    begin_array(size);
+    for(size_t i = 0; i < size; ++i) { int64(data[i]); }
+    end_array();
+}
+
+void mirror::value_handler::double_array(
+    double const* data,
+    size_t size
+) {
+    begin_array(size);
+    for(size_t i = 0; i < size; ++i) { float64(data[i]); }
+    end_array();
+}
+
+void mirror::value_handler::bool_array(
+    uint8_t const* bits,
+    size_t size
+) {
+    begin_array(size);
+    for(size_t i = 0; i < size; ++i) { boolean(((bits[i / 8] >> (i % 8)) & 1) != 0); }
+    end_array();
+}
+
+void mirror::value_handler::object(
+    std::shared_ptr<void> const&,
+    std::type_info const& type
+) {
+    throw std::runtime_error(std::string("value_handler: can not handle an object of type: ") + type.name());
+}
+
+//
+// walk
+//
+
+void mirror::walk(
+    value const& v,
+    value_handler& handler
+) {
+    switch(v.kind()) {
+        case value_kind::null:          handler.null(); break;
+        case value_kind::boolean:       handler.boolean(v.as_bool()); break;
+        case value_kind::integer:       handler.int64(v.as_int()); break;
+        case value_kind::floating:      handler.float64(v.as_double()); break;
+        case value_kind::string:
+        case value_kind::string_ref:    handler.string(v.as_string_ref()); break;
+        case value_kind::array: {
+            auto&& a = v.as_array();
+            handler.begin_array(a.size());
+            for(auto&& e : a) { walk(e, handler); }
+            handler.end_array();
+            break;
+        }
+        case value_kind::dict: {
+            auto&& d = v.as_dict();
+            handler.begin_dict(d.size());
+            for(auto&& e : d) {
+                handler.key(e.first.str());
+                walk(e.second, handler);
+            }
+            handler.end_dict();
+            break;
+        }
+        case value_kind::int_array: {
+            auto&& a = v.as_int_array();
+            handler.int_array(a.data(), a.size());
+            break;
+        }
+        case value_kind::double_array: {
+            auto&& a = v.as_double_array();
+            handler.double_array(a.data(), a.size());
+            break;
+        }
+        case value_kind::bool_array: {
+            auto&& a = v.as_bool_array();
+            std::vector<uint8_t> bits((a.size() + 7) / 8, 0);
+            for(size_t i = 0; i < a.size(); ++i) {
+                if(a[i]) { bits[i / 8] = static_cast<uint8_t>(bits[i / 8] | (1 << (i % 8))); }
+            }
+            handler.bool_array(bits.data(), a.size());
+            break;
+        }
+        case value_kind::object:        handler.object(v.m_obj, *v.m_type); break;
+    }
+}
+
+//
+// value_builder
+//
+
+namespace {
+
+    // dicts up to this size get their entries inserted in the order
+    // received; larger ones get sorted first (inserting into the middle of
+    // a large `flat_dict` is O(n))
+    static const size_t BULK_DICT_SIZE = 32;
+
+} // namespace
+
+mirror::value_builder::value_builder(
+    value_arena* arena
+) : m_arena(arena), m_borrow(false), m_done(false) { }
+
+mirror::value_builder::~value_builder() { }
+
+void mirror::value_builder::add(
+    value v
+) {
+    if(m_levels.empty()) {
+        assert(!m_done);
+        m_result = std::move(v);
+        m_done = true;
+        return;
+    }
+
+    auto& top = m_levels.back();
+    if(top.array) {
+        top.array->emplace_back(std::move(v));
+    } else {
+        m_entries[m_levels.size() - 1].emplace_back(top.key, std::move(v));
+    }
+}
+
+void mirror::value_builder::null(
+) {
+    add(value());
+}
+
+void mirror::value_builder::boolean(
+    bool v
+) {
+    add(value(v));
+}
+
+void mirror::value_builder::int64(
+    int64_t v
+) {
+    add(value(v));
+}
+
+void mirror::value_builder::float64(
+    double v
+) {
+    add(value(v));
+}
+
+void mirror::value_builder::string(
+    string_ref s
+) {
+    add(m_borrow ? value::borrow_string(s.data, s.size) : value::copy_string(s.data, s.size, m_arena));
+}
+
+void mirror::value_builder::begin_array(
+    size_t size_hint
+) {
+    level l;
+    l.node = value::array(m_arena);
+    l.array = &l.node.as_array();
+    if(size_hint != unknown_size) { l.array->reserve(size_hint); }
+    m_levels.push_back(std::move(l));
+}
+
+void mirror::value_builder::end_array(
+) {
+    assert(!m_levels.empty() && m_levels.back().array);
+    auto node = std::move(m_levels.back().node);
+    m_levels.pop_back();
+    add(std::move(node));
+}
+
+void mirror::value_builder::begin_dict(
+    size_t
+) {
+    level l;
+    l.node = value::dict(m_arena);
+    l.array = nullptr;
+    m_levels.push_back(std::move(l));
+    if(m_entries.size() < m_levels.size()) { m_entries.resize(m_levels.size()); }
+}
+
+void mirror::value_builder::key(
+    string_ref k
+) {
+    assert(!m_levels.empty() && !m_levels.back().array);
+    m_levels.back().key = m_keys.get(k.data, k.size);
+}
+
+void mirror::value_builder::end_dict(
+) {
+    assert(!m_levels.empty() && !m_levels.back().array);
+    auto& entries = m_entries[m_levels.size() - 1];
+    auto& dict = m_levels.back().node.as_dict();
+
+    if(entries.size() > BULK_DICT_SIZE) {
+        std::stable_sort(
+            entries.begin(), entries.end(),
+            [](std::pair<atom, value> const& a, std::pair<atom, value> const& b) { return (a.first < b.first); }
+        );
+    }
+    for(auto&& e : entries) { dict[e.first] = std::move(e.second); } // the last duplicate wins
+    entries.clear();
+
+    auto node = std::move(m_levels.back().node);
+    m_levels.pop_back();
+    add(std::move(node));
+}
+
+void mirror::value_builder::int_array(
+    int64_t const* data,
+    size_t size
+) {
+    auto v = value::int_array(m_arena);
+    v.as_int_array().assign(data, data + size);
+    add(std::move(v));
+}
+
+void mirror::value_builder::double_array(
+    double const* data,
+    size_t size
+) {
+    auto v = value::double_array(m_arena);
+    v.as_double_array().assign(data, data + size);
+    add(std::move(v));
+}
+
+void mirror::value_builder::bool_array(
+    uint8_t const* bits,
+    size_t size
+) {
+    auto v = value::bool_array(m_arena);
+    auto& a = v.as_bool_array();
+    a.resize(size);
+    for(size_t i = 0; i < size; ++i) { a[i] = (((bits[i / 8] >> (i % 8)) & 1) != 0); }
+    add(std::move(v));
+}
+
+void mirror::value_builder::object(
+    std::shared_ptr<void> const& obj,
+    std::type_info const& type
+) {
+    value v;
+    if(obj) {
+        v.m_obj  = obj;
+        v.m_type = &type;
+        v.m_kind = value_kind::object;
+    }
+    add(std::move(v));
+}
+
+mirror::value mirror::value_builder::take(
+) {
+    assert(done());
+    m_done = false;
+    return std::move(m_result);
+}
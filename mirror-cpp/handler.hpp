@@ -0,0 +1,141 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include "mirror-cpp.hpp"
+#include "value.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace mirror {
+
+    /// Receives a value as a stream of events, e.g.
+    ///
+    ///     {"a":[1,true]}  ->  begin_dict(1) key("a") begin_array(2) int64(1) boolean(true) end_array() end_dict()
+    ///
+    /// Producers (`walk()`, `parse_json()`, `from_binary()`) and consumers
+    /// (`value_builder`, `json_writer`) can be chained without materializing
+    /// the (whole) tree in between. Strings and keys passed to a handler are
+    /// only valid during the call.
+    struct MIRROR_API value_handler {
+        /// Passed to `begin_array()`/`begin_dict()` if the number of elements
+        /// is not known up front.
+        static const size_t unknown_size = static_cast<size_t>(-1);
+
+        virtual ~value_handler();
+
+        virtual void null()                  = 0;
+        virtual void boolean(bool v)         = 0;
+        virtual void int64(int64_t v)        = 0;
+        virtual void float64(double v)       = 0;
+        virtual void string(string_ref s)    = 0;
+
+        virtual void begin_array(size_t size_hint) = 0;
+        virtual void end_array()                   = 0;
+
+        virtual void begin_dict(size_t size_hint)  = 0;
+        virtual void key(string_ref k)             = 0; ///< before each value of a dict
+        virtual void end_dict()                    = 0;
+
+        /// Homogeneous arrays in one go; the default implementations forward
+        /// to `begin_array()`, the element events and `end_array()`. Bools
+        /// are bit-packed, least significant bit first.
+        virtual void int_array(int64_t const* data, size_t size);
+        virtual void double_array(double const* data, size_t size);
+        virtual void bool_array(uint8_t const* bits, size_t size);
+
+        /// Object pointers; the default implementation throws a
+        /// `std::runtime_error`.
+        virtual void object(std::shared_ptr<void> const& obj, std::type_info const& type);
+    };
+
+    /// Emits the events for `v` (and all its children) to `handler`.
+    MIRROR_API void walk(value const& v, value_handler& handler);
+
+    /// Builds a value from the events it receives; arrays, dicts and strings
+    /// get allocated from `arena` if given. Large dicts get collected and
+    /// inserted in key order at `end_dict()`, so the order of the keys in
+    /// the event stream does not matter.
+    struct MIRROR_API value_builder final : value_handler {
+        explicit value_builder(value_arena* arena = nullptr);
+        ~value_builder();
+
+        void null()                  override final;
+        void boolean(bool v)         override final;
+        void int64(int64_t v)        override final;
+        void float64(double v)       override final;
+        void string(string_ref s)    override final;
+
+        void begin_array(size_t size_hint) override final;
+        void end_array()                   override final;
+
+        void begin_dict(size_t size_hint)  override final;
+        void key(string_ref k)             override final;
+        void end_dict()                    override final;
+
+        void int_array(int64_t const* data, size_t size)    override final;
+        void double_array(double const* data, size_t size)  override final;
+        void bool_array(uint8_t const* bits, size_t size)   override final;
+
+        void object(std::shared_ptr<void> const& obj, std::type_info const& type) override final;
+
+        /// Strings are stored as `value_kind::string_ref` referring to the
+        /// characters passed to `string()`; only valid for producers which
+        /// guarantee that these outlive the built value (e.g. `from_binary()`).
+        inline void borrow_strings(bool borrow) { m_borrow = borrow; }
+
+        /// `true` once a complete (top level) value has been received.
+        inline bool done() const { return (m_done && m_levels.empty()); }
+
+        /// The built value; resets the builder.
+        value take();
+
+    private:
+        value_builder(value_builder const&) = delete;
+        value_builder& operator=(value_builder const&) = delete;
+
+        typedef std::vector<std::pair<atom, value>> entries_type;
+
+        struct level {
+            value               node;
+            value::array_t*     array; // or null for dicts
+            atom                key;
+        };
+
+        void add(value v);
+
+        value_arena* const          m_arena;
+        bool                        m_borrow;
+        bool                        m_done;
+        value                       m_result;
+        std::vector<level>          m_levels;
+        std::vector<entries_type>   m_entries; // per dict nesting level, reused
+        atom_cache                  m_keys;
+    };
+
+} // namespace mirror
@@ -0,0 +1,1099 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "json.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <clocale>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#   define MIRROR_CPP_JSON_SSE2
+#   include <emmintrin.h>
+#endif // defined(__SSE2__) || defined(_M_X64)
+
+namespace {
+
+    static const char DIGIT_PAIRS[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    // non-zero for all bytes which need to be escaped in a JSON string
+    struct escape_table {
+        unsigned char needs_escape[256];
+
+        escape_table() {
+            for(int c = 0; c < 256; ++c) { needs_escape[c] = ((c < 0x20) || (c == '"') || (c == '\\')); }
+        }
+    };
+
+    static const escape_table ESCAPES;
+
+    inline int count_trailing_zeros(unsigned int x) {
+        assert(x != 0);
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanForward(&idx, x);
+        return static_cast<int>(idx);
+#else // defined(_MSC_VER)
+        return __builtin_ctz(x);
+#endif // defined(_MSC_VER)
+    }
+
+    //
+    // shortest round trip formatting of doubles based on the Grisu2 algorithm
+    // by Florian Loitsch ("Printing Floating-Point Numbers Quickly and
+    // Accurately with Integers"); the output always reads back to the same
+    // double and is the shortest representation in almost all cases
+    //
+
+    struct diy_fp {
+        uint64_t    f;
+        int         e;
+
+        inline diy_fp(uint64_t f_, int e_) : f(f_), e(e_) { }
+
+        static inline diy_fp sub(diy_fp const& x, diy_fp const& y) {
+            assert((x.e == y.e) && (x.f >= y.f));
+            return diy_fp(x.f - y.f, x.e);
+        }
+
+        // the upper 64 bits of the 128 bit product, rounded
+        static inline diy_fp mul(diy_fp const& x, diy_fp const& y) {
+            auto u_lo = (x.f & 0xFFFFFFFFu), u_hi = (x.f >> 32);
+            auto v_lo = (y.f & 0xFFFFFFFFu), v_hi = (y.f >> 32);
+
+            auto p0 = u_lo * v_lo;
+            auto p1 = u_lo * v_hi;
+            auto p2 = u_hi * v_lo;
+            auto p3 = u_hi * v_hi;
+
+            auto q = (p0 >> 32) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+            q += (uint64_t(1) << 31);
+
+            return diy_fp(p3 + (p2 >> 32) + (p1 >> 32) + (q >> 32), x.e + y.e + 64);
+        }
+
+        static inline diy_fp normalize(diy_fp x) {
+            assert(x.f != 0);
+            while((x.f >> 63) == 0) { x.f <<= 1; --x.e; }
+            return x;
+        }
+
+        static inline diy_fp normalize_to(diy_fp const& x, int e) {
+            assert(x.e >= e);
+            return diy_fp(x.f << (x.e - e), e);
+        }
+    };
+
+    // the normalized value v and its boundaries m- and m+ (with the same exponent as m+)
+    struct boundaries {
+        diy_fp w, minus, plus;
+    };
+
+    inline boundaries compute_boundaries(double v) {
+        assert(std::isfinite(v) && (v > 0));
+
+        static const int        PRECISION   = 53;
+        static const int        BIAS        = 1023 + (PRECISION - 1);
+        static const int        MIN_EXP     = 1 - BIAS;
+        static const uint64_t   HIDDEN_BIT  = (uint64_t(1) << (PRECISION - 1));
+
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        auto E = static_cast<int>(bits >> (PRECISION - 1));
+        auto F = (bits & (HIDDEN_BIT - 1));
+
+        auto x = ((E == 0) ? diy_fp(F, MIN_EXP) : diy_fp(F + HIDDEN_BIT, E - BIAS));
+
+        // the lower boundary is closer if v is a power of two (and not the smallest normal)
+        auto lower_is_closer = ((F == 0) && (E > 1));
+        auto m_plus  = diy_fp(2 * x.f + 1, x.e - 1);
+        auto m_minus = (lower_is_closer ? diy_fp(4 * x.f - 1, x.e - 2) : diy_fp(2 * x.f - 1, x.e - 1));
+
+        auto w_plus  = diy_fp::normalize(m_plus);
+        auto w_minus = diy_fp::normalize_to(m_minus, w_plus.e);
+
+        boundaries res = { diy_fp::normalize(x), w_minus, w_plus };
+        return res;
+    }
+
+    // the exponent range [ALPHA, GAMMA] for the scaled value as required by the digit generation
+    static const int ALPHA = -60;
+    static const int GAMMA = -32;
+
+    struct cached_power {
+        uint64_t    f;
+        int         e;
+        int         k; // c = f * 2^e ~= 10^k
+    };
+
+    static const int CACHED_POWERS_MIN_DEC_EXP  = -300;
+    static const int CACHED_POWERS_DEC_STEP     = 8;
+
+    static const cached_power CACHED_POWERS[] = {
+        { 0xAB70FE17C79AC6CA, -1060, -300 },
+        { 0xFF77B1FCBEBCDC4F, -1034, -292 },
+        { 0xBE5691EF416BD60C, -1007, -284 },
+        { 0x8DD01FAD907FFC3C,  -980, -276 },
+        { 0xD3515C2831559A83,  -954, -268 },
+        { 0x9D71AC8FADA6C9B5,  -927, -260 },
+        { 0xEA9C227723EE8BCB,  -901, -252 },
+        { 0xAECC49914078536D,  -874, -244 },
+        { 0x823C12795DB6CE57,  -847, -236 },
+        { 0xC21094364DFB5637,  -821, -228 },
+        { 0x9096EA6F3848984F,  -794, -220 },
+        { 0xD77485CB25823AC7,  -768, -212 },
+        { 0xA086CFCD97BF97F4,  -741, -204 },
+        { 0xEF340A98172AACE5,  -715, -196 },
+        { 0xB23867FB2A35B28E,  -688, -188 },
+        { 0x84C8D4DFD2C63F3B,  -661, -180 },
+        { 0xC5DD44271AD3CDBA,  -635, -172 },
+        { 0x936B9FCEBB25C996,  -608, -164 },
+        { 0xDBAC6C247D62A584,  -582, -156 },
+        { 0xA3AB66580D5FDAF6,  -555, -148 },
+        { 0xF3E2F893DEC3F126,  -529, -140 },
+        { 0xB5B5ADA8AAFF80B8,  -502, -132 },
+        { 0x87625F056C7C4A8B,  -475, -124 },
+        { 0xC9BCFF6034C13053,  -449, -116 },
+        { 0x964E858C91BA2655,  -422, -108 },
+        { 0xDFF9772470297EBD,  -396, -100 },
+        { 0xA6DFBD9FB8E5B88F,  -369,  -92 },
+        { 0xF8A95FCF88747D94,  -343,  -84 },
+        { 0xB94470938FA89BCF,  -316,  -76 },
+        { 0x8A08F0F8BF0F156B,  -289,  -68 },
+        { 0xCDB02555653131B6,  -263,  -60 },
+        { 0x993FE2C6D07B7FAC,  -236,  -52 },
+        { 0xE45C10C42A2B3B06,  -210,  -44 },
+        { 0xAA242499697392D3,  -183,  -36 },
+        { 0xFD87B5F28300CA0E,  -157,  -28 },
+        { 0xBCE5086492111AEB,  -130,  -20 },
+        { 0x8CBCCC096F5088CC,  -103,  -12 },
+        { 0xD1B71758E219652C,   -77,   -4 },
+        { 0x9C40000000000000,   -50,    4 },
+        { 0xE8D4A51000000000,   -24,   12 },
+        { 0xAD78EBC5AC620000,     3,   20 },
+        { 0x813F3978F8940984,    30,   28 },
+        { 0xC097CE7BC90715B3,    56,   36 },
+        { 0x8F7E32CE7BEA5C70,    83,   44 },
+        { 0xD5D238A4ABE98068,   109,   52 },
+        { 0x9F4F2726179A2245,   136,   60 },
+        { 0xED63A231D4C4FB27,   162,   68 },
+        { 0xB0DE65388CC8ADA8,   189,   76 },
+        { 0x83C7088E1AAB65DB,   216,   84 },
+        { 0xC45D1DF942711D9A,   242,   92 },
+        { 0x924D692CA61BE758,   269,  100 },
+        { 0xDA01EE641A708DEA,   295,  108 },
+        { 0xA26DA3999AEF774A,   322,  116 },
+        { 0xF209787BB47D6B85,   348,  124 },
+        { 0xB454E4A179DD1877,   375,  132 },
+        { 0x865B86925B9BC5C2,   402,  140 },
+        { 0xC83553C5C8965D3D,   428,  148 },
+        { 0x952AB45CFA97A0B3,   455,  156 },
+        { 0xDE469FBD99A05FE3,   481,  164 },
+        { 0xA59BC234DB398C25,   508,  172 },
+        { 0xF6C69A72A3989F5C,   534,  180 },
+        { 0xB7DCBF5354E9BECE,   561,  188 },
+        { 0x88FCF317F22241E2,   588,  196 },
+        { 0xCC20CE9BD35C78A5,   614,  204 },
+        { 0x98165AF37B2153DF,   641,  212 },
+        { 0xE2A0B5DC971F303A,   667,  220 },
+        { 0xA8D9D1535CE3B396,   694,  228 },
+        { 0xFB9B7CD9A4A7443C,   720,  236 },
+        { 0xBB764C4CA7A44410,   747,  244 },
+        { 0x8BAB8EEFB6409C1A,   774,  252 },
+        { 0xD01FEF10A657842C,   800,  260 },
+        { 0x9B10A4E5E9913129,   827,  268 },
+        { 0xE7109BFBA19C0C9D,   853,  276 },
+        { 0xAC2820D9623BF429,   880,  284 },
+        { 0x80444B5E7AA7CF85,   907,  292 },
+        { 0xBF21E44003ACDD2D,   933,  300 },
+        { 0x8E679C2F5E44FF8F,   960,  308 },
+        { 0xD433179D9C8CB841,   986,  316 },
+        { 0x9E19DB92B4E31BA9,  1013,  324 },
+    };
+
+    // returns a cached power c = f * 2^e ~= 10^k with ALPHA <= e_c + e + 64 <= GAMMA
+    inline cached_power get_cached_power(int e) {
+        auto f = ALPHA - e - 1;
+        auto k = (f * 78913) / (1 << 18) + static_cast<int>(f > 0); // ceil(f * log10(2))
+        auto index = (-CACHED_POWERS_MIN_DEC_EXP + k + (CACHED_POWERS_DEC_STEP - 1)) / CACHED_POWERS_DEC_STEP;
+        assert((index >= 0) && (static_cast<size_t>(index) < sizeof(CACHED_POWERS) / sizeof(CACHED_POWERS[0])));
+
+        auto cached = CACHED_POWERS[index];
+        assert((ALPHA <= cached.e + e + 64) && (cached.e + e + 64 <= GAMMA));
+        return cached;
+    }
+
+    // returns the number of decimal digits of n and sets pow10 to 10^(digits - 1)
+    inline int find_largest_pow10(uint32_t n, uint32_t& pow10) {
+        static const uint32_t POW10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+        auto k = 10;
+        while((k > 1) && (n < POW10[k - 1])) { --k; }
+        pow10 = POW10[k - 1];
+        return k;
+    }
+
+    inline void grisu2_round(char* buf, int len, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t ten_k) {
+        // move the last digit towards w as long as the result stays within [M-, M+]
+        while((rest < dist) && (delta - rest >= ten_k) && ((rest + ten_k < dist) || (dist - rest > rest + ten_k - dist))) {
+            --buf[len - 1];
+            rest += ten_k;
+        }
+    }
+
+    inline void grisu2_digit_gen(char* buf, int& len, int& dec_exp, diy_fp const& m_minus, diy_fp const& w, diy_fp const& m_plus) {
+        auto delta   = diy_fp::sub(m_plus, m_minus).f;
+        auto p1_dist = diy_fp::sub(m_plus, w).f;
+
+        auto one = diy_fp(uint64_t(1) << -m_plus.e, m_plus.e);
+
+        auto p1 = static_cast<uint32_t>(m_plus.f >> -one.e); // integral part
+        auto p2 = (m_plus.f & (one.f - 1));                  // fractional part
+
+        uint32_t pow10;
+        auto n = find_largest_pow10(p1, pow10);
+
+        while(n > 0) {
+            auto d = p1 / pow10;
+            p1 %= pow10;
+            buf[len++] = static_cast<char>('0' + d);
+            --n;
+
+            auto rest = ((uint64_t(p1) << -one.e) + p2);
+            if(rest <= delta) {
+                dec_exp += n;
+                grisu2_round(buf, len, p1_dist, delta, rest, uint64_t(pow10) << -one.e);
+                return;
+            }
+            pow10 /= 10;
+        }
+
+        auto m = 0;
+        for(;;) {
+            p2 *= 10;
+            auto d = (p2 >> -one.e);
+            p2 &= (one.f - 1);
+            buf[len++] = static_cast<char>('0' + d);
+            ++m;
+            delta   *= 10;
+            p1_dist *= 10;
+            if(p2 <= delta) { break; }
+        }
+        dec_exp -= m;
+        grisu2_round(buf, len, p1_dist, delta, p2, one.f);
+    }
+
+    // generates the decimal digits of v > 0 into buf; v = buf * 10^dec_exp
+    inline void grisu2(char* buf, int& len, int& dec_exp, double v) {
+        auto b = compute_boundaries(v);
+        auto cached = get_cached_power(b.plus.e);
+        auto c = diy_fp(cached.f, cached.e);
+
+        auto w       = diy_fp::mul(b.w,     c);
+        auto w_minus = diy_fp::mul(b.minus, c);
+        auto w_plus  = diy_fp::mul(b.plus,  c);
+
+        // shrink the interval by one ulp on each side to account for the rounding errors
+        auto m_minus = diy_fp(w_minus.f + 1, w_minus.e);
+        auto m_plus  = diy_fp(w_plus.f  - 1, w_plus.e);
+
+        len = 0;
+        dec_exp = -cached.k;
+        grisu2_digit_gen(buf, len, dec_exp, m_minus, w, m_plus);
+    }
+
+    // formats the digits buf[0, len) * 10^dec_exp; returns the new length
+    inline int format_digits(char* buf, int len, int dec_exp) {
+        static const int MIN_EXP = -4;
+        static const int MAX_EXP = 15;
+
+        auto k = len;
+        auto n = len + dec_exp; // position of the decimal point
+
+        if((k <= n) && (n <= MAX_EXP)) { // digits[000].0
+            std::memset(buf + k, '0', static_cast<size_t>(n - k));
+            buf[n] = '.';
+            buf[n + 1] = '0';
+            return (n + 2);
+        }
+
+        if((0 < n) && (n <= MAX_EXP)) { // dig.its
+            std::memmove(buf + n + 1, buf + n, static_cast<size_t>(k - n));
+            buf[n] = '.';
+            return (k + 1);
+        }
+
+        if((MIN_EXP < n) && (n <= 0)) { // 0.[000]digits
+            std::memmove(buf + 2 - n, buf, static_cast<size_t>(k));
+            buf[0] = '0';
+            buf[1] = '.';
+            std::memset(buf + 2, '0', static_cast<size_t>(-n));
+            return (2 - n + k);
+        }
+
+        // d.igitse+123
+        auto p = buf + 1;
+        if(k > 1) {
+            std::memmove(buf + 2, buf + 1, static_cast<size_t>(k - 1));
+            buf[1] = '.';
+            p = buf + 1 + k;
+        }
+        *p++ = 'e';
+
+        auto e = n - 1;
+        *p++ = ((e < 0) ? '-' : '+');
+        if(e < 0) { e = -e; }
+        if(e >= 100) { *p++ = static_cast<char>('0' + e / 100); e %= 100; *p++ = static_cast<char>('0' + e / 10); }
+        else if(e >= 10) { *p++ = static_cast<char>('0' + e / 10); }
+        *p++ = static_cast<char>('0' + e % 10);
+
+        return static_cast<int>(p - buf);
+    }
+
+    // returns the position of the first byte in [i, n) which needs to be escaped
+    // (or needs special handling while parsing a string), or n
+    inline size_t find_escape(char const* s, size_t i, size_t n) {
+#if defined(MIRROR_CPP_JSON_SSE2)
+        auto const quote     = _mm_set1_epi8('"');
+        auto const backslash = _mm_set1_epi8('\\');
+        auto const ctrl_max  = _mm_set1_epi8(0x1F);
+        for(; i + 16 <= n; i += 16) {
+            auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+            auto m = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl_max), v) // unsigned v <= 0x1F
+            );
+            auto mask = static_cast<unsigned int>(_mm_movemask_epi8(m));
+            if(mask != 0) { return (i + count_trailing_zeros(mask)); }
+        }
+#endif // defined(MIRROR_CPP_JSON_SSE2)
+        for(; i < n; ++i) {
+            if(ESCAPES.needs_escape[static_cast<unsigned char>(s[i])]) { return i; }
+        }
+        return n;
+    }
+
+} // namespace
+
+mirror::json_writer::json_writer(
+    std::string& out
+) : m_str(&out), m_file(nullptr), m_begin(nullptr), m_cur(nullptr), m_end(nullptr) {
+    if(!out.empty()) {
+        m_begin = &out[0];
+        m_cur = m_end = m_begin + out.size();
+    }
+}
+
+mirror::json_writer::json_writer(
+    FILE* file,
+    size_t buffer_size
+) : m_str(nullptr), m_file(file), m_file_buf(std::max(buffer_size, size_t(64)), '\0') {
+    assert(file);
+    m_begin = m_cur = &m_file_buf[0];
+    m_end = m_begin + m_file_buf.size();
+}
+
+mirror::json_writer::~json_writer() {
+    try { flush(); } catch(...) { }
+}
+
+void mirror::json_writer::flush() {
+    if(m_str) {
+        m_str->resize(static_cast<size_t>(m_cur - m_begin));
+        m_begin = (m_str->empty() ? nullptr : &(*m_str)[0]);
+        m_cur = m_end = m_begin + m_str->size();
+        return;
+    }
+
+    auto n = static_cast<size_t>(m_cur - m_begin);
+    if((n > 0) && (std::fwrite(m_begin, 1, n, m_file) != n)) {
+        throw std::runtime_error("json_writer: writing to file failed");
+    }
+    m_cur = m_begin;
+}
+
+void mirror::json_writer::make_room(
+    size_t n
+) {
+    if(m_str) {
+        auto used = static_cast<size_t>(m_cur - m_begin);
+        m_str->resize(std::max(std::max(2 * m_str->size(), used + n), size_t(256)));
+        m_begin = &(*m_str)[0];
+        m_cur = m_begin + used;
+        m_end = m_begin + m_str->size();
+        return;
+    }
+
+    flush();
+    assert(n <= static_cast<size_t>(m_end - m_begin));
+}
+
+void mirror::json_writer::put(
+    char const* s,
+    size_t n
+) {
+    if(m_file && (n > static_cast<size_t>(m_end - m_cur))) {
+        flush();
+        if(n >= m_file_buf.size()) { // big chunks bypass the buffer
+            if(std::fwrite(s, 1, n, m_file) != n) { throw std::runtime_error("json_writer: writing to file failed"); }
+            return;
+        }
+    }
+
+    ensure(n);
+    std::memcpy(m_cur, s, n);
+    m_cur += n;
+}
+
+void mirror::json_writer::write_int(
+    int64_t v
+) {
+    char buf[24];
+    auto end = buf + sizeof(buf);
+    auto p = end;
+
+    auto u = ((v < 0) ? (0 - static_cast<uint64_t>(v)) : static_cast<uint64_t>(v));
+    while(u >= 100) {
+        auto idx = static_cast<size_t>(u % 100) * 2;
+        u /= 100;
+        *--p = DIGIT_PAIRS[idx + 1];
+        *--p = DIGIT_PAIRS[idx];
+    }
+    if(u < 10) {
+        *--p = static_cast<char>('0' + u);
+    } else {
+        auto idx = static_cast<size_t>(u) * 2;
+        *--p = DIGIT_PAIRS[idx + 1];
+        *--p = DIGIT_PAIRS[idx];
+    }
+    if(v < 0) { *--p = '-'; }
+
+    put(p, static_cast<size_t>(end - p));
+}
+
+void mirror::json_writer::write_double(
+    double v
+) {
+    if(!std::isfinite(v)) { put("null", 4); return; }
+
+    // fast path for integral values which are exactly representable
+    if((v == std::floor(v)) && (std::fabs(v) < 9007199254740992.0)) {
+        if((v == 0.0) && std::signbit(v)) { put("-0.0", 4); return; }
+        write_int(static_cast<int64_t>(v));
+        put(".0", 2);
+        return;
+    }
+
+    char buf[32];
+    auto p = buf;
+    if(v < 0) { *p++ = '-'; v = -v; }
+
+    int len, dec_exp;
+    grisu2(p, len, dec_exp, v);
+    len = format_digits(p, len, dec_exp);
+
+    put(buf, static_cast<size_t>(p - buf) + static_cast<size_t>(len));
+}
+
+void mirror::json_writer::write_string(
+    char const* s,
+    size_t n
+) {
+    static const char HEX[] = "0123456789abcdef";
+
+    put('"');
+    for(size_t i = 0; i < n; ) {
+        auto j = find_escape(s, i, n);
+        put(s + i, j - i);
+        if(j == n) { break; }
+
+        auto c = static_cast<unsigned char>(s[j]);
+        switch(c) {
+            case '"':   put("\\\"", 2); break;
+            case '\\':  put("\\\\", 2); break;
+            case '\b':  put("\\b",  2); break;
+            case '\f':  put("\\f",  2); break;
+            case '\n':  put("\\n",  2); break;
+            case '\r':  put("\\r",  2); break;
+            case '\t':  put("\\t",  2); break;
+            default: {
+                char esc[6] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF] };
+                put(esc, 6);
+            }
+        }
+        i = j + 1;
+    }
+    put('"');
+}
+
+void mirror::json_writer::write_value(
+    value const& v
+) {
+    switch(v.kind()) {
+        case value_kind::null:      put("null", 4); break;
+        case value_kind::boolean:   if(v.as_bool()) { put("true", 4); } else { put("false", 5); } break;
+        case value_kind::integer:   write_int(v.as_int()); break;
+        case value_kind::floating:  write_double(v.as_double()); break;
+        case value_kind::string: {
+            auto&& s = v.as_string();
+            write_string(s.data(), s.size());
+            break;
+        }
+        case value_kind::string_ref: {
+            auto s = v.as_string_ref();
+            write_string(s.data, s.size);
+            break;
+        }
+        case value_kind::array: {
+            put('[');
+            auto first = true;
+            for(auto&& e : v.as_array()) {
+                if(!first) { put(','); }
+                first = false;
+                write_value(e);
+            }
+            put(']');
+            break;
+        }
+        case value_kind::dict: {
+            put('{');
+            auto first = true;
+            for(auto&& e : v.as_dict()) {
+                if(!first) { put(','); }
+                first = false;
+                auto&& k = e.first.str();
+                write_string(k.data(), k.size());
+                put(':');
+                write_value(e.second);
+            }
+            put('}');
+            break;
+        }
+        case value_kind::int_array: {
+            put('[');
+            auto first = true;
+            for(auto e : v.as_int_array()) {
+                if(!first) { put(','); }
+                first = false;
+                write_int(e);
+            }
+            put(']');
+            break;
+        }
+        case value_kind::double_array: {
+            put('[');
+            auto first = true;
+            for(auto e : v.as_double_array()) {
+                if(!first) { put(','); }
+                first = false;
+                write_double(e);
+            }
+            put(']');
+            break;
+        }
+        case value_kind::bool_array: {
+            put('[');
+            auto first = true;
+            for(auto e : v.as_bool_array()) {
+                if(!first) { put(','); }
+                first = false;
+                if(e) { put("true", 4); } else { put("false", 5); }
+            }
+            put(']');
+            break;
+        }
+        case value_kind::object:
+            throw std::runtime_error(std::string("json_writer: can not serialize an object of type: ") + v.m_type->name());
+    }
+}
+
+void mirror::json_writer::write(
+    value const& v
+) {
+    write_value(v);
+}
+
+void mirror::json_writer::before_value(
+) {
+    if(m_first.empty()) { return; }
+    if(m_first.back()) { m_first.back() = false; return; }
+    put(',');
+}
+
+void mirror::json_writer::null(
+) {
+    before_value();
+    put("null", 4);
+}
+
+void mirror::json_writer::boolean(
+    bool v
+) {
+    before_value();
+    if(v) { put("true", 4); } else { put("false", 5); }
+}
+
+void mirror::json_writer::int64(
+    int64_t v
+) {
+    before_value();
+    write_int(v);
+}
+
+void mirror::json_writer::float64(
+    double v
+) {
+    before_value();
+    write_double(v);
+}
+
+void mirror::json_writer::string(
+    string_ref s
+) {
+    before_value();
+    write_string(s.data, s.size);
+}
+
+void mirror::json_writer::begin_array(
+    size_t
+) {
+    before_value();
+    put('[');
+    m_first.push_back(true);
+}
+
+void mirror::json_writer::end_array(
+) {
+    assert(!m_first.empty());
+    m_first.pop_back();
+    put(']');
+}
+
+void mirror::json_writer::begin_dict(
+    size_t
+) {
+    before_value();
+    put('{');
+    m_first.push_back(true);
+}
+
+// the value following a key must not get a separator, so the key writes
+// the separator and marks the dict as "first" again for the value
+void mirror::json_writer::key(
+    string_ref k
+) {
+    assert(!m_first.empty());
+    if(!m_first.back()) { put(','); }
+    write_string(k.data, k.size);
+    put(':');
+    m_first.back() = true;
+}
+
+void mirror::json_writer::end_dict(
+) {
+    assert(!m_first.empty());
+    m_first.pop_back();
+    put('}');
+}
+
+std::string mirror::to_json(
+    value const& v
+) {
+    std::string res;
+    to_json(v, res);
+    return res;
+}
+
+void mirror::to_json(
+    value const& v,
+    std::string& out
+) {
+    json_writer w(out);
+    w.write(v);
+    w.flush();
+}
+
+void mirror::to_json(
+    value const& v,
+    FILE* file
+) {
+    json_writer w(file);
+    w.write(v);
+    w.flush();
+}
+
+//
+// JSON parser
+//
+
+mirror::json_parse_error::json_parse_error(
+    std::string const& msg,
+    size_t off
+) : std::runtime_error(msg + " at offset " + std::to_string(off)), offset(off) { }
+
+namespace {
+
+    static const int MAX_DEPTH = 512;
+
+    static const double EXACT_POW10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    inline bool is_digit(char c) { return ((c >= '0') && (c <= '9')); }
+    inline bool is_ws(char c)    { return ((c == ' ') || (c == '\n') || (c == '\r') || (c == '\t')); }
+
+    inline int hex_value(char c) {
+        if((c >= '0') && (c <= '9')) { return (c - '0'); }
+        if((c >= 'a') && (c <= 'f')) { return (c - 'a' + 10); }
+        if((c >= 'A') && (c <= 'F')) { return (c - 'A' + 10); }
+        return -1;
+    }
+
+    inline void append_utf8(std::string& out, uint32_t cp) {
+        if(cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if(cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if(cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // emits the events of the parsed document to a `HANDLER` (either a
+    // `value_handler` or the concrete (final) `value_builder`)
+    template<typename HANDLER>
+    struct json_parser {
+        inline json_parser(
+            char const* data, size_t size,
+            HANDLER& handler
+        ) : m_begin(data), m_cur(data), m_end(data + size), m_handler(handler) { }
+
+        inline void parse_document() {
+            skip_ws();
+            parse_value(0);
+            skip_ws();
+            if(m_cur != m_end) { error("unexpected trailing characters", m_cur); }
+        }
+
+    private:
+        void error(char const* msg, char const* pos) const {
+            throw mirror::json_parse_error(msg, static_cast<size_t>(pos - m_begin));
+        }
+
+        inline void skip_ws() {
+            if((m_cur == m_end) || !is_ws(*m_cur)) { return; } // compact JSON
+#if defined(MIRROR_CPP_JSON_SSE2)
+            auto const space = _mm_set1_epi8(' ');
+            auto const nl    = _mm_set1_epi8('\n');
+            auto const cr    = _mm_set1_epi8('\r');
+            auto const tab   = _mm_set1_epi8('\t');
+            while(m_end - m_cur >= 16) {
+                auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(m_cur));
+                auto m = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, nl)),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, cr),    _mm_cmpeq_epi8(v, tab))
+                );
+                auto mask = static_cast<unsigned int>(_mm_movemask_epi8(m));
+                if(mask != 0xFFFF) { m_cur += count_trailing_zeros(~mask); return; }
+                m_cur += 16;
+            }
+#endif // defined(MIRROR_CPP_JSON_SSE2)
+            while((m_cur != m_end) && is_ws(*m_cur)) { ++m_cur; }
+        }
+
+        inline void expect_literal(char const* lit, size_t len) {
+            if((static_cast<size_t>(m_end - m_cur) < len) || (std::memcmp(m_cur, lit, len) != 0)) {
+                error("invalid literal", m_cur);
+            }
+            m_cur += len;
+        }
+
+        void parse_value(int depth) {
+            if(m_cur == m_end) { error("unexpected end of input", m_cur); }
+
+            switch(*m_cur) {
+                case '{': parse_dict(depth); return;
+                case '[': parse_array(depth); return;
+                case '"': {
+                    char const* s; size_t n;
+                    parse_string(s, n);
+                    m_handler.string(mirror::string_ref(s, n));
+                    return;
+                }
+                case 't': expect_literal("true",  4); m_handler.boolean(true);  return;
+                case 'f': expect_literal("false", 5); m_handler.boolean(false); return;
+                case 'n': expect_literal("null",  4); m_handler.null();         return;
+                default:  break;
+            }
+
+            if((*m_cur != '-') && !is_digit(*m_cur)) { error("unexpected character", m_cur); }
+            parse_number();
+        }
+
+        void parse_array(int depth) {
+            if(depth >= MAX_DEPTH) { error("nesting too deep", m_cur); }
+            ++m_cur; // '['
+
+            m_handler.begin_array(mirror::value_handler::unknown_size);
+
+            skip_ws();
+            if((m_cur != m_end) && (*m_cur == ']')) { ++m_cur; m_handler.end_array(); return; }
+
+            for(;;) {
+                skip_ws();
+                parse_value(depth + 1);
+                skip_ws();
+
+                if(m_cur == m_end) { error("unexpected end of input", m_cur); }
+                auto c = *m_cur++;
+                if(c == ']') { m_handler.end_array(); return; }
+                if(c != ',') { error("expected ',' or ']'", m_cur - 1); }
+            }
+        }
+
+        void parse_dict(int depth) {
+            if(depth >= MAX_DEPTH) { error("nesting too deep", m_cur); }
+            ++m_cur; // '{'
+
+            m_handler.begin_dict(mirror::value_handler::unknown_size);
+
+            skip_ws();
+            if((m_cur != m_end) && (*m_cur == '}')) { ++m_cur; m_handler.end_dict(); return; }
+
+            for(;;) {
+                skip_ws();
+                if((m_cur == m_end) || (*m_cur != '"')) { error("expected a string key", m_cur); }
+                char const* s; size_t n;
+                parse_string(s, n);
+                m_handler.key(mirror::string_ref(s, n));
+
+                skip_ws();
+                if((m_cur == m_end) || (*m_cur != ':')) { error("expected ':'", m_cur); }
+                ++m_cur;
+                skip_ws();
+
+                parse_value(depth + 1);
+                skip_ws();
+
+                if(m_cur == m_end) { error("unexpected end of input", m_cur); }
+                auto c = *m_cur++;
+                if(c == '}') { m_handler.end_dict(); return; }
+                if(c != ',') { error("expected ',' or '}'", m_cur - 1); }
+            }
+        }
+
+        // returns the (unescaped) content of the string starting at m_cur;
+        // points into the input if the string has no escape sequences
+        void parse_string(char const*& s, size_t& n) {
+            auto start = ++m_cur; // '"'
+            auto p = start + find_escape(start, 0, static_cast<size_t>(m_end - start));
+            if(p == m_end) { error("unterminated string", start - 1); }
+            if(*p == '"') { s = start; n = static_cast<size_t>(p - start); m_cur = p + 1; return; }
+
+            m_scratch.assign(start, p);
+            for(;;) {
+                auto c = *p;
+                if(c == '"') { break; }
+                if(static_cast<unsigned char>(c) < 0x20) { error("invalid control character in string", p); }
+
+                // c == '\\'
+                if(++p == m_end) { error("unterminated string", start - 1); }
+                switch(*p) {
+                    case '"':   m_scratch += '"';  break;
+                    case '\\':  m_scratch += '\\'; break;
+                    case '/':   m_scratch += '/';  break;
+                    case 'b':   m_scratch += '\b'; break;
+                    case 'f':   m_scratch += '\f'; break;
+                    case 'n':   m_scratch += '\n'; break;
+                    case 'r':   m_scratch += '\r'; break;
+                    case 't':   m_scratch += '\t'; break;
+                    case 'u': {
+                        auto cp = parse_hex4(p + 1);
+                        p += 4;
+                        if((cp >= 0xD800) && (cp <= 0xDBFF)) { // high surrogate
+                            if((m_end - p < 7) || (p[1] != '\\') || (p[2] != 'u')) { error("invalid surrogate pair", p); }
+                            auto lo = parse_hex4(p + 3);
+                            if((lo < 0xDC00) || (lo > 0xDFFF)) { error("invalid surrogate pair", p + 1); }
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                            p += 6;
+                        } else if((cp >= 0xDC00) && (cp <= 0xDFFF)) {
+                            error("invalid surrogate pair", p - 5);
+                        }
+                        append_utf8(m_scratch, cp);
+                        break;
+                    }
+                    default:    error("invalid escape sequence", p - 1);
+                }
+                ++p;
+
+                auto run = find_escape(p, 0, static_cast<size_t>(m_end - p));
+                m_scratch.append(p, run);
+                p += run;
+                if(p == m_end) { error("unterminated string", start - 1); }
+            }
+
+            s = m_scratch.data();
+            n = m_scratch.size();
+            m_cur = p + 1;
+        }
+
+        uint32_t parse_hex4(char const* p) {
+            if(m_end - p < 4) { error("invalid unicode escape", p); }
+            uint32_t cp = 0;
+            for(int i = 0; i < 4; ++i) {
+                auto h = hex_value(p[i]);
+                if(h < 0) { error("invalid unicode escape", p + i); }
+                cp = (cp << 4) | static_cast<uint32_t>(h);
+            }
+            return cp;
+        }
+
+        void parse_number() {
+            auto start = m_cur;
+            auto neg = (*m_cur == '-');
+            if(neg) { ++m_cur; }
+            if((m_cur == m_end) || !is_digit(*m_cur)) { error("invalid number", start); }
+
+            uint64_t mant = 0;
+            auto digits = 0, exp10 = 0;
+            auto is_int = true, truncated = false;
+
+            if(*m_cur == '0') {
+                ++m_cur;
+                if((m_cur != m_end) && is_digit(*m_cur)) { error("leading zeros are not allowed", start); }
+            } else {
+                for(; (m_cur != m_end) && is_digit(*m_cur); ++m_cur) {
+                    if(digits < 19) { mant = mant * 10 + static_cast<unsigned>(*m_cur - '0'); ++digits; }
+                    else            { ++exp10; truncated = true; }
+                }
+            }
+
+            if((m_cur != m_end) && (*m_cur == '.')) {
+                is_int = false;
+                ++m_cur;
+                if((m_cur == m_end) || !is_digit(*m_cur)) { error("invalid number", start); }
+                for(; (m_cur != m_end) && is_digit(*m_cur); ++m_cur) {
+                    auto d = static_cast<unsigned>(*m_cur - '0');
+                    if((mant == 0) && (d == 0)) { --exp10; continue; } // leading zeros are not significant
+                    if(digits < 19) { mant = mant * 10 + d; ++digits; --exp10; }
+                    else            { truncated = true; }
+                }
+            }
+
+            if((m_cur != m_end) && ((*m_cur == 'e') || (*m_cur == 'E'))) {
+                is_int = false;
+                ++m_cur;
+                auto exp_neg = false;
+                if((m_cur != m_end) && ((*m_cur == '+') || (*m_cur == '-'))) { exp_neg = (*m_cur == '-'); ++m_cur; }
+                if((m_cur == m_end) || !is_digit(*m_cur)) { error("invalid number", start); }
+                auto e = 0;
+                for(; (m_cur != m_end) && is_digit(*m_cur); ++m_cur) {
+                    if(e < 100000) { e = e * 10 + (*m_cur - '0'); }
+                }
+                exp10 += (exp_neg ? -e : e);
+            }
+
+            if(is_int && !truncated) {
+                if(!neg && (mant <= static_cast<uint64_t>(INT64_MAX)))    { m_handler.int64(static_cast<int64_t>(mant));     return; }
+                if(neg && (mant <= static_cast<uint64_t>(INT64_MAX) + 1)) { m_handler.int64(static_cast<int64_t>(0 - mant)); return; }
+            }
+
+            // exact for mantissas and powers of ten which are both exactly representable
+            if(!truncated && (mant <= (uint64_t(1) << 53)) && (exp10 >= -22) && (exp10 <= 22)) {
+                auto d = static_cast<double>(mant);
+                d = ((exp10 < 0) ? (d / EXACT_POW10[-exp10]) : (d * EXACT_POW10[exp10]));
+                m_handler.float64(neg ? -d : d);
+                return;
+            }
+
+            // fall back to strtod() (with the decimal point of the current locale)
+            m_scratch.assign(start, m_cur);
+            auto point = std::localeconv()->decimal_point[0];
+            if(point != '.') { std::replace(m_scratch.begin(), m_scratch.end(), '.', point); }
+            m_handler.float64(std::strtod(m_scratch.c_str(), nullptr));
+        }
+
+        char const* const           m_begin;
+        char const*                 m_cur;
+        char const* const           m_end;
+        HANDLER&                    m_handler;
+        std::string                 m_scratch;
+    };
+
+} // namespace
+
+mirror::value mirror::parse_json(
+    char const* data,
+    size_t size,
+    value_arena* arena
+) {
+    assert(data || (size == 0));
+    value_builder builder(arena);
+    json_parser<value_builder>(data, size, builder).parse_document();
+    return builder.take();
+}
+
+mirror::value mirror::parse_json(
+    std::string const& text,
+    value_arena* arena
+) {
+    return parse_json(text.data(), text.size(), arena);
+}
+
+void mirror::parse_json(
+    char const* data,
+    size_t size,
+    value_handler& handler
+) {
+    assert(data || (size == 0));
+    json_parser<value_handler>(data, size, handler).parse_document();
+}
+
+void mirror::parse_json(
+    std::string const& text,
+    value_handler& handler
+) {
+    parse_json(text.data(), text.size(), handler);
+}
@@ -0,0 +1,119 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include "mirror-cpp.hpp"
+#include "handler.hpp"
+#include "value.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace mirror {
+
+    /// Serializes values as (compact) JSON into a reusable string buffer or
+    /// a `FILE*` (buffered, written in large blocks). No temporary strings are
+    /// created per node. Object pointers can not be serialized and lead to a
+    /// `std::runtime_error`; non-finite doubles are written as `null`.
+    ///
+    /// As a `value_handler` the writer also accepts a stream of events, so
+    /// documents can be written without building a `value` first.
+    struct MIRROR_API json_writer : value_handler {
+        /// Appends to `out`; the string is grown geometrically and trimmed to
+        /// the written size on `flush()` and on destruction.
+        explicit json_writer(std::string& out);
+
+        /// Writes to `file` using an internal buffer of `buffer_size` bytes.
+        explicit json_writer(FILE* file, size_t buffer_size = 64 * 1024);
+
+        ~json_writer();
+
+        void write(value const& v);
+        void flush();
+
+        void null()                         override;
+        void boolean(bool v)                override;
+        void int64(int64_t v)               override;
+        void float64(double v)              override;
+        void string(string_ref s)           override;
+        void begin_array(size_t size_hint)  override;
+        void end_array()                    override;
+        void begin_dict(size_t size_hint)   override;
+        void key(string_ref k)              override;
+        void end_dict()                     override;
+
+    private:
+        json_writer(json_writer const&) = delete;
+        json_writer& operator=(json_writer const&) = delete;
+
+        inline void ensure(size_t n) { if(static_cast<size_t>(m_end - m_cur) < n) { make_room(n); } }
+        inline void put(char c) { ensure(1); *m_cur++ = c; }
+        void put(char const* s, size_t n);
+        void make_room(size_t n);
+
+        void write_int(int64_t v);
+        void write_double(double v);
+        void write_string(char const* s, size_t n);
+        void write_value(value const& v);
+        void before_value(); // writes the separator for an event
+
+
+        std::string*    m_str;      // string sink (or null)
+        FILE*           m_file;     // file sink (or null)
+        std::string     m_file_buf;
+        char*           m_begin;
+        char*           m_cur;
+        char*           m_end;
+        std::vector<bool> m_first; // per open container of the event stream: no element written yet
+    };
+
+    /// Thrown by `parse_json()`; `offset` is the byte offset of the error
+    /// in the input.
+    struct MIRROR_API json_parse_error : std::runtime_error {
+        json_parse_error(std::string const& msg, size_t off);
+
+        size_t const offset;
+    };
+
+    /// Parses a JSON document; arrays, dicts and strings are allocated from
+    /// `arena` if given. Integral numbers which fit into an `int64_t` are
+    /// stored as ints, all others as doubles; for duplicate keys the last one
+    /// wins. Throws a `json_parse_error` for invalid input.
+    MIRROR_API value parse_json(char const* data, size_t size, value_arena* arena = nullptr);
+    MIRROR_API value parse_json(std::string const& text, value_arena* arena = nullptr);
+
+    /// Parses a JSON document emitting its events to `handler`; the events
+    /// before an error have already been sent when a `json_parse_error` gets
+    /// thrown. Sizes passed to `begin_array()`/`begin_dict()` are
+    /// `value_handler::unknown_size`.
+    MIRROR_API void parse_json(char const* data, size_t size, value_handler& handler);
+    MIRROR_API void parse_json(std::string const& text, value_handler& handler);
+
+    MIRROR_API std::string to_json(value const& v);
+    MIRROR_API void        to_json(value const& v, std::string& out); ///< appends to `out`
+    MIRROR_API void        to_json(value const& v, FILE* file);
+
+} // namespace mirror
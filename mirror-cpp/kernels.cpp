@@ -0,0 +1,662 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define MIRROR_CPP_KERNELS_X86
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#       define MIRROR_CPP_TARGET_AVX2
+#   else // defined(_MSC_VER)
+#       define MIRROR_CPP_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif // defined(_MSC_VER)
+#endif // defined(__x86_64__) || defined(_M_X64)
+
+using mirror::kernels::compare_op;
+
+namespace {
+
+    struct kernel_table {
+        double  (*sum_f64)(double const* p, size_t n);
+        int64_t (*sum_i64)(int64_t const* p, size_t n);
+        void    (*min_max_f64)(double const* p, size_t n, double& min, double& max);
+        void    (*min_max_i64)(int64_t const* p, size_t n, int64_t& min, int64_t& max);
+        size_t  (*count_f64)(double const* p, size_t n, compare_op op, double rhs);
+        size_t  (*count_i64)(int64_t const* p, size_t n, compare_op op, int64_t rhs);
+        void    (*scale_offset_f64)(double* p, size_t n, double scale, double offset);
+    };
+
+    template<compare_op OP, typename T>
+    inline bool compare(T a, T b) {
+        switch(OP) {
+            case compare_op::lt: return (a <  b);
+            case compare_op::le: return (a <= b);
+            case compare_op::gt: return (a >  b);
+            case compare_op::ge: return (a >= b);
+            case compare_op::eq: return (a == b);
+            case compare_op::ne: return (a != b);
+        }
+        return false;
+    }
+
+    // dispatches a runtime compare_op to a kernel template instantiated per operation
+    template<template<compare_op> class KERNEL, typename T>
+    inline size_t dispatch_count(T const* p, size_t n, compare_op op, T rhs) {
+        switch(op) {
+            case compare_op::lt: return KERNEL<compare_op::lt>::run(p, n, rhs);
+            case compare_op::le: return KERNEL<compare_op::le>::run(p, n, rhs);
+            case compare_op::gt: return KERNEL<compare_op::gt>::run(p, n, rhs);
+            case compare_op::ge: return KERNEL<compare_op::ge>::run(p, n, rhs);
+            case compare_op::eq: return KERNEL<compare_op::eq>::run(p, n, rhs);
+            case compare_op::ne: return KERNEL<compare_op::ne>::run(p, n, rhs);
+        }
+        return 0;
+    }
+
+    //
+    // scalar kernels (also used for the tails of the vectorized kernels)
+    //
+
+    template<typename T>
+    inline T scalar_sum(T const* p, size_t n) {
+        auto s = T(0);
+        for(size_t i = 0; i < n; ++i) { s += p[i]; }
+        return s;
+    }
+
+    inline int64_t scalar_sum_i64(int64_t const* p, size_t n) {
+        // sum up as unsigned to get defined wrap around behavior
+        auto s = uint64_t(0);
+        for(size_t i = 0; i < n; ++i) { s += static_cast<uint64_t>(p[i]); }
+        return static_cast<int64_t>(s);
+    }
+
+    template<typename T>
+    inline void scalar_min_max(T const* p, size_t n, T& min, T& max) {
+        for(size_t i = 0; i < n; ++i) {
+            if(p[i] < min) { min = p[i]; }
+            if(p[i] > max) { max = p[i]; }
+        }
+    }
+
+    template<compare_op OP>
+    struct scalar_count {
+        template<typename T>
+        static inline size_t run(T const* p, size_t n, T rhs) {
+            size_t c = 0;
+            for(size_t i = 0; i < n; ++i) { c += (compare<OP>(p[i], rhs) ? 1 : 0); }
+            return c;
+        }
+    };
+
+    inline void scalar_scale_offset(double* p, size_t n, double scale, double offset) {
+        for(size_t i = 0; i < n; ++i) { p[i] = p[i] * scale + offset; }
+    }
+
+    double  scalar_sum_f64_k(double const* p, size_t n)    { return scalar_sum(p, n); }
+    void    scalar_min_max_f64_k(double const* p, size_t n, double& min, double& max)       { scalar_min_max(p, n, min, max); }
+    void    scalar_min_max_i64_k(int64_t const* p, size_t n, int64_t& min, int64_t& max)   { scalar_min_max(p, n, min, max); }
+    size_t  scalar_count_f64_k(double const* p, size_t n, compare_op op, double rhs)       { return dispatch_count<scalar_count>(p, n, op, rhs); }
+    size_t  scalar_count_i64_k(int64_t const* p, size_t n, compare_op op, int64_t rhs)     { return dispatch_count<scalar_count>(p, n, op, rhs); }
+
+    const kernel_table scalar_table = {
+        scalar_sum_f64_k,
+        scalar_sum_i64,
+        scalar_min_max_f64_k,
+        scalar_min_max_i64_k,
+        scalar_count_f64_k,
+        scalar_count_i64_k,
+        scalar_scale_offset
+    };
+
+#if defined(MIRROR_CPP_KERNELS_X86)
+
+    //
+    // SSE2 kernels (part of the x86-64 baseline); SSE2 has no 64 bit
+    // integer compares, so the int64 min/max and count kernels are scalar
+    //
+
+    double sse2_sum_f64(double const* p, size_t n) {
+        auto a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4) {
+            a0 = _mm_add_pd(a0, _mm_loadu_pd(p + i));
+            a1 = _mm_add_pd(a1, _mm_loadu_pd(p + i + 2));
+        }
+        double tmp[2];
+        _mm_storeu_pd(tmp, _mm_add_pd(a0, a1));
+        return (tmp[0] + tmp[1] + scalar_sum(p + i, n - i));
+    }
+
+    int64_t sse2_sum_i64(int64_t const* p, size_t n) {
+        auto a0 = _mm_setzero_si128(), a1 = _mm_setzero_si128();
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4) {
+            a0 = _mm_add_epi64(a0, _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i)));
+            a1 = _mm_add_epi64(a1, _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i + 2)));
+        }
+        int64_t tmp[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), _mm_add_epi64(a0, a1));
+        return static_cast<int64_t>(static_cast<uint64_t>(tmp[0]) + static_cast<uint64_t>(tmp[1]) + static_cast<uint64_t>(scalar_sum_i64(p + i, n - i)));
+    }
+
+    void sse2_min_max_f64(double const* p, size_t n, double& min, double& max) {
+        auto mn = _mm_set1_pd(min), mx = _mm_set1_pd(max);
+        size_t i = 0;
+        for(; i + 2 <= n; i += 2) {
+            auto v = _mm_loadu_pd(p + i);
+            mn = _mm_min_pd(mn, v);
+            mx = _mm_max_pd(mx, v);
+        }
+        double tmn[2], tmx[2];
+        _mm_storeu_pd(tmn, mn);
+        _mm_storeu_pd(tmx, mx);
+        min = std::min(tmn[0], tmn[1]);
+        max = std::max(tmx[0], tmx[1]);
+        scalar_min_max(p + i, n - i, min, max);
+    }
+
+    template<compare_op OP>
+    inline __m128d sse2_cmp(__m128d a, __m128d b) {
+        switch(OP) {
+            case compare_op::lt: return _mm_cmplt_pd(a, b);
+            case compare_op::le: return _mm_cmple_pd(a, b);
+            case compare_op::gt: return _mm_cmpgt_pd(a, b);
+            case compare_op::ge: return _mm_cmpge_pd(a, b);
+            case compare_op::eq: return _mm_cmpeq_pd(a, b);
+            case compare_op::ne: return _mm_cmpneq_pd(a, b);
+        }
+        return _mm_setzero_pd();
+    }
+
+    template<compare_op OP>
+    struct sse2_count {
+        static inline size_t run(double const* p, size_t n, double rhs) {
+            // matching lanes are all ones (-1), so subtracting the masks counts them
+            auto r = _mm_set1_pd(rhs);
+            auto c = _mm_setzero_si128();
+            size_t i = 0;
+            for(; i + 2 <= n; i += 2) {
+                c = _mm_sub_epi64(c, _mm_castpd_si128(sse2_cmp<OP>(_mm_loadu_pd(p + i), r)));
+            }
+            int64_t tmp[2];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), c);
+            return static_cast<size_t>(tmp[0] + tmp[1]) + scalar_count<OP>::run(p + i, n - i, rhs);
+        }
+    };
+
+    size_t sse2_count_f64(double const* p, size_t n, compare_op op, double rhs) { return dispatch_count<sse2_count>(p, n, op, rhs); }
+
+    void sse2_scale_offset(double* p, size_t n, double scale, double offset) {
+        auto s = _mm_set1_pd(scale), o = _mm_set1_pd(offset);
+        size_t i = 0;
+        for(; i + 2 <= n; i += 2) {
+            _mm_storeu_pd(p + i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(p + i), s), o));
+        }
+        scalar_scale_offset(p + i, n - i, scale, offset);
+    }
+
+    const kernel_table sse2_table = {
+        sse2_sum_f64,
+        sse2_sum_i64,
+        sse2_min_max_f64,
+        scalar_min_max_i64_k,
+        sse2_count_f64,
+        scalar_count_i64_k,
+        sse2_scale_offset
+    };
+
+    //
+    // AVX2 kernels; compiled for AVX2 only and selected at runtime
+    //
+
+    MIRROR_CPP_TARGET_AVX2 double avx2_sum_f64(double const* p, size_t n) {
+        auto a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+        size_t i = 0;
+        for(; i + 8 <= n; i += 8) {
+            a0 = _mm256_add_pd(a0, _mm256_loadu_pd(p + i));
+            a1 = _mm256_add_pd(a1, _mm256_loadu_pd(p + i + 4));
+        }
+        double tmp[4];
+        _mm256_storeu_pd(tmp, _mm256_add_pd(a0, a1));
+        return ((tmp[0] + tmp[1]) + (tmp[2] + tmp[3]) + scalar_sum(p + i, n - i));
+    }
+
+    MIRROR_CPP_TARGET_AVX2 int64_t avx2_sum_i64(int64_t const* p, size_t n) {
+        auto a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+        size_t i = 0;
+        for(; i + 8 <= n; i += 8) {
+            a0 = _mm256_add_epi64(a0, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i)));
+            a1 = _mm256_add_epi64(a1, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i + 4)));
+        }
+        int64_t tmp[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tmp), _mm256_add_epi64(a0, a1));
+        auto s = uint64_t(0);
+        for(auto t : tmp) { s += static_cast<uint64_t>(t); }
+        return static_cast<int64_t>(s + static_cast<uint64_t>(scalar_sum_i64(p + i, n - i)));
+    }
+
+    MIRROR_CPP_TARGET_AVX2 void avx2_min_max_f64(double const* p, size_t n, double& min, double& max) {
+        auto mn = _mm256_set1_pd(min), mx = _mm256_set1_pd(max);
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4) {
+            auto v = _mm256_loadu_pd(p + i);
+            mn = _mm256_min_pd(mn, v);
+            mx = _mm256_max_pd(mx, v);
+        }
+        double tmn[4], tmx[4];
+        _mm256_storeu_pd(tmn, mn);
+        _mm256_storeu_pd(tmx, mx);
+        for(int k = 0; k < 4; ++k) {
+            min = std::min(min, tmn[k]);
+            max = std::max(max, tmx[k]);
+        }
+        scalar_min_max(p + i, n - i, min, max);
+    }
+
+    MIRROR_CPP_TARGET_AVX2 void avx2_min_max_i64(int64_t const* p, size_t n, int64_t& min, int64_t& max) {
+        auto mn = _mm256_set1_epi64x(min), mx = _mm256_set1_epi64x(max);
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4) {
+            auto v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i));
+            mn = _mm256_blendv_epi8(mn, v, _mm256_cmpgt_epi64(mn, v));
+            mx = _mm256_blendv_epi8(mx, v, _mm256_cmpgt_epi64(v, mx));
+        }
+        int64_t tmn[4], tmx[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tmn), mn);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tmx), mx);
+        for(int k = 0; k < 4; ++k) {
+            min = std::min(min, tmn[k]);
+            max = std::max(max, tmx[k]);
+        }
+        scalar_min_max(p + i, n - i, min, max);
+    }
+
+    template<compare_op OP>
+    MIRROR_CPP_TARGET_AVX2 inline __m256d avx2_cmp(__m256d a, __m256d b) {
+        switch(OP) {
+            case compare_op::lt: return _mm256_cmp_pd(a, b, _CMP_LT_OQ);
+            case compare_op::le: return _mm256_cmp_pd(a, b, _CMP_LE_OQ);
+            case compare_op::gt: return _mm256_cmp_pd(a, b, _CMP_GT_OQ);
+            case compare_op::ge: return _mm256_cmp_pd(a, b, _CMP_GE_OQ);
+            case compare_op::eq: return _mm256_cmp_pd(a, b, _CMP_EQ_OQ);
+            case compare_op::ne: return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ);
+        }
+        return _mm256_setzero_pd();
+    }
+
+    template<compare_op OP>
+    MIRROR_CPP_TARGET_AVX2 inline __m256i avx2_cmp(__m256i a, __m256i b) {
+        switch(OP) {
+            case compare_op::lt: return _mm256_cmpgt_epi64(b, a);
+            case compare_op::le: return _mm256_xor_si256(_mm256_cmpgt_epi64(a, b), _mm256_set1_epi64x(-1));
+            case compare_op::gt: return _mm256_cmpgt_epi64(a, b);
+            case compare_op::ge: return _mm256_xor_si256(_mm256_cmpgt_epi64(b, a), _mm256_set1_epi64x(-1));
+            case compare_op::eq: return _mm256_cmpeq_epi64(a, b);
+            case compare_op::ne: return _mm256_xor_si256(_mm256_cmpeq_epi64(a, b), _mm256_set1_epi64x(-1));
+        }
+        return _mm256_setzero_si256();
+    }
+
+    template<compare_op OP>
+    struct avx2_count {
+        MIRROR_CPP_TARGET_AVX2 static size_t run(double const* p, size_t n, double rhs) {
+            auto r = _mm256_set1_pd(rhs);
+            auto c = _mm256_setzero_si256();
+            size_t i = 0;
+            for(; i + 4 <= n; i += 4) {
+                c = _mm256_sub_epi64(c, _mm256_castpd_si256(avx2_cmp<OP>(_mm256_loadu_pd(p + i), r)));
+            }
+            int64_t tmp[4];
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(tmp), c);
+            return static_cast<size_t>(tmp[0] + tmp[1] + tmp[2] + tmp[3]) + scalar_count<OP>::run(p + i, n - i, rhs);
+        }
+
+        MIRROR_CPP_TARGET_AVX2 static size_t run(int64_t const* p, size_t n, int64_t rhs) {
+            auto r = _mm256_set1_epi64x(rhs);
+            auto c = _mm256_setzero_si256();
+            size_t i = 0;
+            for(; i + 4 <= n; i += 4) {
+                c = _mm256_sub_epi64(c, avx2_cmp<OP>(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i)), r));
+            }
+            int64_t tmp[4];
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(tmp), c);
+            return static_cast<size_t>(tmp[0] + tmp[1] + tmp[2] + tmp[3]) + scalar_count<OP>::run(p + i, n - i, rhs);
+        }
+    };
+
+    size_t avx2_count_f64(double const* p, size_t n, compare_op op, double rhs)     { return dispatch_count<avx2_count>(p, n, op, rhs); }
+    size_t avx2_count_i64(int64_t const* p, size_t n, compare_op op, int64_t rhs)   { return dispatch_count<avx2_count>(p, n, op, rhs); }
+
+    MIRROR_CPP_TARGET_AVX2 void avx2_scale_offset(double* p, size_t n, double scale, double offset) {
+        // no FMA here to get the same rounding as the scalar kernel
+        auto s = _mm256_set1_pd(scale), o = _mm256_set1_pd(offset);
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(p + i, _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(p + i), s), o));
+        }
+        scalar_scale_offset(p + i, n - i, scale, offset);
+    }
+
+    const kernel_table avx2_table = {
+        avx2_sum_f64,
+        avx2_sum_i64,
+        avx2_min_max_f64,
+        avx2_min_max_i64,
+        avx2_count_f64,
+        avx2_count_i64,
+        avx2_scale_offset
+    };
+
+    bool cpu_has_avx2() {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if(info[0] < 7) { return false; }
+        __cpuid(info, 1);
+        auto os_avx = ((info[2] & (1 << 27)) != 0) && ((info[2] & (1 << 28)) != 0) && ((_xgetbv(0) & 0x6) == 0x6);
+        __cpuidex(info, 7, 0);
+        return (os_avx && ((info[1] & (1 << 5)) != 0));
+#else // defined(_MSC_VER)
+        __builtin_cpu_init();
+        return (__builtin_cpu_supports("avx2") != 0);
+#endif // defined(_MSC_VER)
+    }
+
+#endif // defined(MIRROR_CPP_KERNELS_X86)
+
+    mirror::kernels::isa detect_isa() {
+#if defined(MIRROR_CPP_KERNELS_X86)
+        return (cpu_has_avx2() ? mirror::kernels::isa::avx2 : mirror::kernels::isa::sse2);
+#else // defined(MIRROR_CPP_KERNELS_X86)
+        return mirror::kernels::isa::scalar;
+#endif // defined(MIRROR_CPP_KERNELS_X86)
+    }
+
+    kernel_table const* table_for(mirror::kernels::isa i) {
+        switch(i) {
+#if defined(MIRROR_CPP_KERNELS_X86)
+            case mirror::kernels::isa::avx2:    return &avx2_table;
+            case mirror::kernels::isa::sse2:    return &sse2_table;
+#endif // defined(MIRROR_CPP_KERNELS_X86)
+            default:                            return &scalar_table;
+        }
+    }
+
+    struct active_state {
+        std::atomic<mirror::kernels::isa>   isa;
+        std::atomic<kernel_table const*>    table;
+
+        active_state() : isa(detect_isa()), table(table_for(isa.load())) { }
+    };
+
+    active_state& active() {
+        static active_state s;
+        return s;
+    }
+
+    inline kernel_table const& kt() { return *active().table.load(std::memory_order_relaxed); }
+
+} // namespace
+
+mirror::kernels::isa mirror::kernels::best_isa() {
+    static const auto best = detect_isa();
+    return best;
+}
+
+mirror::kernels::isa mirror::kernels::active_isa() {
+    return active().isa.load();
+}
+
+void mirror::kernels::set_isa(
+    isa i
+) {
+    i = static_cast<isa>(std::min(static_cast<int>(i), static_cast<int>(best_isa())));
+    active().isa.store(i);
+    active().table.store(table_for(i));
+}
+
+char const* mirror::kernels::isa_name(
+    isa i
+) {
+    switch(i) {
+        case isa::scalar:   return "scalar";
+        case isa::sse2:     return "sse2";
+        case isa::avx2:     return "avx2";
+    }
+    return "unknown";
+}
+
+double mirror::kernels::sum(double const* p, size_t n)     { return kt().sum_f64(p, n); }
+int64_t mirror::kernels::sum(int64_t const* p, size_t n)   { return kt().sum_i64(p, n); }
+
+bool mirror::kernels::min_max(
+    double const* p, size_t n,
+    double& min, double& max
+) {
+    if(n == 0) { return false; }
+    min = max = p[0];
+    kt().min_max_f64(p, n, min, max);
+    return true;
+}
+
+bool mirror::kernels::min_max(
+    int64_t const* p, size_t n,
+    int64_t& min, int64_t& max
+) {
+    if(n == 0) { return false; }
+    min = max = p[0];
+    kt().min_max_i64(p, n, min, max);
+    return true;
+}
+
+size_t mirror::kernels::count_if(double const* p, size_t n, compare_op op, double rhs)     { return kt().count_f64(p, n, op, rhs); }
+size_t mirror::kernels::count_if(int64_t const* p, size_t n, compare_op op, int64_t rhs)   { return kt().count_i64(p, n, op, rhs); }
+
+void mirror::kernels::scale_offset(double* p, size_t n, double scale, double offset) { kt().scale_offset_f64(p, n, scale, offset); }
+
+// truncates towards zero, saturating at the int64 limits; NaN becomes 0
+// (a plain cast of those is undefined behavior)
+static inline int64_t saturate_to_int64(
+    double d
+) {
+    if(d != d)                          { return 0; }
+    if(d >= 9223372036854775808.0)      { return std::numeric_limits<int64_t>::max(); } // 2^63
+    if(d <  -9223372036854775808.0)     { return std::numeric_limits<int64_t>::min(); }
+    return static_cast<int64_t>(d);
+}
+
+// there are no packed int64 <-> double conversions below AVX-512, so
+// these are plain (compiler unrolled) loops for all instruction sets
+void mirror::kernels::convert(int64_t const* src, size_t n, double* dst) {
+    for(size_t i = 0; i < n; ++i) { dst[i] = static_cast<double>(src[i]); }
+}
+
+void mirror::kernels::convert(double const* src, size_t n, int64_t* dst) {
+    for(size_t i = 0; i < n; ++i) { dst[i] = saturate_to_int64(src[i]); }
+}
+
+//
+// value based kernels
+//
+
+static double element_as_double(
+    mirror::value const& e
+) {
+    if(e.is_double()) { return e.as_double(); }
+    if(e.is_int())    { return static_cast<double>(e.as_int()); }
+    throw std::runtime_error("kernels: non-numeric array element");
+}
+
+static void check_array(
+    mirror::value const& v
+) {
+    if(!v.is_array() && !v.is_int_array() && !v.is_double_array()) {
+        throw std::runtime_error("kernels: value is not a numeric array");
+    }
+}
+
+mirror::value mirror::kernels::sum(
+    value const& v
+) {
+    check_array(v);
+    if(v.is_int_array()) {
+        auto&& a = v.as_int_array();
+        return value(sum(a.data(), a.size()));
+    }
+    if(v.is_double_array()) {
+        auto&& a = v.as_double_array();
+        return value(sum(a.data(), a.size()));
+    }
+
+    auto s = 0.0;
+    for(auto&& e : v.as_array()) { s += element_as_double(e); }
+    return value(s);
+}
+
+bool mirror::kernels::min_max(
+    value const& v,
+    value& min, value& max
+) {
+    check_array(v);
+    if(v.is_int_array()) {
+        auto&& a = v.as_int_array();
+        int64_t mn, mx;
+        if(!min_max(a.data(), a.size(), mn, mx)) { return false; }
+        min = value(mn); max = value(mx);
+        return true;
+    }
+    if(v.is_double_array()) {
+        auto&& a = v.as_double_array();
+        double mn, mx;
+        if(!min_max(a.data(), a.size(), mn, mx)) { return false; }
+        min = value(mn); max = value(mx);
+        return true;
+    }
+
+    auto&& a = v.as_array();
+    if(a.empty()) { return false; }
+    auto mn = element_as_double(a[0]), mx = mn;
+    for(auto&& e : a) {
+        auto d = element_as_double(e);
+        mn = std::min(mn, d);
+        mx = std::max(mx, d);
+    }
+    min = value(mn); max = value(mx);
+    return true;
+}
+
+double mirror::kernels::mean(
+    value const& v
+) {
+    auto n = v.size();
+    auto s = sum(v);
+    if(n == 0) { return std::numeric_limits<double>::quiet_NaN(); }
+    return ((s.is_int() ? static_cast<double>(s.as_int()) : s.as_double()) / static_cast<double>(n));
+}
+
+size_t mirror::kernels::count_if(
+    value const& v,
+    compare_op op,
+    value const& rhs
+) {
+    check_array(v);
+    if(v.is_int_array() && rhs.is_int()) {
+        auto&& a = v.as_int_array();
+        return count_if(a.data(), a.size(), op, rhs.as_int());
+    }
+    if(v.is_double_array()) {
+        auto&& a = v.as_double_array();
+        return count_if(a.data(), a.size(), op, element_as_double(rhs));
+    }
+
+    auto r = element_as_double(rhs);
+    auto n = v.size();
+    size_t c = 0;
+    for(size_t i = 0; i < n; ++i) {
+        auto d = element_as_double(v.at(i));
+        switch(op) {
+            case compare_op::lt: c += (d <  r) ? 1 : 0; break;
+            case compare_op::le: c += (d <= r) ? 1 : 0; break;
+            case compare_op::gt: c += (d >  r) ? 1 : 0; break;
+            case compare_op::ge: c += (d >= r) ? 1 : 0; break;
+            case compare_op::eq: c += (d == r) ? 1 : 0; break;
+            case compare_op::ne: c += (d != r) ? 1 : 0; break;
+        }
+    }
+    return c;
+}
+
+void mirror::kernels::scale_offset(
+    value& v,
+    double scale, double offset
+) {
+    if(!v.is_double_array()) { v = to_double_array(v); }
+    auto&& a = v.as_double_array();
+    scale_offset(a.data(), a.size(), scale, offset);
+}
+
+mirror::value mirror::kernels::to_double_array(
+    value const& v
+) {
+    check_array(v);
+    if(v.is_double_array()) { return v; }
+
+    auto res = value::double_array();
+    auto&& dst = res.as_double_array();
+    if(v.is_int_array()) {
+        auto&& src = v.as_int_array();
+        dst.resize(src.size());
+        convert(src.data(), src.size(), dst.data());
+    } else {
+        dst.reserve(v.size());
+        for(auto&& e : v.as_array()) { dst.push_back(element_as_double(e)); }
+    }
+    return res;
+}
+
+mirror::value mirror::kernels::to_int_array(
+    value const& v
+) {
+    check_array(v);
+    if(v.is_int_array()) { return v; }
+
+    auto res = value::int_array();
+    auto&& dst = res.as_int_array();
+    if(v.is_double_array()) {
+        auto&& src = v.as_double_array();
+        dst.resize(src.size());
+        convert(src.data(), src.size(), dst.data());
+    } else {
+        dst.reserve(v.size());
+        for(auto&& e : v.as_array()) { dst.push_back(e.is_int() ? e.as_int() : saturate_to_int64(element_as_double(e))); }
+    }
+    return res;
+}
@@ -0,0 +1,71 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include "mirror-cpp.hpp"
+#include "value.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mirror {
+namespace kernels {
+
+    /// The instruction set used by the kernels; the best one supported by
+    /// the CPU gets selected at runtime.
+    enum class isa { scalar, sse2, avx2 };
+
+    MIRROR_API isa          best_isa();     ///< best instruction set supported by this CPU (and build)
+    MIRROR_API isa          active_isa();   ///< instruction set currently used by the kernels
+    MIRROR_API void         set_isa(isa i); ///< restricts the kernels to `i` (clamped to `best_isa()`)
+    MIRROR_API char const*  isa_name(isa i);
+
+    enum class compare_op { lt, le, gt, ge, eq, ne };
+
+    // kernels over contiguous spans; min_max() returns `false` for empty
+    // spans, integer sums wrap around, and NaNs lead to unspecified results
+    // of min_max()
+    MIRROR_API double   sum(double const* p, size_t n);
+    MIRROR_API int64_t  sum(int64_t const* p, size_t n);
+    MIRROR_API bool     min_max(double const* p, size_t n, double& min, double& max);
+    MIRROR_API bool     min_max(int64_t const* p, size_t n, int64_t& min, int64_t& max);
+    MIRROR_API size_t   count_if(double const* p, size_t n, compare_op op, double rhs);
+    MIRROR_API size_t   count_if(int64_t const* p, size_t n, compare_op op, int64_t rhs);
+    MIRROR_API void     scale_offset(double* p, size_t n, double scale, double offset); ///< p[i] = p[i] * scale + offset
+    MIRROR_API void     convert(int64_t const* src, size_t n, double* dst);
+    MIRROR_API void     convert(double const* src, size_t n, int64_t* dst); ///< truncates towards zero, saturates out of range values (and infinities) at the int64 limits, NaN becomes 0
+
+    // kernels over array values: typed int/double arrays are processed
+    // in place, generic arrays element by element; a `std::runtime_error`
+    // is thrown for non-numeric elements or values which are no arrays
+    MIRROR_API value    sum(value const& v);  ///< int value for int arrays, double value otherwise
+    MIRROR_API bool     min_max(value const& v, value& min, value& max);
+    MIRROR_API double   mean(value const& v); ///< NaN for empty arrays
+    MIRROR_API size_t   count_if(value const& v, compare_op op, value const& rhs);
+    MIRROR_API void     scale_offset(value& v, double scale, double offset); ///< converts `v` into a double array
+    MIRROR_API value    to_double_array(value const& v);
+    MIRROR_API value    to_int_array(value const& v);   ///< converts doubles like `convert()`
+
+} // namespace kernels
+} // namespace mirror
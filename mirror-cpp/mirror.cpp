@@ -25,15 +25,16 @@
 
 #include <algorithm>
 #include <cassert>
+#include <stdexcept>
 
 template<typename CONT>
 static inline auto find_by_name(
     CONT&& cont,
-    std::string const& name
+    mirror::atom const& name
 ) -> decltype(cont.begin()) {
     assert(!name.empty());
 
-    // use linear search based on the type
+    // use linear search based on the name atom
     typedef decltype(*cont.begin()) T;
     return std::find_if(
         cont.begin(), cont.end(),
@@ -41,27 +42,13 @@ static inline auto find_by_name(
     );
 }
 
-template<typename CONT>
-static inline auto find_by_type(
-    CONT&& cont,
-    std::type_info const& type
-) -> decltype(cont.begin()) {
-
-    // use linear search based on the type
-    typedef decltype(*cont.begin()) T;
-    return std::find_if(
-        cont.begin(), cont.end(),
-        [&](T const& c) { return (c->type == type); }
-    );
-}
-
 std::string mirror::name_type_info::to_string(
     int indent
 ) const {
     assert(indent >= 0);
 
     std::string result;
-    result += std::string(indent,   ' ') + "name: " + name + "\n";
+    result += std::string(indent,   ' ') + "name: " + name.str() + "\n";
     result += std::string(indent+1, ' ') + "type: " + type.name() + "\n";
     return result;
 }
@@ -84,54 +71,335 @@ std::string mirror::method_info::to_string(
 
     std::string result;
     result += name_type_info::to_string(indent);
-/*
-    if(!parameters.empty()) {
+    result += std::string(indent+1, ' ') + "result: " + result_type.name() + "\n";
+    if(num_args > 0) {
         result += std::string(indent+1, ' ') + "parameters:\n";
-        for(auto&& i : parameters) { result += i->to_string(indent+2); }
+        for(size_t i = 0; i < num_args; ++i) { result += std::string(indent+2, ' ') + arg_types[i]->name() + "\n"; }
     }
-*/
     return result;
 }
 
+// bumped on every modification of a class whose member table has been
+// built, i.e. which might be cached somewhere; a member table is known to be
+// up to date as long as the epoch has not changed since it has been checked
+// last. Classes are usually only modified during startup or, for lazily
+// registered ones, while being built before anybody has looked at them.
+static std::atomic<uint64_t> g_members_epoch(1);
+
+// the source of `member_table::serial`
+static std::atomic<uint64_t> g_member_serial(0);
+
+void mirror::class_info_base::members_changed(
+) {
+    m_version.fetch_add(1, std::memory_order_acq_rel);
+    if(m_members.load(std::memory_order_acquire)) { g_members_epoch.fetch_add(1, std::memory_order_acq_rel); }
+}
+
+uint64_t mirror::class_info_base::members_epoch(
+) {
+    return g_members_epoch.load(std::memory_order_acquire);
+}
+
+void mirror::class_info_base::set_base_class(
+    std::shared_ptr<class_info_base> base,
+    upcast_type to_base
+) {
+    base_class = std::move(base);
+    upcast = to_base;
+    members_changed();
+}
+
+// walks the class hierarchy without building the member tables
+static inline bool has_property(
+    mirror::class_info_base const* c,
+    mirror::atom const& name
+) {
+    for(; c; c = c->base_class.get()) {
+        if(c->find_property_by_name(name)) { return true; }
+    }
+    return false;
+}
+
+mirror::value mirror::method_info::invoke(
+    context&,
+    value const& obj,
+    values const& args
+) const {
+    if(!obj.is_ptr() || (*obj.m_type != owner)) {
+        throw std::invalid_argument("cannot invoke '" + name.str() + "' on object of type '" + obj.m_type->name() + "'");
+    }
+    return call(obj.m_obj.get(), args);
+}
+
+size_t mirror::method_info::rank(
+    value_span args
+) const {
+    if(args.size != num_args) { return no_match; }
+
+    size_t res = 0;
+    for(size_t i = 0; i < args.size; ++i) {
+        auto r = arg_ranks[i](args[i].kind());
+        if(r == conversion_rank::none) { return no_match; }
+        res += static_cast<size_t>(r);
+    }
+    return res;
+}
+
+mirror::member_table::method_entry const* mirror::member_table::resolve(
+    uint64_t key,
+    value_span args
+) const {
+    auto it = overloads.find(key);
+    if(it == overloads.end()) {
+        // not overloaded; mismatching arguments are reported by the call
+        auto m = methods.find(key);
+        return ((m != methods.end()) ? &m->second : nullptr);
+    }
+
+    auto const& set = it->second;
+    auto sig = kind_signature(args);
+    auto cacheable = (sig != ~uint64_t(0));
+    if(cacheable) {
+        auto resolved = set.resolved.load(std::memory_order_acquire);
+        if(resolved) {
+            auto r = resolved->find(sig);
+            if(r != resolved->end()) { return &set.candidates[r->second]; }
+        }
+    }
+
+    auto best = set.candidates.size();
+    auto best_rank = method_info::no_match;
+    for(size_t i = 0; i < set.candidates.size(); ++i) {
+        auto r = set.candidates[i].method->rank(args);
+        if(r < best_rank) { best = i; best_rank = r; }
+    }
+    if(best == set.candidates.size()) {
+        throw std::invalid_argument("no overload of '" + set.candidates.front().method->name.str() + "' matches the arguments");
+    }
+
+    if(cacheable) {
+        // copy on write: readers keep probing the previous map meanwhile
+        std::lock_guard<std::mutex> lock(m_resolve_mutex);
+        auto prev = set.resolved.load(std::memory_order_relaxed);
+        if(!prev || !prev->count(sig)) { // unless resolved by another thread in the meantime
+            std::unique_ptr<resolved_map> next(prev ? new resolved_map(*prev) : new resolved_map());
+            next->emplace(sig, best);
+            set.resolved.store(next.get(), std::memory_order_release);
+            m_resolved_maps.emplace_back(std::move(next));
+        }
+    }
+    return &set.candidates[best];
+}
+
+void mirror::detail::throw_arg_count_mismatch(
+    method_info const& m,
+    size_t num_args
+) {
+    throw std::invalid_argument("method '" + m.name.str() + "' expects " + std::to_string(m.num_args) + " arguments, got " + std::to_string(num_args));
+}
+
+void mirror::detail::throw_unsupported_signature(
+    method_info const& m
+) {
+    throw std::invalid_argument("method '" + m.name.str() + "' has a result or argument type not supported by mirror::convert");
+}
+
 void mirror::class_info_base::add_property_impl(
     property_ptr p
 ) {
     assert(p);
-    assert(!find_property_by_name(p->name, true));
+    assert(!has_property(this, p->name));
 
     auto it = find_by_name(properties, name);
     properties.emplace(it, std::move(p));
+    members_changed();
 }
 
 mirror::property_ptr mirror::class_info_base::find_property_by_name(
-    std::string const& name,
+    atom const& name,
     bool search_base
 ) const {
-    auto it = find_by_name(properties, name);
-    if((it != properties.end()) && ((*it)->name == name)) { return *it; }
-
-    if(search_base && base_class) {
-        return base_class->find_property_by_name(name, search_base);
+    if(search_base) {
+        auto const& props = members().properties;
+        auto it = props.find(name);
+        return ((it != props.end()) ? it->second.property : nullptr);
     }
 
+    auto it = find_by_name(properties, name);
+    if((it != properties.end()) && ((*it)->name == name)) { return *it; }
     return nullptr;
 }
 
 mirror::value mirror::class_info_base::invoke(
-    context& ctx,
+    context&,
     value const& obj,
-    std::string const& method,
+    atom const& method,
     values const& args
 ) const {
-    for(auto&& m : methods) {
-        if((m->name == method) && (m->num_args == args.size())) {
-            return m->invoke(ctx, obj, args);
-        }
+    auto e = members().resolve(member_table::method_key(method, args.size()), args);
+    if(!e) { throw std::runtime_error("method not found: " + method.str()); }
+
+    if(!obj.is_ptr() || (*obj.m_type != type)) {
+        throw std::invalid_argument("cannot invoke '" + method.str() + "' of class '" + name.str() + "' on object of type '" + obj.m_type->name() + "'");
     }
-    if(base_class) {
-        return base_class->invoke(ctx, obj, method, args);
+
+    // adjust the object pointer to the class that registered the method
+    return e->method->call(to_base(obj.m_obj.get(), e->depth), args);
+}
+
+mirror::method_handle mirror::class_info_base::find_method(
+    atom const& method,
+    size_t num_args
+) const {
+    method_handle res;
+
+    auto const& meths = members().methods;
+    auto it = meths.find(member_table::method_key(method, num_args));
+    if(it == meths.end()) { return res; }
+
+    res.m_type = &type;
+    res.m_method = it->second.method;
+    res.m_upcasts = upcasts(it->second.depth);
+    return res;
+}
+
+mirror::method_handle mirror::class_info_base::find_method(
+    atom const& method,
+    value_span args
+) const {
+    method_handle res;
+
+    auto e = members().resolve(member_table::method_key(method, args.size), args);
+    if(!e) { return res; }
+
+    res.m_type = &type;
+    res.m_method = e->method;
+    res.m_upcasts = upcasts(e->depth);
+    return res;
+}
+
+mirror::property_handle mirror::class_info_base::find_property(
+    atom const& name
+) const {
+    property_handle res;
+
+    auto const& props = members().properties;
+    auto it = props.find(name);
+    if(it == props.end()) { return res; }
+
+    res.m_type = &type;
+    res.m_property = it->second.property;
+    res.m_upcasts = upcasts(it->second.depth);
+    return res;
+}
+
+mirror::value mirror::class_info_base::get(
+    value const& obj,
+    atom const& name
+) const {
+    auto ptr = check_object(obj, name);
+
+    auto const& props = members().properties;
+    auto it = props.find(name);
+    if(it == props.end()) { throw std::runtime_error("property not found: " + name.str()); }
+    return it->second.property->get(to_base(ptr, it->second.depth));
+}
+
+void mirror::class_info_base::set(
+    value const& obj,
+    atom const& name,
+    value const& v
+) const {
+    auto ptr = check_object(obj, name);
+
+    auto const& props = members().properties;
+    auto it = props.find(name);
+    if(it == props.end()) { throw std::runtime_error("property not found: " + name.str()); }
+    it->second.property->set(to_base(ptr, it->second.depth), v);
+}
+
+void mirror::class_info_base::get(
+    value const& obj,
+    atom const* names,
+    size_t n,
+    value* out
+) const {
+    assert(names || (n == 0));
+    assert(out || (n == 0));
+
+    auto ptr = check_object(obj, (n ? names[0] : atom()));
+
+    auto const& props = members().properties;
+    for(size_t i = 0; i < n; ++i) {
+        auto it = props.find(names[i]);
+        if(it == props.end()) { throw std::runtime_error("property not found: " + names[i].str()); }
+        out[i] = it->second.property->get(to_base(ptr, it->second.depth));
+    }
+}
+
+void* mirror::class_info_base::check_object(
+    value const& obj,
+    atom const& member
+) const {
+    if(!obj.is_ptr() || (*obj.m_type != type)) {
+        throw std::invalid_argument("cannot access '" + member.str() + "' of class '" + name.str() + "' on object of type '" + obj.m_type->name() + "'");
+    }
+    return obj.m_obj.get();
+}
+
+void* mirror::class_info_base::to_base(
+    void* obj,
+    size_t depth
+) const {
+    auto cls = this;
+    for(size_t i = 0; i < depth; ++i) {
+        if(cls->upcast) { obj = cls->upcast(obj); }
+        cls = cls->base_class.get();
+    }
+    return obj;
+}
+
+std::vector<mirror::upcast_type> mirror::class_info_base::upcasts(
+    size_t depth
+) const {
+    std::vector<upcast_type> res;
+    auto cls = this;
+    for(size_t i = 0; i < depth; ++i) {
+        if(cls->upcast) { res.push_back(cls->upcast); }
+        cls = cls->base_class.get();
+    }
+    return res;
+}
+
+void mirror::property_handle::get(
+    value_span objs,
+    value* out
+) const {
+    assert(out || (objs.size == 0));
+    for(size_t i = 0; i < objs.size; ++i) {
+        check_type(objs[i]);
+        out[i] = m_property->get(adjust(objs[i].m_obj.get()));
     }
-    throw std::runtime_error("method not found: " + method);
+}
+
+void mirror::property_handle::throw_type_mismatch(
+    value const& obj
+) const {
+    if(!m_property) { throw std::invalid_argument("accessing an empty property handle"); }
+    throw std::invalid_argument("cannot access '" + m_property->name.str() + "' on object of type '" + obj.m_type->name() + "'");
+}
+
+void mirror::property_info::throw_no_access(
+) const {
+    if(!get_thunk && !set_thunk) { throw std::logic_error("property has no accessor: " + name.str()); }
+    throw std::logic_error((get_thunk ? "property is not writable: " : "property is not readable: ") + name.str());
+}
+
+void mirror::method_handle::throw_type_mismatch(
+    value const& obj
+) const {
+    if(!m_method) { throw std::invalid_argument("invoking an empty method handle"); }
+    throw std::invalid_argument("cannot invoke '" + m_method->name.str() + "' on object of type '" + obj.m_type->name() + "'");
 }
 
 void mirror::class_info_base::add_method_impl(
@@ -139,6 +407,267 @@ void mirror::class_info_base::add_method_impl(
 ) {
     assert(m);
     methods.emplace_back(std::move(m));
+    members_changed();
+}
+
+mirror::member_table const& mirror::class_info_base::members(
+) const {
+    auto epoch = g_members_epoch.load(std::memory_order_acquire);
+    auto t = m_members.load(std::memory_order_acquire);
+    if(t && (t->checked.load(std::memory_order_relaxed) == epoch)) { return *t; }
+
+    // some class has been modified; only rebuild if it is this one or a base
+    if(t && up_to_date(*t)) {
+        t->checked.store(epoch, std::memory_order_relaxed);
+        return *t;
+    }
+    return build_members();
+}
+
+bool mirror::class_info_base::up_to_date(
+    member_table const& t
+) const {
+    if(t.version != m_version.load(std::memory_order_acquire)) { return false; }
+    return (base_class ? (base_class->members().serial == t.base_serial) : (t.base_serial == 0));
+}
+
+mirror::member_table const& mirror::class_info_base::build_members(
+) const {
+    std::lock_guard<std::mutex> lock(m_member_mutex);
+
+    auto epoch = g_members_epoch.load(std::memory_order_acquire);
+    auto t = m_members.load(std::memory_order_acquire);
+    if(t && up_to_date(*t)) { return *t; } // built by another thread in the meantime
+
+    std::unique_ptr<member_table> table(new member_table());
+    table->serial = g_member_serial.fetch_add(1, std::memory_order_relaxed) + 1;
+    table->version = m_version.load(std::memory_order_acquire);
+    table->checked.store(epoch, std::memory_order_relaxed);
+
+    // the own members go in first, so they shadow the inherited ones; the
+    // own overloads of a method shadow all inherited ones with the same
+    // number of arguments
+    for(auto&& p : properties) {
+        member_table::property_entry e = { p, 0 };
+        table->properties.emplace(p->name, std::move(e));
+    }
+    for(auto&& m : methods) {
+        member_table::method_entry e = { m, 0 };
+        auto key = member_table::method_key(m->name, m->num_args);
+        auto res = table->methods.emplace(key, e);
+        if(!res.second) {
+            auto& set = table->overloads[key];
+            if(set.candidates.empty()) { set.candidates.push_back(res.first->second); }
+            set.candidates.push_back(std::move(e));
+        }
+    }
+
+    if(base_class) {
+        auto const& base = base_class->members();
+        table->base_serial = base.serial;
+        for(auto&& i : base.properties) {
+            member_table::property_entry e = { i.second.property, i.second.depth + 1 };
+            table->properties.emplace(i.first, std::move(e));
+        }
+        for(auto&& i : base.methods) {
+            member_table::method_entry e = { i.second.method, i.second.depth + 1 };
+            table->methods.emplace(i.first, std::move(e));
+        }
+        for(auto&& i : base.overloads) {
+            if(table->methods.find(i.first)->second.depth == 0) { continue; } // shadowed
+            auto& set = table->overloads[i.first];
+            for(auto&& c : i.second.candidates) {
+                member_table::method_entry e = { c.method, c.depth + 1 };
+                set.candidates.push_back(std::move(e));
+            }
+        }
+    }
+
+    m_members.store(table.get(), std::memory_order_release);
+    m_member_tables.emplace_back(std::move(table));
+    return *m_member_tables.back();
+}
+
+void mirror::member_table::reclaim(
+) {
+    std::lock_guard<std::mutex> lock(m_resolve_mutex);
+
+    std::vector<resolved_map const*> current;
+    for(auto&& i : overloads) {
+        auto r = i.second.resolved.load(std::memory_order_relaxed);
+        if(r) { current.push_back(r); }
+    }
+    std::sort(current.begin(), current.end());
+
+    m_resolved_maps.erase(
+        std::remove_if(m_resolved_maps.begin(), m_resolved_maps.end(), [&](std::unique_ptr<resolved_map const> const& r) {
+            return !std::binary_search(current.begin(), current.end(), r.get());
+        }),
+        m_resolved_maps.end()
+    );
+}
+
+void mirror::class_info_base::reclaim(
+) {
+    {
+        std::lock_guard<std::mutex> lock(m_member_mutex);
+        auto t = m_members.load(std::memory_order_relaxed);
+        m_member_tables.erase(
+            std::remove_if(m_member_tables.begin(), m_member_tables.end(), [&](std::unique_ptr<member_table> const& i) { return (i.get() != t); }),
+            m_member_tables.end()
+        );
+        for(auto&& i : m_member_tables) { i->reclaim(); }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_codec_mutex);
+        auto c = m_codec.load(std::memory_order_relaxed);
+        m_codecs.erase(
+            std::remove_if(m_codecs.begin(), m_codecs.end(), [&](std::unique_ptr<value_codec const> const& i) { return (i.get() != c); }),
+            m_codecs.end()
+        );
+    }
+}
+
+// the object pointer for each level of the class hierarchy; uses `buf` for
+// up to 16 levels
+static void** object_levels(
+    std::vector<mirror::upcast_type> const& upcasts,
+    void* obj,
+    void* (&buf)[16],
+    std::vector<void*>& more
+) {
+    auto levels = buf;
+    if(upcasts.size() > 16) { more.resize(upcasts.size()); levels = more.data(); }
+
+    levels[0] = obj;
+    for(size_t i = 1; i < upcasts.size(); ++i) {
+        levels[i] = (upcasts[i - 1] ? upcasts[i - 1](levels[i - 1]) : levels[i - 1]);
+    }
+    return levels;
+}
+
+mirror::value_codec const& mirror::class_info_base::codec(
+    class_registry const& reg
+) const {
+    auto c = m_codec.load(std::memory_order_acquire);
+    if(c && (c->members == members().serial) && (c->registry == &reg) && (c->generation == reg.generation())) { return *c; }
+    return build_codec(reg);
+}
+
+mirror::value_codec const& mirror::class_info_base::build_codec(
+    class_registry const& reg
+) const {
+    std::lock_guard<std::mutex> lock(m_codec_mutex);
+
+    // read before resolving the nested classes: a class registered
+    // concurrently makes the next call compile the codec again
+    auto const& table = members();
+    auto generation = reg.generation();
+    auto c = m_codec.load(std::memory_order_acquire);
+    if(c && (c->members == table.serial) && (c->registry == &reg) && (c->generation == generation)) { return *c; } // built by another thread in the meantime
+
+    std::unique_ptr<value_codec> res(new value_codec());
+    res->registry = &reg;
+    res->generation = generation;
+    res->members = table.serial;
+
+    std::vector<class_info_base const*> chain;
+    for(auto cls = this; cls; cls = cls->base_class.get()) {
+        chain.push_back(cls);
+        res->upcasts.push_back(cls->upcast);
+    }
+
+    // shadowed properties are left out
+    auto const& props = table.properties;
+    for(size_t depth = chain.size(); depth-- > 0; ) {
+        for(auto&& p : chain[depth]->properties) {
+            auto it = props.find(p->name);
+            if((it == props.end()) || (it->second.property != p)) { continue; }
+
+            value_codec::step s = { p->name, p.get(), depth, nullptr };
+            if(p->address_thunk) { s.nested = reg.find_class_by_type(p->type); }
+            if(!s.nested && !p->get_thunk) { continue; } // nothing to encode
+            res->steps.push_back(s);
+        }
+    }
+
+    // in the order of the dict keys: encoding only appends to the dict and
+    // decoding walks the dict alongside the steps
+    std::sort(res->steps.begin(), res->steps.end(), [](value_codec::step const& l, value_codec::step const& r) { return (l.name < r.name); });
+
+    m_codec.store(res.get(), std::memory_order_release);
+    m_codecs.emplace_back(std::move(res));
+    return *m_codecs.back();
+}
+
+mirror::value mirror::value_codec::encode(
+    void const* obj
+) const {
+    void* buf[16];
+    std::vector<void*> more;
+    auto levels = object_levels(upcasts, const_cast<void*>(obj), buf, more);
+
+    auto res = value::dict();
+    auto& dict = res.as_dict();
+    for(auto&& s : steps) {
+        auto ptr = levels[s.depth];
+        if(s.nested) {
+            dict.emplace(s.name, s.nested->codec(*registry).encode(s.property->address(ptr)));
+        } else {
+            dict.emplace(s.name, s.property->get(ptr));
+        }
+    }
+    return res;
+}
+
+void mirror::value_codec::decode(
+    value const& v,
+    void* obj
+) const {
+    if(!v.is_dict()) { throw std::invalid_argument("cannot decode an object from a non dict value"); }
+
+    void* buf[16];
+    std::vector<void*> more;
+    auto levels = object_levels(upcasts, obj, buf, more);
+
+    // both the steps and the dict are ordered by name
+    auto const& dict = v.as_dict();
+    auto it = dict.begin();
+    for(auto&& s : steps) {
+        while((it != dict.end()) && (it->first < s.name)) { ++it; }
+        if(it == dict.end()) { break; }
+        if((it->first != s.name) || s.property->read_only) { continue; }
+
+        auto ptr = levels[s.depth];
+        if(s.nested) {
+            s.nested->codec(*registry).decode(it->second, s.property->address(ptr));
+        } else if(s.property->set_thunk) {
+            s.property->set(ptr, it->second);
+        }
+    }
+}
+
+mirror::value mirror::to_value(
+    class_registry const& reg,
+    value const& obj
+) {
+    if(!obj.is_ptr()) { throw std::invalid_argument("cannot encode a non object value"); }
+
+    auto cls = reg.find_class_by_type(*obj.m_type);
+    if(!cls) { throw std::runtime_error(std::string("class not registered: ") + obj.m_type->name()); }
+    return cls->codec(reg).encode(obj.m_obj.get());
+}
+
+void mirror::from_value(
+    class_registry const& reg,
+    value const& v,
+    value const& obj
+) {
+    if(!obj.is_ptr()) { throw std::invalid_argument("cannot decode into a non object value"); }
+
+    auto cls = reg.find_class_by_type(*obj.m_type);
+    if(!cls) { throw std::runtime_error(std::string("class not registered: ") + obj.m_type->name()); }
+    cls->codec(reg).decode(v, obj.m_obj.get());
 }
 
 std::string mirror::class_info_base::to_string(
@@ -150,7 +679,7 @@ std::string mirror::class_info_base::to_string(
     result += name_type_info::to_string(indent);
 
     if(base_class) {
-        result += std::string(indent+1, ' ') + "base: " + base_class->name + "\n";
+        result += std::string(indent+1, ' ') + "base: " + base_class->name.str() + "\n";
         result += base_class->to_string(indent+2) + "\n";
     }
 
@@ -167,38 +696,472 @@ std::string mirror::class_info_base::to_string(
     return result;
 }
 
+mirror::class_registry::class_block::class_block(
+    size_t cap
+) : capacity(cap), size(0), items(new class_slot*[cap]) {
+}
+
+mirror::class_registry::live_index::live_index(
+    size_t cap
+) : mask(cap - 1), size(0), slots(new std::atomic<frozen_entry const*>[cap]) {
+    assert((cap & (cap - 1)) == 0);
+    for(size_t i = 0; i < cap; ++i) { slots[i].store(nullptr, std::memory_order_relaxed); }
+}
+
+// the source of `class_registry::generation()`
+static std::atomic<uint64_t> g_registry_generation(0);
+
+mirror::class_registry::class_registry(
+) : m_classes(nullptr), m_by_name(nullptr), m_by_type(nullptr), m_frozen(false), m_generation(0) {
+    reset();
+}
+
+mirror::class_registry::class_registry(
+    class_registry const& other
+) : m_classes(nullptr), m_by_name(nullptr), m_by_type(nullptr), m_frozen(false), m_generation(0) {
+    *this = other;
+}
+
+mirror::class_registry& mirror::class_registry::operator=(
+    class_registry const& other
+) {
+    if(this != &other) {
+        reset();
+
+        // lazy classes stay lazy unless they have been built already
+        auto block = other.m_classes.load(std::memory_order_acquire);
+        auto n = block->size.load(std::memory_order_acquire);
+        for(size_t i = 0; i < n; ++i) {
+            auto s = block->items[i];
+            auto ready = s->ready.load(std::memory_order_acquire);
+            add_slot((ready ? s->cls : nullptr), s->name, s->type, s->builder);
+        }
+        if(other.frozen()) { freeze(); }
+    }
+    return *this;
+}
+
+mirror::class_registry::~class_registry(
+) {
+}
+
+void mirror::class_registry::reset(
+) {
+    m_frozen.store(false, std::memory_order_relaxed);
+    m_frozen_names = frozen_table();
+    m_frozen_types = frozen_table();
+    m_frozen_block.clear();
+
+    m_indexes.clear();
+    m_indexes.emplace_back(new live_index(16));
+    m_indexes.emplace_back(new live_index(16));
+    m_by_name.store(m_indexes[0].get(), std::memory_order_release);
+    m_by_type.store(m_indexes[1].get(), std::memory_order_release);
+
+    m_blocks.clear();
+    m_blocks.emplace_back(new class_block(16));
+    m_classes.store(m_blocks.back().get(), std::memory_order_release);
+
+    m_entries.clear();
+    m_slots.clear();
+
+    m_generation.store(g_registry_generation.fetch_add(1) + 1, std::memory_order_release);
+}
+
 void mirror::class_registry::add_class(
     class_base_ptr c
 ) {
     assert(c);
-    assert(!find_class_by_name(c->name));
+    auto name = c->name;
+    auto& type = c->type;
+    add_slot(std::move(c), name, type, nullptr);
+}
+
+void mirror::class_registry::add_lazy_class(
+    atom name,
+    std::type_info const& type,
+    builder_type builder
+) {
+    assert(builder);
+    add_slot(nullptr, name, type, builder);
+}
+
+void mirror::class_registry::add_slot(
+    class_base_ptr c,
+    atom name,
+    std::type_info const& type,
+    builder_type builder
+) {
+    assert(c || builder);
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+
+    if(frozen()) { throw std::logic_error("class_registry: cannot add class '" + name.str() + "' to a frozen registry"); }
+    assert(!find_live(m_by_name.load(std::memory_order_relaxed), name.id(), nullptr));
+
+    std::unique_ptr<class_slot> slot(new class_slot(name, type, builder));
+    if(c) {
+        slot->cls = std::move(c);
+        slot->ready.store(true, std::memory_order_relaxed);
+    }
+    auto s = slot.get();
+    m_slots.emplace_back(std::move(slot));
+
+    // the indexes go first, so all classes in a snapshot of the classes can
+    // be found; the first class registered for a name or a type wins
+    if(!find_live(m_by_name.load(std::memory_order_relaxed), name.id(), nullptr)) {
+        m_entries.emplace_back(new frozen_entry(name.id(), s));
+        insert(m_by_name, m_entries.back().get());
+    }
+    if(!find_live(m_by_type.load(std::memory_order_relaxed), type.hash_code(), &type)) {
+        m_entries.emplace_back(new frozen_entry(type.hash_code(), s));
+        insert(m_by_type, m_entries.back().get());
+    }
+
+    // append to the classes; a full block gets copied into a larger one
+    auto block = m_classes.load(std::memory_order_relaxed);
+    auto n = block->size.load(std::memory_order_relaxed);
+    if(n == block->capacity) {
+        std::unique_ptr<class_block> grown(new class_block(2 * block->capacity));
+        std::copy(block->items.get(), block->items.get() + n, grown->items.get());
+        grown->size.store(n, std::memory_order_relaxed);
+        block = grown.get();
+        m_blocks.emplace_back(std::move(grown));
+        m_classes.store(block, std::memory_order_release);
+    }
+    block->items[n] = s;
+    block->size.store(n + 1, std::memory_order_release);
+
+    m_generation.store(g_registry_generation.fetch_add(1) + 1, std::memory_order_release);
+}
+
+void mirror::class_registry::build(
+    class_slot* s
+) {
+    // concurrent callers wait for the first one; a throwing builder gets
+    // called again on the next use
+    std::call_once(s->once, [s]() {
+        auto c = s->builder(s->name);
+        if(!c || (c->name != s->name) || (c->type != s->type)) {
+            throw std::logic_error("class_registry: the builder of class '" + s->name.str() + "' returned a different class");
+        }
+        s->cls = std::move(c);
+        s->ready.store(true, std::memory_order_release);
+    });
+}
 
-    auto it = find_by_name(classes, c->name);
-    classes.emplace(it, std::move(c));
+mirror::class_registry::class_list mirror::class_registry::classes(
+) const {
+    // a block gets superseded only once it is full, so it never changes
+    // afterwards
+    auto block = m_classes.load(std::memory_order_acquire);
+    return class_list(block->items.get(), block->size.load(std::memory_order_acquire));
+}
+
+mirror::class_registry::stats_type mirror::class_registry::stats(
+) const {
+    auto block = m_classes.load(std::memory_order_acquire);
+    auto n = block->size.load(std::memory_order_acquire);
+
+    stats_type res = { n, 0, 0 };
+    for(size_t i = 0; i < n; ++i) {
+        auto s = block->items[i];
+        if(!s->builder) { continue; }
+        ++res.lazy;
+        if(s->ready.load(std::memory_order_acquire)) { ++res.materialized; }
+    }
+    return res;
+}
+
+void mirror::class_registry::reclaim(
+) {
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+
+    for(auto&& s : m_slots) {
+        if(!s->ready.load(std::memory_order_acquire)) { continue; }
+        for(auto c = s->cls.get(); c; c = c->base_class.get()) { c->reclaim(); }
+    }
+
+    m_blocks.erase(m_blocks.begin(), m_blocks.end() - 1);
+
+    if(frozen()) {
+        // the frozen tables point to the class slots directly
+        m_by_name.store(nullptr, std::memory_order_relaxed);
+        m_by_type.store(nullptr, std::memory_order_relaxed);
+        m_indexes.clear();
+        m_entries.clear();
+        return;
+    }
+
+    auto by_name = m_by_name.load(std::memory_order_relaxed);
+    auto by_type = m_by_type.load(std::memory_order_relaxed);
+    m_indexes.erase(
+        std::remove_if(m_indexes.begin(), m_indexes.end(), [&](std::unique_ptr<live_index> const& i) {
+            return ((i.get() != by_name) && (i.get() != by_type));
+        }),
+        m_indexes.end()
+    );
 }
 
 mirror::class_base_ptr mirror::class_registry::find_class_by_name(
-    std::string const& name
+    atom const& name
 ) const {
-    auto it = find_by_name(classes, name);
-    if(it == classes.end()) { return nullptr; }
-    if((*it)->name != name) { return nullptr; }
-    return *it;
+    auto s = find_name(name);
+    return (s ? materialize(s) : nullptr);
 }
 
 mirror::class_base_ptr mirror::class_registry::find_class_by_type(
     std::type_info const& type
 ) const {
-    auto it = find_by_type(classes, type);
-    if(it == classes.end()) { return nullptr; }
-    return *it;
+    auto s = find_type(type);
+    return (s ? materialize(s) : nullptr);
+}
+
+mirror::class_registry::class_slot* mirror::class_registry::find_name(
+    atom const& name
+) const {
+    if(frozen()) { return find_frozen(m_frozen_names, name.id()); }
+    return find_live(m_by_name.load(std::memory_order_acquire), name.id(), nullptr);
+}
+
+mirror::class_registry::class_slot* mirror::class_registry::find_type(
+    std::type_info const& type
+) const {
+    if(frozen()) {
+        auto s = find_frozen(m_frozen_types, type.hash_code());
+        return ((s && (s->type == type)) ? s : nullptr);
+    }
+    return find_live(m_by_type.load(std::memory_order_acquire), type.hash_code(), &type);
+}
+
+// The frozen tables use hash-and-displace: a key first hashes into a
+// bucket, the bucket's pilot value then displaces the key into its slot. The
+// pilots are chosen at build time so that every key gets a slot of its own
+// and there are exactly as many slots as keys.
+static inline uint64_t mix_key(
+    uint64_t k
+) {
+    k *= 0x9e3779b97f4a7c15ULL;
+    k ^= k >> 32;
+    k *= 0xff51afd7ed558ccdULL;
+    return k;
+}
+
+static inline uint32_t bucket_of(
+    uint64_t h,
+    uint32_t num_buckets
+) {
+    return static_cast<uint32_t>(((h >> 32) * num_buckets) >> 32);
+}
+
+static inline uint32_t slot_of(
+    uint64_t h,
+    uint64_t pilot,
+    uint32_t num_slots
+) {
+    // the multiply mixes the pilot into the high bits used for the reduction
+    return static_cast<uint32_t>(((((h ^ pilot) * 0x9e3779b97f4a7c15ULL) >> 32) * num_slots) >> 32);
+}
+
+void mirror::class_registry::insert(
+    std::atomic<live_index*>& index,
+    frozen_entry const* e
+) {
+    auto t = index.load(std::memory_order_relaxed);
+    if(2 * (t->size + 1) > (t->mask + 1)) {
+        // readers keep probing the old index until the new one is published
+        std::unique_ptr<live_index> grown(new live_index(2 * (t->mask + 1)));
+        for(size_t i = 0; i <= t->mask; ++i) {
+            auto old = t->slots[i].load(std::memory_order_relaxed);
+            if(!old) { continue; }
+            auto s = mix_key(old->key) & grown->mask;
+            while(grown->slots[s].load(std::memory_order_relaxed)) { s = ((s + 1) & grown->mask); }
+            grown->slots[s].store(old, std::memory_order_relaxed);
+        }
+        grown->size = t->size;
+        t = grown.get();
+        m_indexes.emplace_back(std::move(grown));
+        index.store(t, std::memory_order_release);
+    }
+
+    auto s = mix_key(e->key) & t->mask;
+    while(t->slots[s].load(std::memory_order_relaxed)) { s = ((s + 1) & t->mask); }
+    t->slots[s].store(e, std::memory_order_release);
+    ++t->size;
+}
+
+mirror::class_registry::class_slot* mirror::class_registry::find_live(
+    live_index const* t,
+    uint64_t key,
+    std::type_info const* type
+) const {
+    // different types may share a hash code, so those get compared as well
+    for(auto s = mix_key(key) & t->mask; ; s = ((s + 1) & t->mask)) {
+        auto e = t->slots[s].load(std::memory_order_acquire);
+        if(!e) { return nullptr; }
+        if((e->key == key) && (!type || (e->slot->type == *type))) { return e->slot; }
+    }
+}
+
+// Computes the per bucket pilots for `entries` (key, class index) and
+// appends them followed by the slots to `block`; the keys need to be unique.
+template<typename ENTRY, typename TABLE, typename CLASSES>
+static void build_frozen_table(
+    std::vector<std::pair<uint64_t, size_t>> const& entries,
+    CLASSES const& classes,
+    std::vector<ENTRY>& block,
+    TABLE& table
+) {
+    auto const n = static_cast<uint32_t>(entries.size());
+    auto const num_buckets = std::max<uint32_t>(1, n / 4);
+
+    std::vector<std::vector<uint32_t>> buckets(num_buckets);
+    std::vector<uint64_t> hashes(n);
+    for(uint32_t i = 0; i < n; ++i) {
+        hashes[i] = mix_key(entries[i].first);
+        buckets[bucket_of(hashes[i], num_buckets)].push_back(i);
+    }
+
+    // place the largest buckets first while there are still many free slots
+    std::vector<uint32_t> order(num_buckets);
+    for(uint32_t b = 0; b < num_buckets; ++b) { order[b] = b; }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t l, uint32_t r) { return (buckets[l].size() > buckets[r].size()); });
+
+    std::vector<uint64_t> pilots(num_buckets, 0);
+    std::vector<bool> taken(n, false);
+    std::vector<uint32_t> slots;
+    for(auto b : order) {
+        auto const& keys = buckets[b];
+        if(keys.empty()) { break; }
+
+        for(uint64_t attempt = 0; ; ++attempt) {
+            // two keys of a bucket with the same hash can never be separated
+            if(attempt == (uint64_t(1) << 24)) { throw std::logic_error("class_registry: hash collision, cannot freeze"); }
+
+            auto pilot = mix_key(attempt);
+            slots.clear();
+            for(auto i : keys) {
+                auto s = slot_of(hashes[i], pilot, n);
+                if(taken[s] || (std::find(slots.begin(), slots.end(), s) != slots.end())) { break; }
+                slots.push_back(s);
+            }
+            if(slots.size() == keys.size()) {
+                for(auto s : slots) { taken[s] = true; }
+                pilots[b] = pilot;
+                break;
+            }
+        }
+    }
+
+    table.pilot_offset  = static_cast<uint32_t>(block.size());
+    table.num_buckets   = num_buckets;
+    for(auto pilot : pilots) { block.emplace_back(pilot, nullptr); }
+
+    table.slot_offset   = static_cast<uint32_t>(block.size());
+    table.num_slots     = n;
+    block.resize(block.size() + n);
+    for(uint32_t i = 0; i < n; ++i) {
+        auto s = slot_of(hashes[i], pilots[bucket_of(hashes[i], num_buckets)], n);
+        block[table.slot_offset + s] = ENTRY(entries[i].first, classes[entries[i].second]);
+    }
+}
+
+void mirror::class_registry::freeze(
+) {
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    if(frozen()) { return; }
+
+    // lazy classes stay lazy
+    auto block = m_classes.load(std::memory_order_relaxed);
+    auto classes = block->items.get();
+    auto by_name = m_by_name.load(std::memory_order_relaxed);
+    auto by_type = m_by_type.load(std::memory_order_relaxed);
+
+    std::vector<std::pair<uint64_t, size_t>> names, types;
+    for(size_t i = 0, n = block->size.load(std::memory_order_relaxed); i < n; ++i) {
+        auto c = classes[i];
+
+        // only the classes found by the live indexes go into the tables
+        if(find_live(by_name, c->name.id(), nullptr) == c) { names.emplace_back(c->name.id(), i); }
+        if(find_live(by_type, c->type.hash_code(), &c->type) == c) { types.emplace_back(c->type.hash_code(), i); }
+    }
+
+    auto sorted = types;
+    std::sort(sorted.begin(), sorted.end());
+    for(size_t i = 1; i < sorted.size(); ++i) {
+        if(sorted[i - 1].first == sorted[i].first) { throw std::logic_error("class_registry: type hash collision, cannot freeze"); }
+    }
+
+    std::vector<frozen_entry> tables;
+    tables.reserve(names.size() + names.size() / 4 + types.size() + types.size() / 4 + 2);
+    build_frozen_table(names, classes, tables, m_frozen_names);
+    build_frozen_table(types, classes, tables, m_frozen_types);
+
+    // the live indexes stay around for the readers still using them
+    m_frozen_block = std::move(tables);
+    m_frozen.store(true, std::memory_order_release);
+}
+
+mirror::class_registry::class_slot* mirror::class_registry::find_frozen(
+    frozen_table const& t,
+    uint64_t key
+) const {
+    if(t.num_slots == 0) { return nullptr; }
+
+    auto const* block = m_frozen_block.data();
+    auto h = mix_key(key);
+    auto pilot = block[t.pilot_offset + bucket_of(h, t.num_buckets)].key;
+    auto const& slot = block[t.slot_offset + slot_of(h, pilot, t.num_slots)];
+    return ((slot.key == key) ? slot.slot : nullptr);
 }
 
 mirror::value mirror::class_registry::invoke(
     context& ctx,
     value const& obj,
-    std::string const& method,
+    atom const& method,
     values const& args
 ) const {
-    throw std::runtime_error("not implemented: " + method);
+    if(!obj.is_ptr()) { throw std::invalid_argument("cannot invoke '" + method.str() + "' on a non object value"); }
+
+    auto s = find_type(*obj.m_type);
+    if(!s) { throw std::runtime_error(std::string("class not registered: ") + obj.m_type->name()); }
+    return materialize(s)->invoke(ctx, obj, method, args);
+}
+
+mirror::value mirror::call_site::invoke_miss(
+    class_registry const& reg,
+    context&,
+    value const& obj,
+    atom const& method,
+    value_span args
+) {
+    ++m_misses;
+    if(!obj.is_ptr()) { throw std::invalid_argument("cannot invoke '" + method.str() + "' on a non object value"); }
+
+    auto epoch = class_info_base::members_epoch();
+    if(epoch != m_epoch) {
+        for(size_t i = 0; i < m_size; ++i) { m_entries[i] = entry(); }
+        m_size = 0;
+        m_next = 0;
+        m_epoch = epoch;
+    }
+
+    auto cls = reg.find_class_by_type(*obj.m_type);
+    if(!cls) { throw std::runtime_error(std::string("class not registered: ") + obj.m_type->name()); }
+
+    auto handle = cls->find_method(method, args);
+    if(!handle) { throw std::runtime_error("method not found: " + method.str()); }
+
+    auto overloaded = (cls->members().overloads.count(member_table::method_key(method, args.size)) > 0);
+    auto signature = member_table::kind_signature(args);
+    if(overloaded && (signature == ~uint64_t(0))) { return handle.call(obj.m_obj.get(), args); } // too many arguments to cache
+
+    // fill up the free entries first, then replace them round robin
+    auto& e = ((m_size < max_entries) ? m_entries[m_size++] : m_entries[m_next++ % max_entries]);
+    e.type          = obj.m_type;
+    e.method        = method;
+    e.num_args      = args.size;
+    e.overloaded    = overloaded;
+    e.signature     = signature;
+    e.handle        = std::move(handle);
+    return e.handle.call(obj.m_obj.get(), args);
 }
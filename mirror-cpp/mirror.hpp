@@ -24,9 +24,16 @@
 #pragma once
 
 #include "mirror-cpp.hpp"
+#include "atom.hpp"
+#include "convert.hpp"
 #include "value.hpp"
 
+#include <atomic>
+#include <cstring>
 #include <functional>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
 
 
 
@@ -49,10 +56,10 @@ namespace mirror {
         virtual ~name_type_info() { }
 
         inline name_type_info(
-            std::string n, std::type_info const& t
-        ) : name(std::move(n)), type(t) { assert(!name.empty()); }
+            atom n, std::type_info const& t
+        ) : name(n), type(t) { assert(!name.empty()); }
 
-        std::string const name;
+        atom const name; // interned, so name comparisons are a single compare
         std::type_info const& type;
 
         virtual std::string to_string(int indent = 0) const;
@@ -60,178 +67,920 @@ namespace mirror {
     typedef std::shared_ptr<name_type_info> name_type_ptr;
 
     struct MIRROR_API property_info : name_type_info {
+        /// Read and write the property of the object at `obj`, which points
+        /// to an object of the class the property has been registered for.
+        typedef value (*get_thunk_type)(property_info const& p, void const* obj);
+        typedef void  (*set_thunk_type)(property_info const& p, void* obj, value const& v);
+
+        /// The address of the property within the object at `obj`.
+        typedef void* (*address_thunk_type)(property_info const& p, void* obj);
+
+        /// Large enough for the member data pointers of all compilers.
+        static const size_t max_pointer_size = 2 * sizeof(void*);
+
         inline property_info(
-            std::string n, std::type_info const& t,
+            atom n, std::type_info const& t,
             bool ro
-        ) : name_type_info(std::move(n), t), read_only(ro) { }
+        ) : name_type_info(n, t), read_only(ro), owner(typeid(void)), offset(-1), get_thunk(nullptr), set_thunk(nullptr), address_thunk(nullptr) {
+            std::memset(m_pointer, 0, sizeof(m_pointer));
+        }
+
+        inline property_info(
+            atom n, std::type_info const& t, std::type_info const& o,
+            bool ro, ptrdiff_t off, get_thunk_type g, set_thunk_type s, address_thunk_type a,
+            void const* ptr, size_t ptr_size
+        ) : name_type_info(n, t), read_only(ro), owner(o), offset(off), get_thunk(g), set_thunk(s), address_thunk(a) {
+            assert(ptr_size <= max_pointer_size);
+            std::memset(m_pointer, 0, sizeof(m_pointer));
+            std::memcpy(m_pointer, ptr, ptr_size);
+        }
 
         bool const read_only;
+        std::type_info const& owner;    ///< the class the property has been registered for; `void` if unknown
+        ptrdiff_t const offset;         ///< byte offset in `owner` for standard-layout classes; -1 otherwise
+        get_thunk_type const get_thunk; ///< null if the property is not copyable, its type is not supported by `convert`, or it has no member pointer
+        set_thunk_type const set_thunk; ///< null if the property is read only, not assignable, can not be converted from a value, or has no member pointer
+        address_thunk_type const address_thunk; ///< null if the property has been registered without a member pointer or its type is not supported by `convert`
+
+        /// Reads/writes the property of the object at `obj`; no type checks.
+        /// Throw `std::logic_error` if there is no accessor or the property is
+        /// read only.
+        inline value get(void const* obj) const { if(!get_thunk) { throw_no_access(); } return get_thunk(*this, obj); }
+        inline void set(void* obj, value const& v) const { if(!set_thunk) { throw_no_access(); } set_thunk(*this, obj, v); }
+        inline void* address(void* obj) const { if(!address_thunk) { throw_no_access(); } return address_thunk(*this, obj); }
+
+        /// The stored member data pointer; `MEMBER` must be its type.
+        template<typename MEMBER>
+        inline MEMBER pointer() const {
+            static_assert(sizeof(MEMBER) <= max_pointer_size, "member data pointer too large");
+            MEMBER m; std::memcpy(&m, m_pointer, sizeof(m)); return m;
+        }
 
         virtual std::string to_string(int indent = 0) const override;
+
+    private:
+        void throw_no_access() const;
+
+        unsigned char m_pointer[max_pointer_size];
     };
     typedef std::shared_ptr<property_info> property_ptr;
 
+    namespace detail {
+
+        // standard-layout classes access their members via the offset, all
+        // others via the member pointer
+        template<typename T, typename MEMBER, bool OFFSET = std::is_standard_layout<T>::value>
+        struct member_access {
+            static inline MEMBER& ref(property_info const& p, void* obj) { return *reinterpret_cast<MEMBER*>(static_cast<char*>(obj) + p.offset); }
+        };
+
+        template<typename T, typename MEMBER>
+        struct member_access<T, MEMBER, false> {
+            static inline MEMBER& ref(property_info const& p, void* obj) { return (static_cast<T*>(obj)->*p.pointer<MEMBER T::*>()); }
+        };
+
+        template<typename T, typename MEMBER>
+        inline ptrdiff_t member_offset(MEMBER T::*member) {
+            if(!std::is_standard_layout<T>::value) { return -1; }
+
+            // only computes an address within (uninitialized) storage for a T
+            static typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+            auto obj = reinterpret_cast<T*>(&storage);
+            return (reinterpret_cast<char const*>(&(obj->*member)) - reinterpret_cast<char const*>(obj));
+        }
+
+        template<typename T, typename MEMBER>
+        struct property_thunk {
+            typedef typename std::decay<MEMBER>::type value_type;
+            typedef member_access<T, MEMBER> access;
+
+            static value get(property_info const& p, void const* obj) {
+                return convert<value_type>::to_value(access::ref(p, const_cast<void*>(obj)));
+            }
+
+            static void set(property_info const& p, void* obj, value const& v) {
+                access::ref(p, obj) = convert<value_type>::from_value(v);
+            }
+
+            static void* address(property_info const& p, void* obj) {
+                return const_cast<value_type*>(&access::ref(p, obj));
+            }
+
+            // `get()` and `set()` only get instantiated for copyable and
+            // non-const, assignable members respectively, whose type is
+            // supported by `convert`; members `convert` knows nothing about
+            // (e.g., C arrays or pointers to non-class types) get no accessors
+            typedef std::integral_constant<bool, can_convert_to_value<value_type>::value || can_convert_from_value<value_type>::value> supported;
+
+            static inline property_info::get_thunk_type getter() { return getter(std::integral_constant<bool, std::is_copy_constructible<value_type>::value && can_convert_to_value<value_type>::value>()); }
+            static inline property_info::get_thunk_type getter(std::true_type)  { return &get; }
+            static inline property_info::get_thunk_type getter(std::false_type) { return nullptr; }
+
+            static inline property_info::set_thunk_type setter() { return setter(std::integral_constant<bool, !std::is_const<MEMBER>::value && std::is_copy_assignable<value_type>::value && can_convert_from_value<value_type>::value>()); }
+            static inline property_info::set_thunk_type setter(std::true_type)  { return &set; }
+            static inline property_info::set_thunk_type setter(std::false_type) { return nullptr; }
+
+            static inline property_info::address_thunk_type addresser() { return addresser(supported()); }
+            static inline property_info::address_thunk_type addresser(std::true_type)  { return &address; }
+            static inline property_info::address_thunk_type addresser(std::false_type) { return nullptr; }
+        };
+
+    } // namespace detail
+
     template<typename T>
-    inline property_ptr make_property(std::string name) {
+    inline property_ptr make_property(atom name) {
         auto read_only = std::is_const<T>::value;
-        return std::make_shared<property_info>(std::move(name), typeid(T), read_only);
+        return std::make_shared<property_info>(name, typeid(T), read_only);
+    }
+
+    template<typename T, typename MEMBER>
+    inline property_ptr make_property(atom name, MEMBER T::*member) {
+        typedef detail::property_thunk<T, MEMBER> thunk;
+        auto read_only = std::is_const<MEMBER>::value;
+        return std::make_shared<property_info>(
+            name, typeid(MEMBER), typeid(T), read_only, detail::member_offset(member),
+            thunk::getter(), thunk::setter(), thunk::addresser(), &member, sizeof(member)
+        );
     }
 
+    namespace detail {
+
+        template<size_t... I> struct indices { };
+
+        template<size_t N, size_t... I>
+        struct make_indices : make_indices<N - 1, N - 1, I...> { };
+
+        template<size_t... I>
+        struct make_indices<0, I...> { typedef indices<I...> type; };
+
+    } // namespace detail
+
     struct MIRROR_API method_info : name_type_info {
-        typedef std::function<value(context& ctx, value const& obj, values const& args)> invoke_type;
+        /// Calls the method on `obj`, which points to an object of the class
+        /// the method has been registered for.
+        typedef value (*thunk_type)(method_info const& m, void* obj, value_span args);
+
+        /// Ranks the conversion of a value of kind `k` to an argument.
+        typedef conversion_rank (*rank_type)(value_kind k);
+
+        /// Returned by `rank()` if the arguments do not match.
+        static const size_t no_match = size_t(-1);
+
+        /// Large enough for the member function pointers of all compilers.
+        static const size_t max_pointer_size = 4 * sizeof(void*);
 
         inline method_info(
-            std::string n, std::type_info const& t,
-            size_t a, invoke_type i
-        ) : name_type_info(std::move(n), t), num_args(a), invoke(std::move(i)) { }
+            atom n, std::type_info const& t, std::type_info const& o, std::type_info const& r,
+            size_t a, std::type_info const* const* at, rank_type const* ar, thunk_type th, void const* ptr, size_t ptr_size
+        ) : name_type_info(n, t), owner(o), result_type(r), num_args(a), arg_types(at), arg_ranks(ar), thunk(th) {
+            assert(ptr_size <= max_pointer_size);
+            std::memset(m_pointer, 0, sizeof(m_pointer));
+            std::memcpy(m_pointer, ptr, ptr_size);
+        }
 
+        std::type_info const& owner; ///< the class the method has been registered for
+        std::type_info const& result_type; ///< decayed; `typeid(void)` if none
         size_t const num_args;
-        invoke_type const invoke;
+        std::type_info const* const* const arg_types; ///< `num_args` decayed argument types
+        rank_type const* const arg_ranks; ///< one per argument
+        thunk_type const thunk;
+
+        /// The sum of the conversion ranks of `args` (lower is better), or
+        /// `no_match` if their number or any of their kinds do not match.
+        size_t rank(value_span args) const;
+
+        /// Invokes the method on the object held by `obj`, which needs to
+        /// be of type `owner`; throws `std::invalid_argument` otherwise or
+        /// if the arguments do not match.
+        value invoke(context& ctx, value const& obj, values const& args) const;
+
+        /// Invokes the method on the object at `obj`; no type checks.
+        inline value call(void* obj, value_span args) const { return thunk(*this, obj, args); }
+
+        /// The stored member function pointer; `METHOD` must be its type.
+        template<typename METHOD>
+        inline METHOD pointer() const {
+            static_assert(sizeof(METHOD) <= max_pointer_size, "member function pointer too large");
+            METHOD m; std::memcpy(&m, m_pointer, sizeof(m)); return m;
+        }
 
         virtual std::string to_string(int indent = 0) const override;
+
+    private:
+        unsigned char m_pointer[max_pointer_size];
     };
     typedef std::shared_ptr<method_info> method_ptr;
 
-    template<typename T>
-    inline method_ptr make_method(std::string name, void (T::*method)()) {
-        auto invoke = [=](context& ctx, value const& obj, values const& args) -> value {
-            throw std::runtime_error(std::string("not implemented for: ") + typeid(method).name());
+    namespace detail {
+
+        [[noreturn]] MIRROR_API void throw_arg_count_mismatch(method_info const& m, size_t num_args);
+        [[noreturn]] MIRROR_API void throw_unsupported_signature(method_info const& m);
+
+        // How an argument converted by `convert` is passed on to the method:
+        // moved from for rvalue reference and move-only by-value parameters.
+        template<typename ARG>
+        struct arg_cast : std::conditional<
+            !std::is_reference<ARG>::value && !std::is_copy_constructible<ARG>::value, ARG&&, ARG
+        > { };
+
+        // `OBJ` is the reference type the method is called on, e.g., `T&&`
+        // for rvalue ref-qualified methods.
+        template<typename OBJ, typename METHOD, typename RESULT, typename... ARGS>
+        struct method_thunk {
+            typedef typename std::remove_reference<OBJ>::type object_type;
+
+            static value call(method_info const& m, void* obj, value_span args) {
+                if(args.size != sizeof...(ARGS)) { throw_arg_count_mismatch(m, args.size); }
+                return apply(*static_cast<object_type*>(obj), m.pointer<METHOD>(), args, typename make_indices<sizeof...(ARGS)>::type());
+            }
+
+            template<size_t... I>
+            static inline value apply(object_type& obj, METHOD method, value_span args, indices<I...>) {
+                (void)args; // not used by methods without arguments
+                return convert<typename std::decay<RESULT>::type>::to_value(
+                    (static_cast<OBJ>(obj).*method)(static_cast<typename arg_cast<ARGS>::type>(convert<typename std::decay<ARGS>::type>::from_value(args[I]))...)
+                );
+            }
         };
-        return std::make_shared<method_info>(std::move(name), typeid(method), 0, std::move(invoke));
-    }
 
-    template<typename T>
-    inline method_ptr make_method(std::string name, void (T::*method)() const) {
-        auto invoke = [=](context& ctx, value const& obj, values const& args) -> value {
-            throw std::runtime_error(std::string("not implemented for: ") + typeid(method).name());
+        template<typename OBJ, typename METHOD, typename... ARGS>
+        struct method_thunk<OBJ, METHOD, void, ARGS...> {
+            typedef typename std::remove_reference<OBJ>::type object_type;
+
+            static value call(method_info const& m, void* obj, value_span args) {
+                if(args.size != sizeof...(ARGS)) { throw_arg_count_mismatch(m, args.size); }
+                apply(*static_cast<object_type*>(obj), m.pointer<METHOD>(), args, typename make_indices<sizeof...(ARGS)>::type());
+                return value();
+            }
+
+            template<size_t... I>
+            static inline void apply(object_type& obj, METHOD method, value_span args, indices<I...>) {
+                (void)args; // not used by methods without arguments
+                (static_cast<OBJ>(obj).*method)(static_cast<typename arg_cast<ARGS>::type>(convert<typename std::decay<ARGS>::type>::from_value(args[I]))...);
+            }
         };
-        return std::make_shared<method_info>(std::move(name), typeid(method), 0, std::move(invoke));
-    }
 
-    template<typename T, typename RESULT>
-    inline method_ptr make_method(std::string name, RESULT (T::*method)()) {
-        auto invoke = [=](context& ctx, value const& obj, values const& args) -> value {
-            throw std::runtime_error(std::string("not implemented for: ") + typeid(method).name());
+        template<bool... B> struct bool_pack { };
+        template<bool... B> struct all_of : std::is_same<bool_pack<true, B...>, bool_pack<B..., true>> { };
+
+        // whether `convert` supports the result and all arguments of a method
+        template<typename RESULT, typename... ARGS>
+        struct supported_signature : all_of<
+            (std::is_void<RESULT>::value || can_convert_to_value<typename std::decay<RESULT>::type>::value),
+            can_convert_from_value<typename std::decay<ARGS>::type>::value...
+        > { };
+
+        // methods with other signatures (e.g., taking a `char const*`) can be
+        // registered, but throw `std::invalid_argument` when called
+        template<typename OBJ>
+        struct unsupported_method_thunk {
+            typedef typename std::remove_reference<OBJ>::type object_type;
+
+            static value call(method_info const& m, void*, value_span) { throw_unsupported_signature(m); }
         };
-        return std::make_shared<method_info>(std::move(name), typeid(method), 0, std::move(invoke));
+
+        // one entry per argument, null terminated
+        template<typename... ARGS>
+        inline std::type_info const* const* arg_types() {
+            static std::type_info const* const types[] = { &typeid(typename std::decay<ARGS>::type)..., nullptr };
+            return types;
+        }
+
+        template<typename... ARGS>
+        inline method_info::rank_type const* arg_ranks() {
+            static method_info::rank_type const ranks[] = { &rank_of<typename std::decay<ARGS>::type>..., nullptr };
+            return ranks;
+        }
+
+        template<typename OBJ, typename METHOD, typename RESULT, typename... ARGS>
+        inline method_ptr make_method(atom name, METHOD method) {
+            typedef typename std::conditional<
+                supported_signature<RESULT, ARGS...>::value,
+                method_thunk<OBJ, METHOD, RESULT, ARGS...>,
+                unsupported_method_thunk<OBJ>
+            >::type thunk;
+            return std::make_shared<method_info>(
+                name, typeid(method), typeid(typename thunk::object_type), typeid(typename std::decay<RESULT>::type),
+                sizeof...(ARGS), arg_types<ARGS...>(), arg_ranks<ARGS...>(), &thunk::call, &method, sizeof(method)
+            );
+        }
+
+        template<typename T, typename BASE>
+        inline void* upcast(void* obj) { return static_cast<BASE*>(static_cast<T*>(obj)); }
+
+    } // namespace detail
+
+    // `noexcept` is not part of the function type (before C++17), so these
+    // cover noexcept methods as well.
+
+    template<typename T, typename RESULT, typename... ARGS>
+    inline method_ptr make_method(atom name, RESULT (T::*method)(ARGS...)) {
+        return detail::make_method<T&, decltype(method), RESULT, ARGS...>(name, method);
     }
 
-    template<typename T, typename RESULT>
-    inline method_ptr make_method(std::string name, RESULT (T::*method)() const) {
-        auto invoke = [=](context& ctx, value const& obj, values const& args) -> value {
-            throw std::runtime_error(std::string("not implemented for: ") + typeid(method).name());
-        };
-        return std::make_shared<method_info>(std::move(name), typeid(method), 0, std::move(invoke));
+    template<typename T, typename RESULT, typename... ARGS>
+    inline method_ptr make_method(atom name, RESULT (T::*method)(ARGS...) const) {
+        return detail::make_method<T const&, decltype(method), RESULT, ARGS...>(name, method);
     }
 
-    template<typename T, typename RESULT, typename ARG1>
-    inline method_ptr make_method(std::string name, RESULT (T::*method)(ARG1)) {
-        auto invoke = [=](context& ctx, value const& obj, values const& args) -> value {
-            throw std::runtime_error(std::string("not implemented for: ") + typeid(method).name());
-        };
-        return std::make_shared<method_info>(std::move(name), typeid(method), 0, std::move(invoke));
+    template<typename T, typename RESULT, typename... ARGS>
+    inline method_ptr make_method(atom name, RESULT (T::*method)(ARGS...) &) {
+        return detail::make_method<T&, decltype(method), RESULT, ARGS...>(name, method);
     }
 
-    template<typename T, typename RESULT, typename ARG1>
-    inline method_ptr make_method(std::string name, RESULT (T::*method)(ARG1) const) {
-        auto invoke = [=](context& ctx, value const& obj, values const& args) -> value {
-            throw std::runtime_error(std::string("not implemented for: ") + typeid(method).name());
-        };
-        return std::make_shared<method_info>(std::move(name), typeid(method), 0, std::move(invoke));
+    template<typename T, typename RESULT, typename... ARGS>
+    inline method_ptr make_method(atom name, RESULT (T::*method)(ARGS...) const&) {
+        return detail::make_method<T const&, decltype(method), RESULT, ARGS...>(name, method);
     }
 
-    template<typename T, typename RESULT, typename ARG1, typename ARG2>
-    inline method_ptr make_method(std::string name, RESULT (T::*method)(ARG1, ARG2)) {
-        auto invoke = [=](context& ctx, value const& obj, values const& args) -> value {
-            throw std::runtime_error(std::string("not implemented for: ") + typeid(method).name());
-        };
-        return std::make_shared<method_info>(std::move(name), typeid(method), 0, std::move(invoke));
+    /// Calling an rvalue ref-qualified method moves from the object.
+    template<typename T, typename RESULT, typename... ARGS>
+    inline method_ptr make_method(atom name, RESULT (T::*method)(ARGS...) &&) {
+        return detail::make_method<T&&, decltype(method), RESULT, ARGS...>(name, method);
     }
 
-    template<typename T, typename RESULT, typename ARG1, typename ARG2>
-    inline method_ptr make_method(std::string name, RESULT (T::*method)(ARG1, ARG2) const) {
-        auto invoke = [=](context& ctx, value const& obj, values const& args) -> value {
-            throw std::runtime_error(std::string("not implemented for: ") + typeid(method).name());
-        };
-        return std::make_shared<method_info>(std::move(name), typeid(method), 0, std::move(invoke));
+    template<typename T, typename RESULT, typename... ARGS>
+    inline method_ptr make_method(atom name, RESULT (T::*method)(ARGS...) const&&) {
+        return detail::make_method<T const&&, decltype(method), RESULT, ARGS...>(name, method);
     }
 
+    /// The members of a class merged with the members of all its base
+    /// classes; members of a derived class shadow those of its bases.
+    /// Methods are keyed by their name and number of arguments; all members
+    /// know how many levels up the hierarchy they have been registered.
+    /// Overloads with the same number of arguments are resolved by the kinds
+    /// of the argument values, see `resolve()`.
+    struct MIRROR_API member_table {
+        static inline uint64_t method_key(atom const& name, size_t num_args) { return ((uint64_t(name.id()) << 32) | uint64_t(num_args)); }
+
+        /// Packs the kinds of up to 16 arguments into one key; all larger
+        /// argument lists map to `~0`.
+        static inline uint64_t kind_signature(value_span args) {
+            if(args.size > 16) { return ~uint64_t(0); }
+            uint64_t res = 0;
+            for(size_t i = 0; i < args.size; ++i) { res |= (uint64_t(args[i].kind()) + 1) << (4 * i); }
+            return res;
+        }
+
+        struct property_entry {
+            property_ptr    property;
+            size_t          depth; ///< 0 for the own properties of a class
+        };
+
+        struct method_entry {
+            method_ptr  method;
+            size_t      depth; ///< 0 for the own methods of a class
+        };
+
+        /// The best candidate by `kind_signature()`; never modified once
+        /// published, see `overload_set::resolved`.
+        typedef std::unordered_map<uint64_t, size_t> resolved_map;
+
+        /// The methods sharing a name and number of arguments.
+        struct overload_set {
+            inline overload_set() : resolved(nullptr) { }
+
+            std::vector<method_entry> candidates; ///< in registration order
+
+            /// Replaced by an extended copy for each newly resolved signature,
+            /// so resolving a known signature is a lock-free hash probe.
+            mutable std::atomic<resolved_map const*> resolved;
+        };
+
+        std::unordered_map<atom, property_entry>    properties;
+        std::unordered_map<uint64_t, method_entry>  methods;    ///< the first registered overload
+        std::unordered_map<uint64_t, overload_set>  overloads;  ///< only for overloaded methods
+
+        inline member_table() : serial(0), version(0), base_serial(0), checked(0) { }
+
+        uint64_t serial;        ///< unique for every table built
+        uint64_t version;       ///< the version of the class when built
+        uint64_t base_serial;   ///< the `serial` of the merged base class table; 0 if none
+
+        /// The `class_info_base::members_epoch()` this table has last been
+        /// found up to date in.
+        mutable std::atomic<uint64_t> checked;
+
+        /// The method `key` best matching the kinds of `args`: the one with
+        /// the lowest `method_info::rank()`, the first registered one on a
+        /// tie. Returns null if there is no method `key`, and throws
+        /// `std::invalid_argument` if none of the overloads match. Only the
+        /// first resolution of a signature ranks the candidates and locks.
+        method_entry const* resolve(uint64_t key, value_span args) const;
+
+        /// Frees the superseded resolved maps; must not run concurrently with
+        /// any other use of the table.
+        void reclaim();
+
+    private:
+        mutable std::mutex                                          m_resolve_mutex;    // serializes publishing resolved maps
+        mutable std::vector<std::unique_ptr<resolved_map const>>    m_resolved_maps;    // all published maps, the superseded ones stay alive for concurrent readers
+    };
+
+    typedef void* (*upcast_type)(void* obj);
+
+    struct class_info_base;
+    struct class_registry;
+
+    /// The properties of a class (including the inherited ones) compiled
+    /// into a flat list of steps for converting objects from and to values;
+    /// see `class_info_base::codec()`. By-value members of classes that are
+    /// registered at the time the codec gets compiled become nested dicts;
+    /// registering further classes makes the codec get compiled again.
+    struct MIRROR_API value_codec {
+        struct step {
+            atom                                    name;
+            property_info const*                    property;
+            size_t                                  depth;  ///< the level in the class hierarchy the property is registered at
+            std::shared_ptr<class_info_base const>  nested; ///< the class of a by-value member of a registered class; null otherwise
+        };
+
+        std::vector<step>           steps;      ///< base class properties first
+        std::vector<upcast_type>    upcasts;    ///< from one level to the next one; null for identity
+        class_registry const*       registry;   ///< the registry the nested classes have been resolved in
+        uint64_t                    generation; ///< the `class_registry::generation()` of `registry` when compiled
+        uint64_t                    members;    ///< the `member_table::serial` of the class when compiled
+
+        /// Returns a dict of the properties of the object at `obj`.
+        value encode(void const* obj) const;
+
+        /// Assigns the writable properties of the object at `obj` from the
+        /// dict `v`, leaving those missing in `v` untouched; nested objects
+        /// get assigned in place. Throws `std::invalid_argument` if `v` (or
+        /// one for a nested object) is not a dict.
+        void decode(value const& v, void* obj) const;
+    };
+
+    /// A method resolved once by class, name, and number of arguments via
+    /// `class_info_base::find_method()`; calling it does no lookups. The
+    /// handle keeps calling the resolved method even if the class gets
+    /// modified afterwards.
+    struct MIRROR_API method_handle {
+        inline method_handle() : m_type(nullptr) { }
+
+        inline explicit operator bool() const { return (m_method != nullptr); }
+        inline method_ptr const& method() const { return m_method; }
+
+        /// Invokes the method on the object held by `obj`, which needs to be
+        /// of the type of the class the handle has been resolved for.
+        inline value operator()(value const& obj, value_span args) const {
+            if(!m_method || !obj.is_ptr() || ((obj.m_type != m_type) && (*obj.m_type != *m_type))) { throw_type_mismatch(obj); }
+            return call(obj.m_obj.get(), args);
+        }
+
+        /// Invokes the method on the object at `obj`, which needs to be of the
+        /// type of the class the handle has been resolved for; no type checks.
+        inline value call(void* obj, value_span args) const {
+            for(auto&& u : m_upcasts) { obj = u(obj); }
+            return m_method->call(obj, args);
+        }
+
+    private:
+        friend struct class_info_base;
+
+        void throw_type_mismatch(value const& obj) const;
+
+        std::type_info const*       m_type;     // the class the handle has been resolved for
+        method_ptr                  m_method;
+        std::vector<upcast_type>    m_upcasts;  // from `m_type` to the class owning the method
+    };
+
+    /// A property resolved once by class and name via
+    /// `class_info_base::find_property()`; accessing it does no lookups.
+    struct MIRROR_API property_handle {
+        inline property_handle() : m_type(nullptr) { }
+
+        inline explicit operator bool() const { return (m_property != nullptr); }
+        inline property_ptr const& property() const { return m_property; }
+
+        /// Read/write the property of the object held by `obj`, which needs
+        /// to be of the type of the class the handle has been resolved for.
+        inline value get(value const& obj) const { check_type(obj); return get(static_cast<void const*>(obj.m_obj.get())); }
+        inline void set(value const& obj, value const& v) const { check_type(obj); set(obj.m_obj.get(), v); }
+
+        /// Reads the property of all objects in `objs` into `out`, which
+        /// needs to have room for `objs.size` values.
+        void get(value_span objs, value* out) const;
+
+        /// Read/write the property of the object at `obj`, which needs to be
+        /// of the type of the class the handle has been resolved for; no
+        /// type checks.
+        inline value get(void const* obj) const { return m_property->get(adjust(const_cast<void*>(obj))); }
+        inline void set(void* obj, value const& v) const { m_property->set(adjust(obj), v); }
+
+    private:
+        friend struct class_info_base;
+
+        inline void check_type(value const& obj) const {
+            if(!m_property || !obj.is_ptr() || ((obj.m_type != m_type) && (*obj.m_type != *m_type))) { throw_type_mismatch(obj); }
+        }
+        inline void* adjust(void* obj) const {
+            for(auto&& u : m_upcasts) { obj = u(obj); }
+            return obj;
+        }
+        void throw_type_mismatch(value const& obj) const;
+
+        std::type_info const*       m_type;     // the class the handle has been resolved for
+        property_ptr                m_property;
+        std::vector<upcast_type>    m_upcasts;  // from `m_type` to the class owning the property
+    };
+
     struct MIRROR_API class_info_base : name_type_info {
-        inline class_info_base(std::string n, std::type_info const& t) : name_type_info(std::move(n), t) { }
+        inline class_info_base(atom n, std::type_info const& t) : name_type_info(n, t), upcast(nullptr), m_version(0), m_members(nullptr), m_codec(nullptr) { }
 
         std::shared_ptr<class_info_base> base_class;
+        upcast_type upcast; ///< converts a pointer to this class to one to `base_class`; identity if null
+        void set_base_class(std::shared_ptr<class_info_base> base, upcast_type to_base = nullptr);
 
         std::vector<property_ptr> properties;
-        property_ptr find_property_by_name(std::string const& name, bool search_base = false) const;
+        property_ptr find_property_by_name(atom const& name, bool search_base = false) const;
+
+        /// String names are only looked up in the symbol table; a string
+        /// which has never been interned can not name a property.
+        inline property_ptr find_property_by_name(std::string const& name, bool search_base = false) const { atom a; return (atom::find(name, a) ? find_property_by_name(a, search_base) : nullptr); }
+        inline property_ptr find_property_by_name(char const* name, bool search_base = false)        const { atom a; return (atom::find(name, a) ? find_property_by_name(a, search_base) : nullptr); }
+
+        /// Resolves the (possibly inherited) property `name`; returns an
+        /// empty handle if there is none.
+        property_handle find_property(atom const& name) const;
+
+        /// Read/write the (possibly inherited) property `name` of the object
+        /// held by `obj`, which needs to be of this class' type.
+        value get(value const& obj, atom const& name) const;
+        void set(value const& obj, atom const& name, value const& v) const;
+
+        /// Reads the properties `names[0..n)` of the object held by `obj`
+        /// into `out[0..n)`.
+        void get(value const& obj, atom const* names, size_t n, value* out) const;
 
         std::vector<method_ptr> methods;
-        value invoke(context& ctx, value const& obj, std::string const& method, values const& args) const;
+
+        /// Invokes the (possibly inherited) method `method` with a matching
+        /// number of arguments on the object held by `obj`, which needs to be
+        /// of this class' type.
+        value invoke(context& ctx, value const& obj, atom const& method, values const& args) const;
+
+        /// Resolves the (possibly inherited) method `method` taking
+        /// `num_args` arguments; returns an empty handle if there is none.
+        method_handle find_method(atom const& method, size_t num_args) const;
+
+        /// Like `find_method(method, args.size)`, but picks the overload
+        /// best matching the kinds of `args`; see `member_table::resolve()`.
+        method_handle find_method(atom const& method, value_span args) const;
+
+        /// The flattened member table of this class; it gets computed on
+        /// first use and is rebuilt after this class or one of its base
+        /// classes has been modified via `set_base_class()`, `add_property()`,
+        /// or `add_method()`. Call `members_changed()` after modifying
+        /// `base_class`, `properties`, or `methods` directly. Safe to call
+        /// from multiple threads.
+        member_table const& members() const;
+        void members_changed();
+
+        /// Changes whenever a class gets modified whose member table is in
+        /// use; modifying a class nobody has looked at yet, e.g. while
+        /// building it, invalidates nothing.
+        static uint64_t members_epoch();
+
+        /// The codec for the objects of this class, with nested classes
+        /// resolved in `reg`; compiled on first use and cached until the
+        /// member table changes, a class gets registered in `reg`, or it is
+        /// used with another registry. Safe to call from multiple threads.
+        value_codec const& codec(class_registry const& reg) const;
+
+        /// Frees the superseded member tables and codecs of this class; must
+        /// not run concurrently with any other use of the class.
+        void reclaim();
 
         virtual std::string to_string(int indent = 0) const override;
 
     protected:
         void add_property_impl(property_ptr p);
         void add_method_impl(method_ptr m);
+
+    private:
+        bool up_to_date(member_table const& t) const;
+        member_table const& build_members() const;
+        void* check_object(value const& obj, atom const& member) const;
+        void* to_base(void* obj, size_t depth) const;
+        std::vector<upcast_type> upcasts(size_t depth) const;
+
+        std::atomic<uint64_t>                                   m_version;  // bumped by `members_changed()`
+        mutable std::atomic<member_table const*>                m_members;
+        mutable std::vector<std::unique_ptr<member_table>>      m_member_tables; // outdated tables stay alive for concurrent readers until `reclaim()`
+        mutable std::mutex                                      m_member_mutex;
+
+        value_codec const& build_codec(class_registry const& reg) const;
+
+        mutable std::atomic<value_codec const*>                 m_codec;
+        mutable std::vector<std::unique_ptr<value_codec const>> m_codecs;   // outdated codecs stay alive for concurrent readers until `reclaim()`
+        mutable std::mutex                                      m_codec_mutex;
     };
     typedef std::shared_ptr<class_info_base> class_base_ptr;
 
     template<typename T>
     struct class_info : class_info_base {
-        inline class_info(std::string n) : class_info_base(std::move(n), typeid(T)) { }
+        inline class_info(atom n) : class_info_base(n, typeid(T)) { }
 
         template<typename MEMBER>
-        inline void add_property(std::string name, MEMBER (T::*member)) {
-            add_property_impl(make_property<MEMBER>(std::move(name)));
+        inline void add_property(atom name, MEMBER (T::*member)) {
+            add_property_impl(make_property(name, member));
         }
 
-        template<typename RESULT>
-        void add_method(std::string name, RESULT (T::*method)()) {
-            add_method_impl(make_method(std::move(name), method));
+        /// Registers a method of any arity and qualification; an overloaded
+        /// method can be selected via `add_method<RESULT, ARGS...>()`.
+        template<typename METHOD>
+        void add_method(atom name, METHOD T::*method) {
+            static_assert(std::is_function<METHOD>::value, "mirror::class_info::add_method: not a member function");
+            add_method_impl(make_method(name, method));
         }
-        template<typename RESULT>
-        void add_method(std::string name, RESULT (T::*method)() const) {
-            add_method_impl(make_method(std::move(name), method));
-        }
-
-        template<typename RESULT, typename ARG1>
-        void add_method(std::string name, RESULT (T::*method)(ARG1)) {
-            add_method_impl(make_method(std::move(name), method));
-        }
-        template<typename RESULT, typename ARG1>
-        void add_method(std::string name, RESULT (T::*method)(ARG1) const) {
-            add_method_impl(make_method(std::move(name), method));
-        }
-
-        template<typename RESULT, typename ARG1, typename ARG2>
-        void add_method(std::string name, RESULT (T::*method)(ARG1, ARG2)) {
-            add_method_impl(make_method(std::move(name), method));
+        template<typename RESULT, typename... ARGS>
+        void add_method(atom name, RESULT (T::*method)(ARGS...)) {
+            add_method_impl(make_method(name, method));
         }
-        template<typename RESULT, typename ARG1, typename ARG2>
-        void add_method(std::string name, RESULT (T::*method)(ARG1, ARG2) const) {
-            add_method_impl(make_method(std::move(name), method));
+        template<typename RESULT, typename... ARGS>
+        void add_method(atom name, RESULT (T::*method)(ARGS...) const) {
+            add_method_impl(make_method(name, method));
         }
-
     };
 
     template<typename T>
-    inline std::shared_ptr<class_info<T>> make_class(std::string name, class_base_ptr base_class = nullptr) {
-        auto res = std::make_shared<class_info<T>>(std::move(name));
-        res->base_class = std::move(base_class);
+    inline std::shared_ptr<class_info<T>> make_class(atom name, class_base_ptr base_class = nullptr) {
+        auto res = std::make_shared<class_info<T>>(name);
+        if(base_class) { res->set_base_class(std::move(base_class)); }
         return res;
     }
 
+    /// With a typed base class the object pointers get properly adjusted
+    /// when invoking inherited methods.
+    template<typename T, typename BASE>
+    inline std::shared_ptr<class_info<T>> make_class(atom name, std::shared_ptr<class_info<BASE>> base_class) {
+        static_assert(std::is_base_of<BASE, T>::value, "mirror::make_class: not a base class");
+        auto res = std::make_shared<class_info<T>>(name);
+        if(base_class) { res->set_base_class(std::move(base_class), &detail::upcast<T, BASE>); }
+        return res;
+    }
+
+    /// Classes are indexed by name and by type (open addressing hash tables),
+    /// so lookups are O(1) and registering N classes is O(N) amortized.
+    /// `classes()` returns the classes in registration order.
+    ///
+    /// Classes can also be registered lazily via `add_lazy_class()`, with
+    /// just their name, type, and a builder function: the builder runs once,
+    /// on the first lookup of the class (or access via `classes()`), so
+    /// classes a process never uses cost no metadata.
+    ///
+    /// Lookups never lock and may run concurrently with `add_class()` from
+    /// any number of threads: writers serialize on a mutex, fill in immutable
+    /// entries and publish them with a single atomic store; a full index gets
+    /// copied into one twice the size, which is then published atomically.
+    /// Superseded indexes are retired, not freed, as readers might still
+    /// access them; `reclaim()` frees them (and the superseded member tables
+    /// and codecs of the registered classes) at a point where no other
+    /// thread uses the registry, otherwise the destructor does. Copying or assigning
+    /// a registry must not race with any other use of either registry.
+    /// Names given as strings (to `find_class_by_name()` or as the method of
+    /// `invoke()`) are resolved via the atom table, which is lock-free for
+    /// strings interned before; only a method name that has never been
+    /// interned locks once to intern it.
+    ///
+    /// Once all classes are registered the registry can be frozen: `freeze()`
+    /// replaces the indexes with minimal perfect hash tables that live in a
+    /// single contiguous block. Adding classes to a frozen registry throws
+    /// `std::logic_error`.
     struct MIRROR_API class_registry {
+        /// Creates the class info of the lazily registered class `name`.
+        typedef class_base_ptr (*builder_type)(atom const& name);
+
+    private:
+        // a registered class; lazy ones get built on first use
+        struct class_slot {
+            inline class_slot(atom n, std::type_info const& t, builder_type b) : name(n), type(t), builder(b), ready(false) { }
+
+            atom                    name;
+            std::type_info const&   type;
+            builder_type            builder;
+            std::atomic<bool>       ready;  // `cls` is set
+            std::once_flag          once;
+            class_base_ptr          cls;
+        };
+
+    public:
+        /// A consistent snapshot of the registered classes; accessing a lazy
+        /// class builds it.
+        struct class_list {
+            struct iterator {
+                typedef std::forward_iterator_tag   iterator_category;
+                typedef class_base_ptr              value_type;
+                typedef std::ptrdiff_t              difference_type;
+                typedef class_base_ptr const*       pointer;
+                typedef class_base_ptr const&       reference;
+
+                inline iterator(class_slot* const* s) : m_slot(s) { }
+                inline class_base_ptr const& operator*() const { return materialize(*m_slot); }
+                inline class_base_ptr const* operator->() const { return &materialize(*m_slot); }
+                inline iterator& operator++() { ++m_slot; return *this; }
+                inline bool operator==(iterator const& o) const { return (m_slot == o.m_slot); }
+                inline bool operator!=(iterator const& o) const { return (m_slot != o.m_slot); }
+
+            private:
+                class_slot* const* m_slot;
+            };
+
+            inline class_list(class_slot* const* d, size_t n) : m_data(d), m_size(n) { }
+
+            inline size_t size() const { return m_size; }
+            inline bool empty() const { return (m_size == 0); }
+            inline class_base_ptr const& operator[](size_t i) const { assert(i < m_size); return materialize(m_data[i]); }
+            inline iterator begin() const { return iterator(m_data); }
+            inline iterator end()   const { return iterator(m_data + m_size); }
+
+        private:
+            class_slot* const*  m_data;
+            size_t              m_size;
+        };
+
+        struct stats_type {
+            size_t classes;         ///< all registered classes
+            size_t lazy;            ///< registered via `add_lazy_class()`
+            size_t materialized;    ///< lazy classes built so far
+        };
+
+        class_registry();
+        class_registry(class_registry const& other);
+        class_registry& operator=(class_registry const& other);
+        ~class_registry();
+
         void add_class(class_base_ptr c);
 
-        class_base_ptr find_class_by_name(std::string const& name) const;
+        /// Registers the class `name` of type `type`; `builder` creates its
+        /// class info on first use, which needs to be of that name and type
+        /// (`std::logic_error` otherwise).
+        void add_lazy_class(atom name, std::type_info const& type, builder_type builder);
+
+        template<typename T>
+        inline void add_lazy_class(atom name, builder_type builder) { add_lazy_class(name, typeid(T), builder); }
+
+        class_list classes() const;
+        stats_type stats() const;
+
+        /// Changes whenever a class gets registered or the registry gets
+        /// assigned; unique across all registries, so equal generations
+        /// mean the same set of registered classes.
+        inline uint64_t generation() const { return m_generation.load(std::memory_order_acquire); }
+
+        void freeze();
+        inline bool frozen() const { return m_frozen.load(std::memory_order_acquire); }
+
+        /// Frees the indexes superseded by `add_class()` and `freeze()`, and
+        /// calls `class_info_base::reclaim()` for all built classes and their
+        /// base classes; must not run concurrently with any other use of the
+        /// registry (or of its classes).
+        void reclaim();
+
+        class_base_ptr find_class_by_name(atom const& name) const;
+        inline class_base_ptr find_class_by_name(std::string const& name) const { atom a; return (atom::find(name, a) ? find_class_by_name(a) : nullptr); } ///< does not intern `name`
+        inline class_base_ptr find_class_by_name(char const* name)        const { atom a; return (atom::find(name, a) ? find_class_by_name(a) : nullptr); } ///< does not intern `name`
 
         template<typename T>
         inline class_base_ptr find_class_by_type() const { return find_class_by_type(typeid(T)); }
         class_base_ptr find_class_by_type(std::type_info const& type) const;
 
-        value invoke(context& ctx, value const& obj, std::string const& method, values const& args) const;
+        /// Invokes `method` on the object held by `obj` via the class
+        /// registered for the object's type.
+        value invoke(context& ctx, value const& obj, atom const& method, values const& args) const;
+
+    private:
+        struct frozen_entry {
+            inline frozen_entry() : key(0), slot(nullptr) { }
+            inline frozen_entry(uint64_t k, class_slot* s) : key(k), slot(s) { }
+
+            uint64_t    key;    // the pilot value for the bucket entries
+            class_slot* slot;
+        };
+
+        struct frozen_table {
+            inline frozen_table() : pilot_offset(0), num_buckets(0), slot_offset(0), num_slots(0) { }
+
+            uint32_t pilot_offset;  // offset of the per bucket pilot entries in `m_frozen_block`
+            uint32_t num_buckets;
+            uint32_t slot_offset;   // offset of the slots in `m_frozen_block`
+            uint32_t num_slots;
+        };
+
+        // the classes in registration order; the first `size` are immutable
+        struct class_block {
+            explicit class_block(size_t cap);
+
+            size_t                          capacity;
+            std::atomic<size_t>             size;
+            std::unique_ptr<class_slot*[]>  items;
+        };
+
+        // linear probing on `frozen_entry` pointers, at most half full;
+        // published slots never change
+        struct live_index {
+            explicit live_index(size_t cap);
+
+            size_t                                              mask;
+            size_t                                              size;   // only accessed by writers
+            std::unique_ptr<std::atomic<frozen_entry const*>[]> slots;
+        };
+
+        // the class info of `s`, built on first use
+        static inline class_base_ptr const& materialize(class_slot* s) {
+            if(!s->ready.load(std::memory_order_acquire)) { build(s); }
+            return s->cls;
+        }
+        static void build(class_slot* s);
+
+        void reset();
+        void add_slot(class_base_ptr c, atom name, std::type_info const& type, builder_type builder);
+        void insert(std::atomic<live_index*>& index, frozen_entry const* e);
+
+        class_slot* find_live(live_index const* t, uint64_t key, std::type_info const* type) const;
+        class_slot* find_frozen(frozen_table const& t, uint64_t key) const;
+        class_slot* find_name(atom const& name) const;
+        class_slot* find_type(std::type_info const& type) const;
+
+        std::atomic<class_block*>   m_classes;
+        std::atomic<live_index*>    m_by_name;
+        std::atomic<live_index*>    m_by_type; // the first class registered for a type
+        std::atomic<bool>           m_frozen;
+        std::atomic<uint64_t>       m_generation;
+
+        // only written before `m_frozen` gets set
+        frozen_table                m_frozen_names;
+        frozen_table                m_frozen_types;
+        std::vector<frozen_entry>   m_frozen_block; // the pilots and slots of both tables
+
+        // owned by the writers
+        std::mutex                                  m_write_mutex;
+        std::vector<std::unique_ptr<class_slot>>    m_slots;
+        std::vector<std::unique_ptr<frozen_entry>>  m_entries;          // the entries of the live indexes
+        std::vector<std::unique_ptr<class_block>>   m_blocks;           // the current one last
+        std::vector<std::unique_ptr<live_index>>    m_indexes;          // including the current ones
+    };
+
+    /// Serializes the object held by `obj` into a dict of its properties via
+    /// the (cached) codec of the class registered for its type; throws
+    /// `std::runtime_error` if there is none.
+    MIRROR_API value to_value(class_registry const& reg, value const& obj);
+
+    /// The reverse of `to_value()`: assigns the properties of the object held
+    /// by `obj` from the dict `v`; see `value_codec::decode()`.
+    MIRROR_API void from_value(class_registry const& reg, value const& v, value const& obj);
+
+    /// Polymorphic inline cache for the dynamic dispatch done by
+    /// `class_registry::invoke()`; keep one per call site (and thread). The
+    /// resolved methods get cached keyed by the object's `type_info` pointer,
+    /// the method name, and the number of arguments, so only a cache miss
+    /// goes through the registry. Modifying a class in use flushes the cache.
+    /// A call site is meant to be used with a single registry.
+    struct MIRROR_API call_site {
+        static const size_t max_entries = 4;
+
+        inline call_site() : m_size(0), m_next(0), m_epoch(0), m_hits(0), m_misses(0) { }
+
+        inline value invoke(class_registry const& reg, context& ctx, value const& obj, atom const& method, value_span args) {
+            if(obj.is_ptr() && (m_epoch == class_info_base::members_epoch())) {
+                for(size_t i = 0; i < m_size; ++i) {
+                    auto const& e = m_entries[i];
+                    if((e.type == obj.m_type) && (e.method == method) && (e.num_args == args.size) &&
+                       (!e.overloaded || (e.signature == member_table::kind_signature(args)))) {
+                        ++m_hits;
+                        return e.handle.call(obj.m_obj.get(), args);
+                    }
+                }
+            }
+            return invoke_miss(reg, ctx, obj, method, args);
+        }
+
+        inline size_t size()   const { return m_size;   } ///< the number of cached methods
+        inline size_t hits()   const { return m_hits;   }
+        inline size_t misses() const { return m_misses; }
+        inline void reset_stats() { m_hits = 0; m_misses = 0; }
+
+    private:
+        value invoke_miss(class_registry const& reg, context& ctx, value const& obj, atom const& method, value_span args);
+
+        struct entry {
+            inline entry() : type(nullptr), num_args(0), overloaded(false), signature(0) { }
+
+            std::type_info const*   type;
+            atom                    method;
+            size_t                  num_args;
+            bool                    overloaded; // if so, the entry is only valid for the argument kinds `signature`
+            uint64_t                signature;
+            method_handle           handle;
+        };
 
-        std::vector<class_base_ptr> classes;
+        entry       m_entries[max_entries];
+        size_t      m_size;
+        size_t      m_next;     // the entry to replace next once the cache is full
+        uint64_t    m_epoch;    // `class_info_base::members_epoch()` the entries are valid for
+        size_t      m_hits;
+        size_t      m_misses;
     };
 
 
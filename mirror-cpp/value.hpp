@@ -24,58 +24,322 @@
 #pragma once
 
 #include "mirror-cpp.hpp"
+#include "arena.hpp"
+#include "atom.hpp"
+#include "flat_dict.hpp"
 
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <map>
 #include <memory>
+#include <ostream>
 #include <string>
+#include <typeinfo>
 #include <vector>
 
 namespace mirror {
 
+    /// One byte tag identifying the kind of payload stored in a `value`.
+    enum class value_kind : uint8_t {
+        null,
+        boolean,
+        integer,
+        floating,
+        string,
+        array,
+        dict,
+        object,
+        int_array,      ///< contiguous `int64_t` elements
+        double_array,   ///< contiguous `double` elements
+        bool_array,     ///< bit-packed `bool` elements
+        string_ref      ///< characters borrowed from an external buffer
+    };
+
+    /// Non-owning reference to a sequence of characters.
+    struct string_ref {
+        inline string_ref()                             : data(""),         size(0)         { }
+        inline string_ref(char const* d, size_t n)      : data(d ? d : ""), size(n)         { }
+        inline string_ref(char const* s)                : data(s ? s : ""), size(s ? std::char_traits<char>::length(s) : 0) { }
+        inline string_ref(std::string const& s)         : data(s.data()),   size(s.size())  { }
+
+        inline std::string str() const { return std::string(data, size); }
+
+        char const* data;
+        size_t      size;
+    };
+
+    inline bool operator==(string_ref const& lhs, string_ref const& rhs) { return ((lhs.size == rhs.size) && (std::memcmp(lhs.data, rhs.data, lhs.size) == 0)); }
+    inline bool operator!=(string_ref const& lhs, string_ref const& rhs) { return !(lhs == rhs); }
+
+    inline std::ostream& operator<<(std::ostream& os, string_ref const& s) { return os.write(s.data, static_cast<std::streamsize>(s.size)); }
+
+    /// String keyed lookups in a dict only query the symbol table; they do
+    /// not intern (and so permanently keep) keys which are not present.
+    template<>
+    struct flat_dict_key<atom> {
+        static inline bool find(atom const& key, atom& result)          { result = key; return true;   }
+        static inline bool find(std::string const& key, atom& result)   { return atom::find(key, result); }
+        static inline bool find(char const* key, atom& result)          { return atom::find(key, result); }
+    };
+
     struct value {
-        typedef std::vector<value>              array_t;
-        typedef std::map<std::string, value>    dict_t;
+        typedef std::vector<value, arena_allocator<value>>                                                  array_t;
+#if defined(MIRROR_CPP_DICT_STD_MAP)
+        typedef std::map<atom, value, std::less<atom>, arena_allocator<std::pair<atom const, value>>>       dict_t;
+#else // defined(MIRROR_CPP_DICT_STD_MAP)
+        typedef flat_dict<atom, value, std::hash<atom>, std::less<atom>, arena_allocator<std::pair<atom, value>>> dict_t; // sorted vector, hash indexed for large dicts
+#endif // defined(MIRROR_CPP_DICT_STD_MAP)
 
-        inline          value()                     : m_obj(),                                                  m_type(&typeid(nullptr))                            { }
-        inline explicit value(std::nullptr_t)       : m_obj(),                                                  m_type(&typeid(nullptr))                            { }
-        inline explicit value(bool v)               : m_obj(std::make_shared<bool>(v)),                         m_type(&typeid(bool))                               { }
-        inline explicit value(int64_t v)            : m_obj(std::make_shared<int64_t>(v)),                      m_type(&typeid(int64_t))                            { }
-        inline explicit value(double v)             : m_obj(std::make_shared<double>(v)),                       m_type(&typeid(double))                             { }
-        inline explicit value(char const* v)        : m_obj(v ? std::make_shared<std::string>(v) : nullptr),    m_type(v ? &typeid(std::string) : &typeid(nullptr)) { }
-        inline explicit value(std::string v)        : m_obj(std::make_shared<std::string>(std::move(v))),       m_type(&typeid(std::string))                        { }
+        typedef std::vector<int64_t, arena_allocator<int64_t>>  int_array_t;
+        typedef std::vector<double,  arena_allocator<double>>   double_array_t;
+        typedef std::vector<bool,    arena_allocator<bool>>     bool_array_t;
 
+        inline          value()                     : m_obj(),                                                  m_type(&typeid(nullptr)),                               m_kind(value_kind::null)                                { m_scalar.i = 0; }
+        inline explicit value(std::nullptr_t)       : m_obj(),                                                  m_type(&typeid(nullptr)),                               m_kind(value_kind::null)                                { m_scalar.i = 0; }
+        inline explicit value(bool v)               : m_obj(),                                                  m_type(&typeid(bool)),                                  m_kind(value_kind::boolean)                             { m_scalar.i = 0; m_scalar.b = v; }
+        inline explicit value(int64_t v)            : m_obj(),                                                  m_type(&typeid(int64_t)),                               m_kind(value_kind::integer)                             { m_scalar.i = v; }
+        inline explicit value(double v)             : m_obj(),                                                  m_type(&typeid(double)),                                m_kind(value_kind::floating)                            { m_scalar.d = v; }
+        inline explicit value(char const* v,   value_arena* arena = nullptr) : m_type(&typeid(nullptr)), m_kind(value_kind::null) { m_scalar.i = 0; if(v) { set_string(v, std::char_traits<char>::length(v), arena); } }
+        inline explicit value(std::string v,   value_arena* arena = nullptr) : m_type(&typeid(nullptr)), m_kind(value_kind::null) { m_scalar.i = 0; if(arena) { set_string(v.data(), v.size(), arena); } else { set_string(std::move(v)); } }
+
+        /// Object pointers record the type of the pointee (`typeid(T)`) in
+        /// `m_type`; it is only used for object lookups and never for dispatch.
         template<typename T>
-        inline explicit value(std::shared_ptr<T> v) : m_obj(std::move(v)) { m_type = (m_obj ? &typeid(T*) : nullptr); }
-
-        inline static value array() { value res; res.m_obj = std::make_shared<array_t>();   res.m_type = &typeid(array_t);  return res; }
-        inline static value dict()  { value res; res.m_obj = std::make_shared<dict_t>();    res.m_type = &typeid(dict_t);   return res; }
-
-        inline bool is_null()       const { return (m_obj  == nullptr);                                                                                     }
-        inline bool is_bool()       const { return (m_type == &typeid(bool));                                                                               }
-        inline bool is_int()        const { return (m_type == &typeid(int64_t));                                                                            }
-        inline bool is_double()     const { return (m_type == &typeid(double));                                                                             }
-        inline bool is_string()     const { return (m_type == &typeid(std::string));                                                                        }
-        inline bool is_array()      const { return (m_type == &typeid(array_t));                                                                            }
-        inline bool is_dict()       const { return (m_type == &typeid(dict_t));                                                                             }
-        inline bool is_ptr()        const { return (!is_null() && !is_bool() && !is_int() && !is_double() && !is_string() && !is_array() && !is_dict());    }
+        inline explicit value(std::shared_ptr<T> v) : m_obj(std::move(v)) {
+            m_type = (m_obj ? &typeid(T) : &typeid(nullptr));
+            m_kind = (m_obj ? value_kind::object : value_kind::null);
+            m_scalar.i = 0;
+        }
+
+        /// Strings, arrays and dicts are allocated from `arena` if given
+        /// (including the element storage of an arena backed array or dict);
+        /// otherwise the global heap is used. A string created with an arena
+        /// keeps its characters in the arena and is a `string_ref` (see
+        /// `is_string_ref()`), so it is neither reference counted nor freed.
+        inline static value array(value_arena* arena = nullptr) {
+            auto alloc = arena_allocator<array_t>(arena);
+            value res; res.m_obj = std::allocate_shared<array_t>(alloc, alloc); res.m_type = &typeid(array_t); res.m_kind = value_kind::array; return res;
+        }
+        inline static value dict(value_arena* arena = nullptr) {
+            auto alloc = arena_allocator<dict_t>(arena);
+            value res; res.m_obj = std::allocate_shared<dict_t>(alloc, alloc);  res.m_type = &typeid(dict_t);  res.m_kind = value_kind::dict;  return res;
+        }
+
+        /// Typed (homogeneous) arrays store their elements contiguously; they
+        /// get promoted to a generic `array_t` by `as_array()` or when an
+        /// element of a different kind gets added via `push_back()`.
+        inline static value int_array(value_arena* arena = nullptr)     { return make_typed_array<int_array_t>(   arena, value_kind::int_array);     }
+        inline static value double_array(value_arena* arena = nullptr)  { return make_typed_array<double_array_t>(arena, value_kind::double_array);  }
+        inline static value bool_array(value_arena* arena = nullptr)    { return make_typed_array<bool_array_t>(  arena, value_kind::bool_array);    }
+
+        /// Refers to the `n` characters at `s` without copying them; `owner`
+        /// (if given) is kept alive as long as the value (or a copy) exists,
+        /// otherwise the caller has to keep the characters alive.
+        inline static value borrow_string(char const* s, size_t n, std::shared_ptr<void> owner = nullptr) {
+            value res; res.m_obj = std::shared_ptr<void>(std::move(owner), const_cast<char*>(s)); res.m_type = &typeid(string_ref); res.m_kind = value_kind::string_ref; res.m_scalar.i = static_cast<int64_t>(n); return res;
+        }
+
+        /// Copies the `n` characters at `s` into `arena` (see above), or into
+        /// an owned string if no arena is given.
+        inline static value copy_string(char const* s, size_t n, value_arena* arena = nullptr) {
+            value res; res.set_string(s, n, arena); return res;
+        }
+
+        inline value_kind kind()    const { return m_kind;                          }
+
+        inline bool is_null()       const { return (m_kind == value_kind::null);     }
+        inline bool is_bool()       const { return (m_kind == value_kind::boolean);  }
+        inline bool is_int()        const { return (m_kind == value_kind::integer);  }
+        inline bool is_double()     const { return (m_kind == value_kind::floating); }
+        inline bool is_string()     const { return (m_kind == value_kind::string);   }
+        inline bool is_array()      const { return (m_kind == value_kind::array);    }
+        inline bool is_dict()       const { return (m_kind == value_kind::dict);     }
+        inline bool is_ptr()        const { return (m_kind == value_kind::object);   }
+        inline bool is_int_array()      const { return (m_kind == value_kind::int_array);     }
+        inline bool is_double_array()   const { return (m_kind == value_kind::double_array);  }
+        inline bool is_bool_array()     const { return (m_kind == value_kind::bool_array);    }
+        inline bool is_typed_array()    const { return (is_int_array() || is_double_array() || is_bool_array()); }
+        inline bool is_any_array()      const { return (is_array() || is_typed_array()); }
+        inline bool is_string_ref()     const { return (m_kind == value_kind::string_ref);    }
+        inline bool is_any_string()     const { return (is_string() || is_string_ref()); }
         template<typename T>
-        inline bool is_ptr_type()   const { return (as_ptr<T>() != nullptr);                                                                                }
+        inline bool is_ptr_type()   const { return (is_ptr() && ((m_type == &typeid(T)) || (*m_type == typeid(T)))); }
+
+        inline bool                 as_bool()   const { return (is_bool()   ? m_scalar.b : false);                                                      }
+        inline int64_t              as_int()    const { return (is_int()    ? m_scalar.i : 0);                                                          }
+        inline double               as_double() const { return (is_double() ? m_scalar.d : 0.0);                                                        }
+        inline std::string const&   as_string() const { if(is_string()) { return *static_cast<std::string*>(m_obj.get()); } static const std::string s; return s; }
+
+        /// Characters of an owned or a borrowed string; empty otherwise.
+        inline string_ref as_string_ref() const {
+            if(is_string())     { return string_ref(*static_cast<std::string*>(m_obj.get())); }
+            if(is_string_ref()) { return string_ref(static_cast<char const*>(m_obj.get()), static_cast<size_t>(m_scalar.i)); }
+            return string_ref();
+        }
 
-        inline array_t& as_array() { assert(is_null() || is_array()); if(is_null()) { m_obj = std::make_shared<array_t>(); m_type = &typeid(array_t); } return *std::static_pointer_cast<array_t>(m_obj); }
-        inline dict_t&  as_dict()  { assert(is_null() || is_dict());  if(is_null()) { m_obj = std::make_shared<dict_t>();  m_type = &typeid(dict_t);  } return *std::static_pointer_cast<dict_t>( m_obj); }
+        inline array_t& as_array() { assert(is_null() || is_any_array()); if(is_null()) { *this = array(); } else if(is_typed_array()) { promote_to_array(); } return *static_cast<array_t*>(m_obj.get()); }
+        inline dict_t&  as_dict()  { assert(is_null() || is_dict());  if(is_null()) { *this = dict();  } return *static_cast<dict_t*>(m_obj.get()); }
 
-        inline array_t const& as_array() const { if(!is_null() && is_array()) { return *std::static_pointer_cast<array_t>(m_obj); } static const array_t a; return a; }
-        inline dict_t  const& as_dict()  const { if(!is_null() && is_dict())  { return *std::static_pointer_cast<dict_t>( m_obj); } static const dict_t  d; return d; }
+        /// The const accessors can not promote a typed array and must not be
+        /// used with one (checked by an assertion); callers need to check
+        /// `is_typed_array()` first and use the typed accessors, or `size()`
+        /// and `at()` which work for arrays of any kind. All other kinds
+        /// yield an empty array (dict).
+        inline array_t const& as_array() const { assert(!is_typed_array()); if(is_array()) { return *static_cast<array_t*>(m_obj.get()); } static const array_t a; return a; }
+        inline dict_t  const& as_dict()  const { if(is_dict())  { return *static_cast<dict_t*>(m_obj.get()); } static const dict_t  d; return d; }
+
+        inline int_array_t&     as_int_array()      { assert(is_null() || is_int_array());    if(is_null()) { *this = int_array();    } return *static_cast<int_array_t*>(m_obj.get());     }
+        inline double_array_t&  as_double_array()   { assert(is_null() || is_double_array()); if(is_null()) { *this = double_array(); } return *static_cast<double_array_t*>(m_obj.get());  }
+        inline bool_array_t&    as_bool_array()     { assert(is_null() || is_bool_array());   if(is_null()) { *this = bool_array();   } return *static_cast<bool_array_t*>(m_obj.get());    }
+
+        inline int_array_t    const& as_int_array()     const { if(is_int_array())    { return *static_cast<int_array_t*>(m_obj.get());    } static const int_array_t    a; return a; }
+        inline double_array_t const& as_double_array()  const { if(is_double_array()) { return *static_cast<double_array_t*>(m_obj.get()); } static const double_array_t a; return a; }
+        inline bool_array_t   const& as_bool_array()    const { if(is_bool_array())   { return *static_cast<bool_array_t*>(m_obj.get());   } static const bool_array_t   a; return a; }
+
+        /// Number of elements of an array (of any kind) or dict; 0 otherwise.
+        inline size_t size() const;
+
+        /// Returns a copy of the element `i` of an array of any kind.
+        inline value at(size_t i) const;
+
+        /// Appends `v` to an array of any kind; a null value becomes a generic
+        /// array first. A typed array gets promoted to a generic array if the
+        /// kind of `v` does not match its element type. Note: promotion
+        /// replaces the payload of this value only; other values sharing the
+        /// typed array keep referring to it.
+        inline void push_back(value v);
 
         template<typename T>
-        inline std::shared_ptr<T> as_ptr() const { return ((m_type == &typeid(T*)) ? std::static_pointer_cast<T>(m_obj) : nullptr); }
+        inline std::shared_ptr<T> as_ptr() const { return (is_ptr_type<T>() ? std::static_pointer_cast<T>(m_obj) : nullptr); }
+
+        /// Calls `vis` with the payload of this value and returns its result;
+        /// the visitor needs to provide overloads for `std::nullptr_t`, `bool`,
+        /// `int64_t`, `double`, `std::string const&`, `array_t const&`,
+        /// `dict_t const&`, `int_array_t const&`, `double_array_t const&`,
+        /// `bool_array_t const&`, `string_ref`, and `(std::shared_ptr<void> const&, std::type_info const&)`.
+        template<typename VISITOR>
+        inline auto visit(VISITOR&& vis) const -> decltype(vis(nullptr)) {
+            switch(m_kind) {
+                case value_kind::boolean:   return vis(m_scalar.b);
+                case value_kind::integer:   return vis(m_scalar.i);
+                case value_kind::floating:  return vis(m_scalar.d);
+                case value_kind::string:    return vis(*static_cast<std::string const*>(m_obj.get()));
+                case value_kind::array:     return vis(*static_cast<array_t const*>(m_obj.get()));
+                case value_kind::dict:      return vis(*static_cast<dict_t const*>(m_obj.get()));
+                case value_kind::object:    return vis(m_obj, *m_type);
+                case value_kind::int_array:     return vis(*static_cast<int_array_t const*>(m_obj.get()));
+                case value_kind::double_array:  return vis(*static_cast<double_array_t const*>(m_obj.get()));
+                case value_kind::bool_array:    return vis(*static_cast<bool_array_t const*>(m_obj.get()));
+                case value_kind::string_ref:    return vis(as_string_ref());
+                case value_kind::null:      break;
+            }
+            return vis(nullptr);
+        }
 
 //    private:
+        inline void set_string(std::string v) {
+            m_obj  = std::make_shared<std::string>(std::move(v));
+            m_type = &typeid(std::string);
+            m_kind = value_kind::string;
+        }
+
+        inline void set_string(char const* s, size_t n, value_arena* arena) {
+            if(!arena) { set_string(std::string(s, n)); return; }
+            auto chars = static_cast<char*>(arena->allocate(n, 1));
+            std::memcpy(chars, s, n);
+            *this = borrow_string(chars, n);
+        }
+
+        template<typename ARRAY>
+        inline static value make_typed_array(value_arena* arena, value_kind kind) {
+            auto alloc = arena_allocator<ARRAY>(arena);
+            value res; res.m_obj = std::allocate_shared<ARRAY>(alloc, alloc); res.m_type = &typeid(ARRAY); res.m_kind = kind; return res;
+        }
+
+        template<typename ARRAY>
+        inline static std::shared_ptr<array_t> to_generic_array(ARRAY const& typed) {
+            auto alloc = arena_allocator<array_t>(typed.get_allocator().arena());
+            auto res = std::allocate_shared<array_t>(alloc, alloc);
+            res->reserve(typed.size() + 1);
+            for(auto&& e : typed) { res->emplace_back(static_cast<typename ARRAY::value_type>(e)); }
+            return res;
+        }
+
+        inline void promote_to_array() {
+            switch(m_kind) {
+                case value_kind::int_array:     m_obj = to_generic_array(*static_cast<int_array_t const*>(m_obj.get()));     break;
+                case value_kind::double_array:  m_obj = to_generic_array(*static_cast<double_array_t const*>(m_obj.get()));  break;
+                case value_kind::bool_array:    m_obj = to_generic_array(*static_cast<bool_array_t const*>(m_obj.get()));    break;
+                default:                        assert(false); return;
+            }
+            m_type = &typeid(array_t);
+            m_kind = value_kind::array;
+        }
+
+        // null, bool, int64 and double are stored inline in `m_scalar`;
+        // only strings, arrays, dicts and object pointers live on the heap
+        union scalar_t {
+            bool    b;
+            int64_t i;
+            double  d;
+        };
+
         std::shared_ptr<void> m_obj;
         std::type_info const* m_type; // no owning pointer
+        scalar_t              m_scalar;
+        value_kind            m_kind;
     };
 
     typedef std::vector<value> values;
 
+    /// Non-owning view of a contiguous sequence of values, e.g. the
+    /// arguments of a call; constructible from `values` or a C array.
+    struct value_span {
+        inline value_span()                                 : data(nullptr),    size(0)         { }
+        inline value_span(value const* d, size_t n)         : data(d),          size(n)         { }
+        inline value_span(values const& v)                  : data(v.data()),   size(v.size())  { }
+        template<size_t N>
+        inline value_span(value const (&v)[N])              : data(v),          size(N)         { }
+
+        inline value const& operator[](size_t i) const { assert(i < size); return data[i]; }
+        inline value const* begin() const { return data; }
+        inline value const* end()   const { return (data + size); }
+
+        value const*    data;
+        size_t          size;
+    };
+
+    inline size_t value::size() const {
+        switch(m_kind) {
+            case value_kind::array:         return static_cast<array_t const*>(m_obj.get())->size();
+            case value_kind::dict:          return static_cast<dict_t const*>(m_obj.get())->size();
+            case value_kind::int_array:     return static_cast<int_array_t const*>(m_obj.get())->size();
+            case value_kind::double_array:  return static_cast<double_array_t const*>(m_obj.get())->size();
+            case value_kind::bool_array:    return static_cast<bool_array_t const*>(m_obj.get())->size();
+            default:                        return 0;
+        }
+    }
+
+    inline value value::at(size_t i) const {
+        assert(i < size());
+        switch(m_kind) {
+            case value_kind::array:         return (*static_cast<array_t const*>(m_obj.get()))[i];
+            case value_kind::int_array:     return value((*static_cast<int_array_t const*>(m_obj.get()))[i]);
+            case value_kind::double_array:  return value((*static_cast<double_array_t const*>(m_obj.get()))[i]);
+            case value_kind::bool_array:    return value(static_cast<bool>((*static_cast<bool_array_t const*>(m_obj.get()))[i]));
+            default:                        assert(false); return value();
+        }
+    }
+
+    inline void value::push_back(value v) {
+        switch(m_kind) {
+            case value_kind::int_array:     if(v.is_int())    { static_cast<int_array_t*>(m_obj.get())->push_back(v.m_scalar.i);    return; } break;
+            case value_kind::double_array:  if(v.is_double()) { static_cast<double_array_t*>(m_obj.get())->push_back(v.m_scalar.d); return; } break;
+            case value_kind::bool_array:    if(v.is_bool())   { static_cast<bool_array_t*>(m_obj.get())->push_back(v.m_scalar.b);   return; } break;
+            default:                        break;
+        }
+        as_array().emplace_back(std::move(v));
+    }
+
 } // namespace mirror
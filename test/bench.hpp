@@ -0,0 +1,98 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// a minimal benchmark harness: benchmarks register themselves via the
+// BENCHMARK() macro and get run by `mirror_benchmarks [name filter]`
+namespace bench {
+
+    typedef void (*bench_func)();
+
+    struct entry {
+        char const* name;
+        bench_func  func;
+    };
+
+    inline std::vector<entry>& registry() {
+        static std::vector<entry> r;
+        return r;
+    }
+
+    struct registrar {
+        inline registrar(char const* name, bench_func func) { registry().push_back(entry{ name, func }); }
+    };
+
+    /// Runs `func` `iterations` times per round and returns the best time
+    /// per iteration in seconds over `rounds` rounds.
+    template<typename FUNC>
+    inline double measure(FUNC&& func, size_t iterations, size_t rounds = 5) {
+        auto best = 1e300;
+        for(size_t r = 0; r < rounds; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            for(size_t i = 0; i < iterations; ++i) { func(); }
+            auto stop = std::chrono::steady_clock::now();
+            auto secs = std::chrono::duration<double>(stop - start).count() / static_cast<double>(iterations);
+            best = std::min(best, secs);
+        }
+        return best;
+    }
+
+    /// Prints the throughput for processing `bytes` in `secs`.
+    inline void report_throughput(char const* what, double secs, size_t bytes) {
+        std::printf("  %-40s %10.3f ms %10.1f MB/s\n", what, secs * 1e3, static_cast<double>(bytes) / secs / 1e6);
+    }
+
+    /// Prints the time per operation for `ops` operations done in `secs`.
+    inline void report_ops(char const* what, double secs, size_t ops) {
+        std::printf("  %-40s %10.2f ns/op\n", what, secs * 1e9 / static_cast<double>(ops));
+    }
+
+    inline char volatile& sink() {
+        static volatile char s;
+        return s;
+    }
+
+    /// Keeps the compiler from optimizing away a computed result.
+    template<typename T>
+    inline void do_not_optimize(T const& v) {
+#if defined(__GNUC__)
+        // the (empty) asm may read all of `v` through its address
+        asm volatile("" : : "g"(&v) : "memory");
+#else // defined(__GNUC__)
+        sink() = *reinterpret_cast<char const volatile*>(&v);
+#endif // defined(__GNUC__)
+    }
+
+} // namespace bench
+
+#define BENCHMARK(NAME)                                         \
+    static void NAME();                                         \
+    static bench::registrar NAME##_registrar(#NAME, NAME);      \
+    static void NAME()
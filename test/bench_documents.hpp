@@ -0,0 +1,59 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <mirror-cpp/value.hpp>
+
+#include <string>
+
+// documents shared by the benchmarks
+namespace bench {
+
+    // an array of records with several (partially escaped) text fields
+    inline mirror::value make_string_document(size_t records) {
+        auto doc = mirror::value::array();
+        doc.as_array().reserve(records);
+        for(size_t i = 0; i < records; ++i) {
+            auto rec = mirror::value::dict();
+            auto& d = rec.as_dict();
+            d["id"]      = mirror::value(static_cast<int64_t>(i));
+            d["name"]    = mirror::value("record number " + std::to_string(i));
+            d["text"]    = mirror::value(std::string(200, 'a' + (i % 26)) + " and some \"quoted\" text\n");
+            d["comment"] = mirror::value(std::string(500, 'z'));
+            d["score"]   = mirror::value(static_cast<double>(i) / 7.0);
+            doc.as_array().push_back(std::move(rec));
+        }
+        return doc;
+    }
+
+    inline mirror::value make_number_document(size_t count) {
+        auto doc = mirror::value::array();
+        for(size_t i = 0; i < count; ++i) {
+            doc.push_back(mirror::value(static_cast<int64_t>(i * 7919)));
+            doc.push_back(mirror::value(static_cast<double>(i) * 0.001));
+        }
+        return doc;
+    }
+
+} // namespace bench
@@ -0,0 +1,100 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "bench.hpp"
+#include "bench_documents.hpp"
+
+#include <mirror-cpp/binary.hpp>
+#include <mirror-cpp/json.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+    void compare(char const* name, mirror::value const& doc) {
+        auto json = mirror::to_json(doc);
+        auto bin  = mirror::to_binary(doc);
+        std::printf("  %s: %zu bytes JSON, %zu bytes binary (%.1f%%)\n", name, json.size(), bin.size(), 100.0 * static_cast<double>(bin.size()) / static_cast<double>(json.size()));
+
+        std::string buf;
+        auto secs = bench::measure([&]() { buf.clear(); mirror::to_json(doc, buf); }, 5);
+        bench::report_throughput("write JSON", secs, json.size());
+        secs = bench::measure([&]() { buf.clear(); mirror::to_binary(doc, buf); }, 5);
+        bench::report_throughput("write binary", secs, bin.size());
+
+        secs = bench::measure([&]() { bench::do_not_optimize(mirror::parse_json(json)); }, 3);
+        bench::report_throughput("parse JSON", secs, json.size());
+        secs = bench::measure([&]() { bench::do_not_optimize(mirror::from_binary(bin)); }, 3);
+        bench::report_throughput("decode binary", secs, bin.size());
+        secs = bench::measure([&]() { bench::do_not_optimize(mirror::from_binary(bin, mirror::binary_strings::borrow)); }, 3);
+        bench::report_throughput("decode binary, borrowed strings", secs, bin.size());
+    }
+
+} // namespace
+
+BENCHMARK(binary_vs_json) {
+    compare("string heavy document", bench::make_string_document(20000));
+    compare("number heavy document", bench::make_number_document(200000));
+}
+
+BENCHMARK(value_view) {
+    auto doc = mirror::value::dict();
+    for(size_t i = 0; i < 100000; ++i) {
+        auto rec = mirror::value::dict();
+        rec.as_dict()["id"]    = mirror::value(static_cast<int64_t>(i));
+        rec.as_dict()["name"]  = mirror::value("record number " + std::to_string(i));
+        rec.as_dict()["score"] = mirror::value(static_cast<double>(i) / 7.0);
+        doc.as_dict()["key_" + std::to_string(i)] = std::move(rec);
+    }
+    auto compact = mirror::to_binary(doc);
+    auto indexed = mirror::to_binary(doc, mirror::binary_layout::indexed);
+    std::printf("  %zu bytes compact, %zu bytes indexed\n", compact.size(), indexed.size());
+
+    std::vector<std::string> keys;
+    for(size_t i = 0; i < 1000; ++i) { keys.push_back("key_" + std::to_string((i * 7919) % 100000)); }
+
+    auto secs = bench::measure([&]() {
+        auto v = mirror::from_binary(indexed, mirror::binary_strings::borrow);
+        int64_t sum = 0;
+        for(auto&& k : keys) { sum += v.as_dict().at(k).as_dict().at("id").as_int(); }
+        bench::do_not_optimize(sum);
+    }, 3);
+    bench::report_ops("decode + 1000 lookups", secs, 1);
+
+    secs = bench::measure([&]() {
+        auto v = mirror::value_view::document(indexed.data(), indexed.size());
+        int64_t sum = 0;
+        for(auto&& k : keys) { sum += v[k]["id"].as_int(); }
+        bench::do_not_optimize(sum);
+    }, 3);
+    bench::report_ops("view (indexed) + 1000 lookups", secs, 1);
+
+    secs = bench::measure([&]() {
+        auto v = mirror::value_view::document(compact.data(), compact.size());
+        int64_t sum = 0;
+        for(size_t i = 0; i < 10; ++i) { sum += v[keys[i]]["id"].as_int(); }
+        bench::do_not_optimize(sum);
+    }, 3);
+    bench::report_ops("view (compact) + 10 lookups", secs, 1);
+}
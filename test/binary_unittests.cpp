@@ -0,0 +1,324 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <cute/cute.hpp>
+
+#include <mirror-cpp/binary.hpp>
+#include <mirror-cpp/json.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+    mirror::value make_document() {
+        auto root = mirror::value::dict();
+        auto& d = root.as_dict();
+        d["null"]    = mirror::value();
+        d["true"]    = mirror::value(true);
+        d["false"]   = mirror::value(false);
+        d["ints"]    = mirror::value::int_array();
+        d["ints"].as_int_array().assign({ 0, 1, -1, 63, -64, 64, INT64_MAX, INT64_MIN });
+        d["doubles"] = mirror::value::double_array();
+        d["doubles"].as_double_array().assign({ 0.5, -1e300, 3.14159 });
+        d["bools"]   = mirror::value::bool_array();
+        for(int i = 0; i < 19; ++i) { d["bools"].push_back(mirror::value(i % 3 == 0)); }
+        d["text"]    = mirror::value("gr\xC3\xBC\xC3\x9F \"quoted\"\n");
+        d["empty"]   = mirror::value("");
+        d["list"]    = mirror::value::array();
+        d["list"].push_back(mirror::value(static_cast<int64_t>(300)));
+        d["list"].push_back(mirror::value(-2.5));
+        d["list"].push_back(mirror::value::dict());
+        d["list"].push_back(mirror::value::array());
+        d["list"].push_back(mirror::value(std::string(200, 'x')));
+        return root;
+    }
+
+} // namespace
+
+CUTE_TEST(
+    "Test binary encoding of scalar values",
+    "[binary]"
+) {
+    // header + tag (+ payload)
+    CUTE_ASSERT(mirror::to_binary(mirror::value()) == std::string("MRB\x01\x00", 5));
+    CUTE_ASSERT(mirror::to_binary(mirror::value(true)) == std::string("MRB\x01\x02", 5));
+    CUTE_ASSERT(mirror::to_binary(mirror::value(static_cast<int64_t>(-1))) == std::string("MRB\x01\x03\x01", 6));
+    CUTE_ASSERT(mirror::to_binary(mirror::value(static_cast<int64_t>(64))) == std::string("MRB\x01\x03\x80\x01", 7));
+    CUTE_ASSERT(mirror::to_binary(mirror::value("ab")) == std::string("MRB\x01\x05\x02" "ab", 8));
+    CUTE_ASSERT(mirror::binary_size(mirror::value(1.0)) == 4 + 1 + 8);
+
+    int64_t const ints[] = { 0, 1, -1, 127, 128, -129, 1ll << 40, INT64_MAX, INT64_MIN };
+    for(auto i : ints) {
+        auto enc = mirror::to_binary(mirror::value(i));
+        CUTE_ASSERT(enc.size() == mirror::binary_size(mirror::value(i)));
+        CUTE_ASSERT(mirror::from_binary(enc).as_int() == i, CUTE_CAPTURE(i));
+    }
+
+    double const doubles[] = { 0.0, -0.0, 1.5, -1e-300, std::numeric_limits<double>::infinity(), std::numeric_limits<double>::denorm_min() };
+    for(auto d : doubles) {
+        auto dec = mirror::from_binary(mirror::to_binary(mirror::value(d))).as_double();
+        CUTE_ASSERT(dec == d, CUTE_CAPTURE(d));
+        CUTE_ASSERT(std::signbit(dec) == std::signbit(d));
+    }
+    CUTE_ASSERT(std::isnan(mirror::from_binary(mirror::to_binary(mirror::value(std::nan("")))).as_double()));
+
+    CUTE_ASSERT_THROWS(mirror::to_binary(mirror::value(std::make_shared<int>(1))));
+}
+
+CUTE_TEST(
+    "Test binary round trip of nested values",
+    "[binary]"
+) {
+    auto doc = make_document();
+    auto enc = mirror::to_binary(doc);
+    CUTE_ASSERT(enc.size() == mirror::binary_size(doc));
+
+    auto dec = mirror::from_binary(enc);
+    CUTE_ASSERT(dec.is_dict());
+    CUTE_ASSERT(dec.as_dict().at("ints").is_int_array());
+    CUTE_ASSERT(dec.as_dict().at("doubles").is_double_array());
+    CUTE_ASSERT(dec.as_dict().at("bools").is_bool_array());
+    CUTE_ASSERT(dec.as_dict().at("bools").size() == 19);
+    CUTE_ASSERT(mirror::to_json(dec) == mirror::to_json(doc));
+
+    // appending to a buffer
+    auto buf = std::string("xy");
+    mirror::to_binary(doc, buf);
+    CUTE_ASSERT(buf == "xy" + enc);
+
+    // decoding into an arena
+    mirror::value_arena arena(4096);
+    {
+        auto a = mirror::from_binary(enc, mirror::binary_strings::copy, &arena);
+        CUTE_ASSERT(arena.bytes_reserved() > 0);
+        CUTE_ASSERT(mirror::to_json(a) == mirror::to_json(doc));
+    }
+
+    // JSON and binary agree on parsed documents
+    auto json = std::string("{\"a\":[1,2.5,\"x\",null,true,{\"b\":[]}],\"c\":-7}");
+    CUTE_ASSERT(mirror::to_json(mirror::from_binary(mirror::to_binary(mirror::parse_json(json)))) == mirror::to_json(mirror::parse_json(json)));
+}
+
+CUTE_TEST(
+    "Test binary decoding with borrowed strings",
+    "[binary],[string_ref]"
+) {
+    auto doc = make_document();
+    auto enc = mirror::to_binary(doc);
+
+    auto dec = mirror::from_binary(enc, mirror::binary_strings::borrow);
+    auto&& text = dec.as_dict().at("text");
+    CUTE_ASSERT(text.is_string_ref());
+    CUTE_ASSERT(!text.is_string());
+    CUTE_ASSERT(text.is_any_string());
+    CUTE_ASSERT(text.as_string_ref().str() == doc.as_dict().at("text").as_string());
+    CUTE_ASSERT(text.as_string_ref().data >= enc.data());
+    CUTE_ASSERT(text.as_string_ref().data < enc.data() + enc.size());
+    CUTE_ASSERT(dec.as_dict().at("empty").as_string_ref().size == 0);
+
+    // borrowed strings are written like owned ones
+    CUTE_ASSERT(mirror::to_json(dec) == mirror::to_json(doc));
+    CUTE_ASSERT(mirror::to_binary(dec) == enc);
+
+    // an owner keeps the characters alive
+    auto owner = std::make_shared<std::string>("owned characters");
+    auto ref = mirror::value::borrow_string(owner->data(), owner->size(), owner);
+    auto raw = owner.get();
+    owner.reset();
+    CUTE_ASSERT(ref.as_string_ref().data == raw->data());
+    CUTE_ASSERT(ref.as_string_ref() == mirror::string_ref("owned characters"));
+}
+
+CUTE_TEST(
+    "Test binary decoding of invalid input",
+    "[binary],[error]"
+) {
+    auto offset_of = [](std::string const& data) -> size_t {
+        try { mirror::from_binary(data); } catch(mirror::binary_format_error const& e) { return e.offset; }
+        return std::string::npos;
+    };
+
+    CUTE_ASSERT(offset_of("")                                        == 0);
+    CUTE_ASSERT(offset_of("JSON")                                    == 0);
+    CUTE_ASSERT(offset_of(std::string("MRB\x02\x00", 5))             == 3);
+    CUTE_ASSERT(offset_of(std::string("MRB\x01\x0F", 5))             == 4);
+    CUTE_ASSERT(offset_of(std::string("MRB\x01\x00\x00", 6))         == 5);
+    CUTE_ASSERT(offset_of(std::string("MRB\x01\x05\x10" "ab", 8))    == 5);
+    CUTE_ASSERT(offset_of(std::string("MRB\x01\x06\x01\x02\x00", 8)) == 6); // body exceeds the input
+    CUTE_ASSERT(offset_of(std::string("MRB\x01\x06\x01\x02\x00\x00", 9)) == 7); // body size mismatch
+
+    // every truncation of a valid document is detected
+    auto enc = mirror::to_binary(make_document());
+    for(size_t n = 0; n < enc.size(); ++n) {
+        CUTE_ASSERT(offset_of(enc.substr(0, n)) <= n, CUTE_CAPTURE(n));
+    }
+    CUTE_ASSERT(offset_of(enc) == std::string::npos);
+}
+
+namespace {
+
+    mirror::value make_large_document() {
+        auto root = mirror::value::dict();
+        auto& d = root.as_dict();
+        for(int i = 0; i < 50; ++i) {
+            auto rec = mirror::value::dict();
+            rec.as_dict()["id"]   = mirror::value(static_cast<int64_t>(i));
+            rec.as_dict()["name"] = mirror::value("item " + std::to_string(i));
+            rec.as_dict()["tags"] = mirror::value::array();
+            for(int j = 0; j < i % 12; ++j) { rec.as_dict()["tags"].push_back(mirror::value("t" + std::to_string(j))); }
+            d["key_" + std::to_string((i * 37) % 50)] = rec;
+        }
+        d["doc"] = make_document();
+        return root;
+    }
+
+    // compares a view against the value it has been encoded from
+    bool same(mirror::value const& v, mirror::value_view const& view) {
+        auto kind = (v.is_string_ref() ? mirror::value_kind::string : v.kind());
+        if(view.kind() != kind) { return false; }
+
+        switch(kind) {
+            case mirror::value_kind::boolean:   return (view.as_bool() == v.as_bool());
+            case mirror::value_kind::integer:   return (view.as_int() == v.as_int());
+            case mirror::value_kind::floating:  return (view.as_double() == v.as_double());
+            case mirror::value_kind::string:    return (view.as_string() == v.as_string_ref());
+            case mirror::value_kind::array: {
+                if(view.size() != v.size()) { return false; }
+                for(size_t i = 0; i < v.size(); ++i) {
+                    if(!same(v.at(i), view.at(i))) { return false; }
+                }
+                return true;
+            }
+            case mirror::value_kind::dict: {
+                if(view.size() != v.size()) { return false; }
+                for(auto&& e : v.as_dict()) {
+                    mirror::value_view child;
+                    if(!view.find(e.first.str(), child) || !same(e.second, child)) { return false; }
+                }
+                for(size_t i = 0; i < view.size(); ++i) {
+                    if(!same(v.as_dict().at(view.key_at(i).str()), view.value_at(i))) { return false; }
+                }
+                mirror::value_view missing;
+                return !view.find("no such key", missing) && view["no such key"].is_null();
+            }
+            case mirror::value_kind::int_array: {
+                for(size_t i = 0; i < v.size(); ++i) { if(view.int_at(i) != v.as_int_array()[i]) { return false; } }
+                return (view.size() == v.size());
+            }
+            case mirror::value_kind::double_array: {
+                for(size_t i = 0; i < v.size(); ++i) { if(view.double_at(i) != v.as_double_array()[i]) { return false; } }
+                return (view.size() == v.size());
+            }
+            case mirror::value_kind::bool_array: {
+                for(size_t i = 0; i < v.size(); ++i) { if(view.bool_at(i) != v.as_bool_array()[i]) { return false; } }
+                return (view.size() == v.size());
+            }
+            default:
+                return true;
+        }
+    }
+
+} // namespace
+
+CUTE_TEST(
+    "Test indexed binary layout",
+    "[binary],[indexed]"
+) {
+    auto doc = make_large_document();
+    auto compact = mirror::to_binary(doc);
+    auto indexed = mirror::to_binary(doc, mirror::binary_layout::indexed);
+    CUTE_ASSERT(indexed.size() == mirror::binary_size(doc, mirror::binary_layout::indexed));
+    CUTE_ASSERT(indexed.size() > compact.size());
+    CUTE_ASSERT(static_cast<uint8_t>(indexed[4]) == static_cast<uint8_t>(mirror::binary_tag::indexed_dict));
+
+    CUTE_ASSERT(mirror::to_json(mirror::from_binary(indexed)) == mirror::to_json(doc));
+    CUTE_ASSERT(mirror::to_json(mirror::from_binary(compact)) == mirror::to_json(doc));
+
+    // small containers are not indexed
+    auto small = make_document();
+    CUTE_ASSERT(mirror::to_binary(small.as_dict().at("list"), mirror::binary_layout::indexed) == mirror::to_binary(small.as_dict().at("list")));
+
+    // corrupted offsets get detected while decoding
+    auto broken = indexed;
+    broken[4 + 1 + 1 + 4 + 1] ^= 0x01; // first offset of the root dict (51 entries, body size in 4 bytes)
+    CUTE_ASSERT_THROWS_AS(mirror::from_binary(broken), mirror::binary_format_error);
+}
+
+CUTE_TEST(
+    "Test value_view over binary documents",
+    "[binary],[view]"
+) {
+    auto doc = make_large_document();
+    for(auto layout : { mirror::binary_layout::compact, mirror::binary_layout::indexed }) {
+        auto enc = mirror::to_binary(doc, layout);
+        auto view = mirror::value_view::document(enc.data(), enc.size());
+        CUTE_ASSERT(same(doc, view));
+
+        auto item = view["key_3"];
+        CUTE_ASSERT(item.is_dict());
+        CUTE_ASSERT(item["name"].as_string() == mirror::string_ref("item 19"));
+        CUTE_ASSERT(item["tags"].size() == 7);
+        CUTE_ASSERT(item["tags"].at(6).as_string().str() == "t6");
+        CUTE_ASSERT(item["name"].as_string().data >= enc.data()); // borrowed from the buffer
+        CUTE_ASSERT(item["name"].as_int() == 0); // kind mismatch
+
+        CUTE_ASSERT_THROWS_AS(item["tags"].at(7), std::out_of_range);
+        CUTE_ASSERT_THROWS_AS(item.at(0), std::out_of_range);
+        CUTE_ASSERT_THROWS_AS(view["doc"]["ints"].int_at(8), std::out_of_range);
+
+        CUTE_ASSERT(mirror::to_json(item.to_value()) == mirror::to_json(doc.as_dict().at("key_3")));
+        CUTE_ASSERT(mirror::to_json(view.to_value(mirror::binary_strings::borrow)) == mirror::to_json(doc));
+    }
+
+    CUTE_ASSERT(mirror::value_view().is_null());
+    CUTE_ASSERT(mirror::value_view().size() == 0);
+    CUTE_ASSERT_THROWS_AS(mirror::value_view::document("MRB", 3), mirror::binary_format_error);
+    CUTE_ASSERT_THROWS_AS(mirror::value_view::document("MRB\x01", 4), mirror::binary_format_error);
+}
+
+CUTE_TEST(
+    "Test value_view over a memory mapped file",
+    "[binary],[view],[file]"
+) {
+    auto doc = make_large_document();
+    auto enc = mirror::to_binary(doc, mirror::binary_layout::indexed);
+
+    auto path = std::string("mirror_cpp_binary_unittests.bin");
+    auto file = std::fopen(path.c_str(), "wb");
+    CUTE_ASSERT(file != nullptr);
+    CUTE_ASSERT(std::fwrite(enc.data(), 1, enc.size(), file) == enc.size());
+    std::fclose(file);
+
+    {
+        mirror::mapped_file mapped(path);
+        CUTE_ASSERT(mapped.size() == enc.size());
+        auto view = mirror::value_view::document(mapped.data(), mapped.size());
+        CUTE_ASSERT(same(doc, view));
+    }
+    std::remove(path.c_str());
+
+    CUTE_ASSERT_THROWS(mirror::mapped_file("no/such/file.bin"));
+}
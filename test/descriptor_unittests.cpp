@@ -0,0 +1,155 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <cute/cute.hpp>
+
+#include <mirror-cpp/descriptor.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct point {
+        double x = 1.0;
+        double y = 2.0;
+
+        double sum() const { return x + y; }
+        void scale(double f) { x *= f; y *= f; }
+    };
+
+    struct point3 : point {
+        double z = 3.0;
+    };
+
+    struct undescribed { };
+
+    // a generic serializer, fully resolved at compile time
+    template<typename T>
+    struct field_writer {
+        T const& obj;
+        std::string& out;
+
+        template<typename FIELD>
+        void operator()(FIELD const& f) const {
+            out += f.name;
+            out += '=';
+            out += std::to_string(static_cast<int>(FIELD::get(obj)));
+            out += ';';
+        }
+    };
+
+    struct name_collector {
+        std::vector<std::string>& names;
+
+        template<typename MEMBER>
+        void operator()(MEMBER const& m) const { names.push_back(m.name); }
+    };
+
+} // namespace
+
+MIRROR_DESCRIBE(point,
+    MIRROR_FIELD(point, x),
+    MIRROR_FIELD(point, y),
+    MIRROR_METHOD(point, sum),
+    MIRROR_METHOD(point, scale)
+)
+
+MIRROR_DESCRIBE_DERIVED(point3, point,
+    MIRROR_FIELD(point3, z)
+)
+
+CUTE_TEST(
+    "Test compile-time descriptors",
+    "[mirror],[descriptor]"
+) {
+    static_assert(mirror::is_described<point>::value, "point is described");
+    static_assert(!mirror::is_described<undescribed>::value, "undescribed is not described");
+    static_assert(std::tuple_size<decltype(mirror::descriptor<point>::members())>::value == 4, "4 members");
+
+    CUTE_ASSERT(std::string(mirror::descriptor<point>::name()) == "point");
+
+    std::vector<std::string> names;
+    mirror::for_each_member<point>(name_collector{ names });
+    CUTE_ASSERT((names == std::vector<std::string>{ "x", "y", "sum", "scale" }));
+
+    names.clear();
+    mirror::for_each_field<point>(name_collector{ names });
+    CUTE_ASSERT((names == std::vector<std::string>{ "x", "y" }));
+
+    point p;
+    std::string out;
+    mirror::for_each_field<point>(field_writer<point>{ p, out });
+    CUTE_ASSERT(out == "x=1;y=2;");
+
+    auto scale = std::get<3>(mirror::descriptor<point>::members());
+    scale.call(p, 2.0);
+    CUTE_ASSERT(std::get<2>(mirror::descriptor<point>::members()).call(p) == 6.0);
+}
+
+CUTE_TEST(
+    "Test runtime class info from descriptors",
+    "[mirror],[descriptor],[class]"
+) {
+    auto cls = mirror::class_of<point>();
+    CUTE_ASSERT(cls == mirror::class_of<point>());
+    CUTE_ASSERT(cls->name == mirror::atom("point"));
+    CUTE_ASSERT(cls->properties.size() == 2);
+    CUTE_ASSERT(cls->methods.size() == 2);
+
+    auto obj = std::make_shared<point>();
+    mirror::value v(obj);
+    cls->set(v, "y", mirror::value(5.0));
+    CUTE_ASSERT(obj->y == 5.0);
+    CUTE_ASSERT(cls->get(v, "x").as_double() == 1.0);
+
+    auto sum = cls->find_method("sum", 0);
+    CUTE_ASSERT(static_cast<bool>(sum));
+    CUTE_ASSERT(sum(v, mirror::value_span()).as_double() == 6.0);
+
+    // base classes are generated from their own descriptors
+    auto cls3 = mirror::class_of<point3>();
+    CUTE_ASSERT(cls3->base_class == cls);
+    CUTE_ASSERT(cls3->properties.size() == 1);
+    CUTE_ASSERT(static_cast<bool>(cls3->find_property_by_name("x", true)));
+
+    auto obj3 = std::make_shared<point3>();
+    mirror::value v3(obj3);
+    CUTE_ASSERT(cls3->get(v3, "z").as_double() == 3.0);
+    CUTE_ASSERT(cls3->get(v3, "y").as_double() == 2.0);
+}
+
+CUTE_TEST(
+    "Test registering described classes lazily",
+    "[mirror],[descriptor],[lazy]"
+) {
+    auto reg = mirror::class_registry();
+    mirror::add_described_class<point>(reg);
+    mirror::add_described_class<point3>(reg);
+    CUTE_ASSERT(reg.stats().lazy == 2);
+
+    auto cls3 = reg.find_class_by_type<point3>();
+    CUTE_ASSERT(cls3 == mirror::class_of<point3>());
+    CUTE_ASSERT(reg.find_class_by_name("point") == mirror::class_of<point>());
+    CUTE_ASSERT(reg.stats().materialized == 2);
+}
@@ -0,0 +1,191 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <cute/cute.hpp>
+
+#include <mirror-cpp/binary.hpp>
+#include <mirror-cpp/handler.hpp>
+#include <mirror-cpp/json.hpp>
+
+#include <string>
+
+namespace {
+
+    // records the events as a compact trace
+    struct trace_handler : mirror::value_handler {
+        std::string trace;
+
+        void null()                         override { trace += "n ";                                   }
+        void boolean(bool v)                override { trace += (v ? "t " : "f ");                      }
+        void int64(int64_t v)               override { trace += "i" + std::to_string(v) + " ";          }
+        void float64(double v)              override { trace += "d" + std::to_string(v) + " ";          }
+        void string(mirror::string_ref s)   override { trace += "s:" + s.str() + " ";                   }
+        void begin_array(size_t n)          override { trace += "[" + size_str(n) + " ";               }
+        void end_array()                    override { trace += "] ";                                   }
+        void begin_dict(size_t n)           override { trace += "{" + size_str(n) + " ";                }
+        void key(mirror::string_ref k)      override { trace += "k:" + k.str() + " ";                   }
+        void end_dict()                     override { trace += "} ";                                   }
+
+        static std::string size_str(size_t n) { return ((n == unknown_size) ? "?" : std::to_string(n)); }
+    };
+
+    // drops all entries with the key "secret" and forwards everything else
+    struct filter_handler : mirror::value_handler {
+        explicit filter_handler(mirror::value_handler& next) : m_next(next), m_skip(0) { }
+
+        void null()                         override { if(pass()) { m_next.null();       } }
+        void boolean(bool v)                override { if(pass()) { m_next.boolean(v);   } }
+        void int64(int64_t v)               override { if(pass()) { m_next.int64(v);     } }
+        void float64(double v)              override { if(pass()) { m_next.float64(v);   } }
+        void string(mirror::string_ref s)   override { if(pass()) { m_next.string(s);    } }
+        void begin_array(size_t n)          override { if(m_skip) { ++m_skip; } else { m_next.begin_array(n); } }
+        void end_array()                    override { if(m_skip) { leave(); }  else { m_next.end_array();    } }
+        void begin_dict(size_t n)           override { if(m_skip) { ++m_skip; } else { m_next.begin_dict(n);  } }
+        void end_dict()                     override { if(m_skip) { leave(); }  else { m_next.end_dict();     } }
+        void key(mirror::string_ref k) override {
+            if(m_skip) { return; }
+            if(k == mirror::string_ref("secret")) { m_skip = 1; return; }
+            m_next.key(k);
+        }
+
+    private:
+        // a scalar ends a skipped entry at the top level of the skip
+        inline bool pass() { if(!m_skip) { return true; } if(m_skip == 1) { m_skip = 0; } return false; }
+        inline void leave() { if(--m_skip == 1) { m_skip = 0; } }
+
+        mirror::value_handler&  m_next;
+        int                     m_skip; // 0: forward, 1: skip the next value, > 1: inside a skipped container
+    };
+
+} // namespace
+
+CUTE_TEST(
+    "Test walking a value emits its events",
+    "[handler],[walk]"
+) {
+    auto v = mirror::parse_json("{\"a\":[1,true,null,\"x\"]}");
+    v.as_dict()["b"] = mirror::value::int_array();
+    v.as_dict()["b"].as_int_array().assign({ 7, 8 });
+
+    trace_handler t;
+    mirror::walk(v, t);
+    CUTE_ASSERT(t.trace == "{2 k:a [4 i1 t n s:x ] k:b [2 i7 i8 ] } ");
+
+    // the parser does not know the sizes up front
+    trace_handler p;
+    mirror::parse_json("{\"a\":[1,true,null,\"x\"]}", p);
+    CUTE_ASSERT(p.trace == "{? k:a [? i1 t n s:x ] } ");
+
+    CUTE_ASSERT_THROWS(mirror::walk(mirror::value(std::make_shared<int>(1)), t));
+}
+
+CUTE_TEST(
+    "Test building values from events",
+    "[handler],[builder]"
+) {
+    mirror::value_builder b;
+    CUTE_ASSERT(!b.done());
+    b.begin_dict(mirror::value_handler::unknown_size);
+    b.key("list");
+    b.begin_array(2);
+    b.int64(1);
+    b.string("two");
+    b.end_array();
+    b.key("ints");
+    int64_t const ints[] = { 1, 2, 3 };
+    b.int_array(ints, 3);
+    b.key("bools");
+    uint8_t const bits[] = { 0x05 };
+    b.bool_array(bits, 3);
+    b.key("list"); // the last duplicate wins
+    b.float64(2.5);
+    CUTE_ASSERT(!b.done());
+    b.end_dict();
+    CUTE_ASSERT(b.done());
+
+    auto v = b.take();
+    CUTE_ASSERT(v.size() == 3);
+    CUTE_ASSERT(v.as_dict().at("list").as_double() == 2.5);
+    CUTE_ASSERT(v.as_dict().at("ints").is_int_array());
+    CUTE_ASSERT(v.as_dict().at("bools").is_bool_array());
+    CUTE_ASSERT(mirror::to_json(v.as_dict().at("bools")) == "[true,false,true]");
+
+    // objects are passed through
+    auto obj = mirror::value(std::make_shared<int>(42));
+    mirror::value_builder ob;
+    mirror::walk(obj, ob);
+    CUTE_ASSERT(*ob.take().as_ptr<int>() == 42);
+
+    // large dicts with keys in arbitrary order
+    mirror::value_builder lb;
+    lb.begin_dict(mirror::value_handler::unknown_size);
+    for(int i = 999; i >= 0; --i) {
+        auto k = "builder_key_" + std::to_string((i * 7) % 1000);
+        lb.key(k);
+        lb.int64(i);
+    }
+    lb.end_dict();
+    auto large = lb.take();
+    CUTE_ASSERT(large.size() == 1000);
+    CUTE_ASSERT(large.as_dict().at("builder_key_7").as_int() == 1);
+}
+
+CUTE_TEST(
+    "Test streaming pipelines",
+    "[handler],[json],[binary]"
+) {
+    auto json = std::string("{\"name\":\"x\",\"secret\":{\"pw\":[1,2]},\"list\":[{\"secret\":1,\"keep\":true},[]],\"n\":-1.5}");
+
+    // parse -> write
+    std::string out;
+    {
+        mirror::json_writer w(out);
+        mirror::parse_json(json, w);
+    }
+    CUTE_ASSERT(out == json);
+
+    // parse -> filter -> write
+    std::string filtered;
+    {
+        mirror::json_writer w(filtered);
+        filter_handler f(w);
+        mirror::parse_json(json, f);
+    }
+    CUTE_ASSERT(filtered == "{\"name\":\"x\",\"list\":[{\"keep\":true},[]],\"n\":-1.5}");
+
+    // binary -> write
+    auto v = mirror::parse_json(json);
+    auto bin = mirror::to_binary(v, mirror::binary_layout::indexed);
+    std::string from_bin;
+    {
+        mirror::json_writer w(from_bin);
+        mirror::from_binary(bin, w);
+    }
+    CUTE_ASSERT(from_bin == mirror::to_json(v));
+
+    // view -> builder
+    auto view = mirror::value_view::document(bin.data(), bin.size());
+    mirror::value_builder b;
+    mirror::walk(view["list"], b);
+    CUTE_ASSERT(mirror::to_json(b.take()) == mirror::to_json(v.as_dict().at("list")));
+}
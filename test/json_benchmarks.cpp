@@ -0,0 +1,155 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "bench.hpp"
+#include "bench_documents.hpp"
+
+#include <mirror-cpp/json.hpp>
+
+#include <cstdlib>
+
+namespace {
+
+    // a straightforward recursive descent parser as the baseline: character
+    // by character string building, strtod() for every number and interning
+    // of every single key (no validation beyond what is needed to parse)
+    struct naive_parser {
+        char const* p;
+
+        void ws() { while((*p == ' ') || (*p == '\n') || (*p == '\r') || (*p == '\t')) { ++p; } }
+
+        std::string str() {
+            std::string s;
+            for(++p; *p != '"'; ++p) {
+                if(*p == '\\') {
+                    ++p;
+                    switch(*p) {
+                        case 'n': s += '\n'; break;
+                        case 't': s += '\t'; break;
+                        case 'r': s += '\r'; break;
+                        case 'b': s += '\b'; break;
+                        case 'f': s += '\f'; break;
+                        default:  s += *p;   break;
+                    }
+                } else {
+                    s += *p;
+                }
+            }
+            ++p;
+            return s;
+        }
+
+        mirror::value parse() {
+            ws();
+            switch(*p) {
+                case '{': {
+                    auto res = mirror::value::dict();
+                    ++p; ws();
+                    if(*p == '}') { ++p; return res; }
+                    for(;;) {
+                        ws();
+                        auto key = str();
+                        ws(); ++p; // ':'
+                        res.as_dict()[key] = parse();
+                        ws();
+                        if(*p++ == '}') { return res; }
+                    }
+                }
+                case '[': {
+                    auto res = mirror::value::array();
+                    ++p; ws();
+                    if(*p == ']') { ++p; return res; }
+                    for(;;) {
+                        res.as_array().push_back(parse());
+                        ws();
+                        if(*p++ == ']') { return res; }
+                    }
+                }
+                case '"': return mirror::value(str());
+                case 't': p += 4; return mirror::value(true);
+                case 'f': p += 5; return mirror::value(false);
+                case 'n': p += 4; return mirror::value();
+                default: {
+                    char* end;
+                    auto d = std::strtod(p, &end);
+                    auto is_int = (std::find_if(p, static_cast<char const*>(end), [](char c) { return (c == '.') || (c == 'e') || (c == 'E'); }) == end);
+                    p = end;
+                    return (is_int ? mirror::value(static_cast<int64_t>(d)) : mirror::value(d));
+                }
+            }
+        }
+    };
+
+} // namespace
+
+BENCHMARK(json_writer) {
+    auto strings = bench::make_string_document(20000);
+    auto numbers = bench::make_number_document(200000);
+
+    std::string buf;
+    auto bytes = mirror::to_json(strings).size();
+    auto secs = bench::measure([&]() { buf.clear(); mirror::to_json(strings, buf); }, 5);
+    bench::report_throughput("string heavy document -> string", secs, bytes);
+
+    bytes = mirror::to_json(numbers).size();
+    secs = bench::measure([&]() { buf.clear(); mirror::to_json(numbers, buf); }, 5);
+    bench::report_throughput("number heavy document -> string", secs, bytes);
+
+    auto file = std::tmpfile();
+    if(file) {
+        bytes = mirror::to_json(strings).size();
+        secs = bench::measure([&]() { std::rewind(file); mirror::to_json(strings, file); }, 5);
+        bench::report_throughput("string heavy document -> FILE*", secs, bytes);
+        std::fclose(file);
+    }
+}
+
+BENCHMARK(json_parser) {
+    auto strings = mirror::to_json(bench::make_string_document(20000));
+    auto numbers = mirror::to_json(bench::make_number_document(200000));
+
+    auto secs = bench::measure([&]() { naive_parser p{ strings.c_str() }; bench::do_not_optimize(p.parse()); }, 3);
+    bench::report_throughput("string heavy document, naive", secs, strings.size());
+    secs = bench::measure([&]() { bench::do_not_optimize(mirror::parse_json(strings)); }, 3);
+    bench::report_throughput("string heavy document", secs, strings.size());
+    secs = bench::measure([&]() { mirror::value_arena arena; bench::do_not_optimize(mirror::parse_json(strings, &arena)); }, 3);
+    bench::report_throughput("string heavy document, arena", secs, strings.size());
+
+    secs = bench::measure([&]() { naive_parser p{ numbers.c_str() }; bench::do_not_optimize(p.parse()); }, 3);
+    bench::report_throughput("number heavy document, naive", secs, numbers.size());
+    secs = bench::measure([&]() { bench::do_not_optimize(mirror::parse_json(numbers)); }, 3);
+    bench::report_throughput("number heavy document", secs, numbers.size());
+    secs = bench::measure([&]() { mirror::value_arena arena; bench::do_not_optimize(mirror::parse_json(numbers, &arena)); }, 3);
+    bench::report_throughput("number heavy document, arena", secs, numbers.size());
+}
+
+BENCHMARK(json_streaming) {
+    auto json = mirror::to_json(bench::make_string_document(20000));
+
+    std::string out;
+    auto secs = bench::measure([&]() { out.clear(); mirror::to_json(mirror::parse_json(json), out); }, 3);
+    bench::report_throughput("parse -> value -> write", secs, json.size());
+
+    secs = bench::measure([&]() { out.clear(); mirror::json_writer w(out); mirror::parse_json(json, w); }, 3);
+    bench::report_throughput("parse -> write (events)", secs, json.size());
+}
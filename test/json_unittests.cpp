@@ -0,0 +1,283 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <cute/cute.hpp>
+
+#include <mirror-cpp/json.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+static mirror::value int_value(int64_t i) { return mirror::value(i); }
+
+CUTE_TEST(
+    "Test writing scalar values as JSON",
+    "[json],[writer]"
+) {
+    CUTE_ASSERT(mirror::to_json(mirror::value())                == "null");
+    CUTE_ASSERT(mirror::to_json(mirror::value(true))            == "true");
+    CUTE_ASSERT(mirror::to_json(mirror::value(false))           == "false");
+    CUTE_ASSERT(mirror::to_json(int_value(0))                   == "0");
+    CUTE_ASSERT(mirror::to_json(int_value(-1234567890123))      == "-1234567890123");
+    CUTE_ASSERT(mirror::to_json(int_value(INT64_MIN))           == "-9223372036854775808");
+    CUTE_ASSERT(mirror::to_json(int_value(INT64_MAX))           == "9223372036854775807");
+    CUTE_ASSERT(mirror::to_json(mirror::value(1.0))             == "1.0");
+    CUTE_ASSERT(mirror::to_json(mirror::value(-0.0))            == "-0.0");
+    CUTE_ASSERT(mirror::to_json(mirror::value(0.1))             == "0.1");
+    CUTE_ASSERT(mirror::to_json(mirror::value(1e300))           == "1e+300");
+    CUTE_ASSERT(mirror::to_json(mirror::value(std::nan("")))    == "null");
+
+    CUTE_ASSERT(mirror::to_json(mirror::value(0.3))                     == "0.3");
+    CUTE_ASSERT(mirror::to_json(mirror::value(-123.456))                == "-123.456");
+    CUTE_ASSERT(mirror::to_json(mirror::value(0.0001))                  == "0.0001");
+    CUTE_ASSERT(mirror::to_json(mirror::value(1e-5))                    == "1e-5");
+    CUTE_ASSERT(mirror::to_json(mirror::value(5e-324))                  == "5e-324");
+    CUTE_ASSERT(mirror::to_json(mirror::value(1.7976931348623157e308))  == "1.7976931348623157e+308");
+    CUTE_ASSERT(mirror::to_json(mirror::value(1e22))                    == "1e+22");
+
+    // the shortest representation always round trips
+    auto seed = uint64_t(1);
+    for(int i = 0; i < 100000; ++i) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        double d;
+        std::memcpy(&d, &seed, sizeof(d));
+        if(!std::isfinite(d)) { continue; }
+
+        auto s = mirror::to_json(mirror::value(d));
+        CUTE_ASSERT(std::strtod(s.c_str(), nullptr) == d, CUTE_CAPTURE(s));
+    }
+}
+
+CUTE_TEST(
+    "Test escaping strings in JSON",
+    "[json],[writer],[string]"
+) {
+    CUTE_ASSERT(mirror::to_json(mirror::value(""))                          == "\"\"");
+    CUTE_ASSERT(mirror::to_json(mirror::value("plain text"))                == "\"plain text\"");
+    CUTE_ASSERT(mirror::to_json(mirror::value("a\"b\\c"))                   == "\"a\\\"b\\\\c\"");
+    CUTE_ASSERT(mirror::to_json(mirror::value("\b\f\n\r\t"))                == "\"\\b\\f\\n\\r\\t\"");
+    CUTE_ASSERT(mirror::to_json(mirror::value(std::string("\x01\x1F", 2)))  == "\"\\u0001\\u001f\"");
+    CUTE_ASSERT(mirror::to_json(mirror::value("gr\xC3\xBC\xC3\x9F"))        == "\"gr\xC3\xBC\xC3\x9F\""); // UTF-8 is passed through
+
+    // escapes at all positions of (and behind) a 16 byte block
+    for(size_t pos = 0; pos < 40; ++pos) {
+        auto s = std::string(40, 'x');
+        s[pos] = '"';
+        auto expected = "\"" + s.substr(0, pos) + "\\\"" + s.substr(pos + 1) + "\"";
+        CUTE_ASSERT(mirror::to_json(mirror::value(s)) == expected, CUTE_CAPTURE(pos));
+    }
+}
+
+CUTE_TEST(
+    "Test writing nested values as JSON",
+    "[json],[writer]"
+) {
+    auto root = mirror::value::dict();
+    auto& d = root.as_dict();
+    d["name"] = mirror::value("mirror");
+    d["list"] = mirror::value::array();
+    d["list"].push_back(int_value(1));
+    d["list"].push_back(mirror::value(2.5));
+    d["list"].push_back(mirror::value());
+    d["list"].push_back(mirror::value::dict());
+    d["ints"] = mirror::value::int_array();
+    d["ints"].as_int_array().assign({ 1, -2 });
+    d["doubles"] = mirror::value::double_array();
+    d["doubles"].as_double_array().assign({ 0.5 });
+    d["bools"] = mirror::value::bool_array();
+    d["bools"].as_bool_array().assign({ true, false });
+
+    // keys are written in dict order, i.e. sorted by their characters
+    auto expected = std::string(
+        "{\"bools\":[true,false],\"doubles\":[0.5],\"ints\":[1,-2],"
+        "\"list\":[1,2.5,null,{}],\"name\":\"mirror\"}"
+    );
+    CUTE_ASSERT(mirror::to_json(root) == expected);
+
+    // appending to a reused buffer
+    auto buf = std::string("prefix:");
+    mirror::to_json(d["list"], buf);
+    mirror::to_json(d["ints"], buf);
+    CUTE_ASSERT(buf == "prefix:[1,2.5,null,{}][1,-2]");
+
+    CUTE_ASSERT_THROWS(mirror::to_json(mirror::value(std::make_shared<int>(1))));
+}
+
+CUTE_TEST(
+    "Test writing JSON to a file",
+    "[json],[writer],[file]"
+) {
+    auto arr = mirror::value::array();
+    for(int i = 0; i < 10000; ++i) { arr.push_back(mirror::value(std::string(i % 100, 'x'))); }
+    auto expected = mirror::to_json(arr);
+
+    auto file = std::tmpfile();
+    CUTE_ASSERT(file != nullptr);
+    {
+        mirror::json_writer w(file, 256); // small buffer to exercise flushing
+        w.write(arr);
+    }
+    auto size = static_cast<size_t>(std::ftell(file));
+    CUTE_ASSERT(size == expected.size());
+
+    auto content = std::string(size, '\0');
+    std::rewind(file);
+    CUTE_ASSERT(std::fread(&content[0], 1, size, file) == size);
+    CUTE_ASSERT(content == expected);
+    std::fclose(file);
+}
+
+CUTE_TEST(
+    "Test parsing scalar values from JSON",
+    "[json],[parser]"
+) {
+    CUTE_ASSERT(mirror::parse_json("null").is_null());
+    CUTE_ASSERT(mirror::parse_json("true").as_bool() == true);
+    CUTE_ASSERT(mirror::parse_json(" false ").as_bool() == false);
+    CUTE_ASSERT(mirror::parse_json("\"text\"").as_string() == "text");
+
+    CUTE_ASSERT(mirror::parse_json("0").as_int() == 0);
+    CUTE_ASSERT(mirror::parse_json("-42").as_int() == -42);
+    CUTE_ASSERT(mirror::parse_json("9223372036854775807").as_int() == INT64_MAX);
+    CUTE_ASSERT(mirror::parse_json("-9223372036854775808").as_int() == INT64_MIN);
+    CUTE_ASSERT(mirror::parse_json("9223372036854775808").is_double()); // does not fit into an int64_t
+
+    CUTE_ASSERT(mirror::parse_json("1.0").is_double());
+    CUTE_ASSERT(mirror::parse_json("1.5").as_double() == 1.5);
+    CUTE_ASSERT(mirror::parse_json("-0.0").as_double() == 0.0);
+    CUTE_ASSERT(std::signbit(mirror::parse_json("-0.0").as_double()));
+    CUTE_ASSERT(mirror::parse_json("1e3").as_double() == 1000.0);
+    CUTE_ASSERT(mirror::parse_json("1E-2").as_double() == 0.01);
+    CUTE_ASSERT(mirror::parse_json("0.000001234").as_double() == 0.000001234);
+    CUTE_ASSERT(mirror::parse_json("123456789012345678901234567890").as_double() == 123456789012345678901234567890.0);
+    CUTE_ASSERT(mirror::parse_json("2.2250738585072014e-308").as_double() == 2.2250738585072014e-308);
+    CUTE_ASSERT(mirror::parse_json("1.7976931348623157e308").as_double() == 1.7976931348623157e308);
+
+    // writing and parsing doubles round trips exactly
+    auto seed = uint64_t(7);
+    for(int i = 0; i < 100000; ++i) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        double d;
+        std::memcpy(&d, &seed, sizeof(d));
+        if(!std::isfinite(d)) { continue; }
+
+        auto s = mirror::to_json(mirror::value(d));
+        CUTE_ASSERT(mirror::parse_json(s).as_double() == d, CUTE_CAPTURE(s));
+    }
+}
+
+CUTE_TEST(
+    "Test parsing strings from JSON",
+    "[json],[parser],[string]"
+) {
+    CUTE_ASSERT(mirror::parse_json("\"\"").as_string() == "");
+    CUTE_ASSERT(mirror::parse_json("\"a\\\"b\\\\c\\/d\"").as_string() == "a\"b\\c/d");
+    CUTE_ASSERT(mirror::parse_json("\"\\b\\f\\n\\r\\t\"").as_string() == "\b\f\n\r\t");
+    CUTE_ASSERT(mirror::parse_json("\"\\u0041\\u00fc\\u20AC\"").as_string() == "A\xC3\xBC\xE2\x82\xAC");
+    CUTE_ASSERT(mirror::parse_json("\"\\ud83d\\ude00\"").as_string() == "\xF0\x9F\x98\x80"); // surrogate pair
+
+    // escapes at all positions of (and behind) a 16 byte block
+    for(size_t pos = 0; pos < 40; ++pos) {
+        auto s = std::string(40, 'x');
+        s[pos] = '\n';
+        CUTE_ASSERT(mirror::parse_json(mirror::to_json(mirror::value(s))).as_string() == s, CUTE_CAPTURE(pos));
+    }
+
+    CUTE_ASSERT_THROWS_AS(mirror::parse_json("\"abc"), mirror::json_parse_error);
+    CUTE_ASSERT_THROWS_AS(mirror::parse_json("\"a\\x\""), mirror::json_parse_error);
+    CUTE_ASSERT_THROWS_AS(mirror::parse_json("\"\\ud83d\""), mirror::json_parse_error);
+    CUTE_ASSERT_THROWS_AS(mirror::parse_json("\"\\u12G4\""), mirror::json_parse_error);
+    CUTE_ASSERT_THROWS_AS(mirror::parse_json(std::string("\"a\x01\"")), mirror::json_parse_error);
+}
+
+CUTE_TEST(
+    "Test parsing nested values from JSON",
+    "[json],[parser]"
+) {
+    auto v = mirror::parse_json(" { \"name\" : \"mirror\", \"list\": [1, 2.5, null, {}, []],\n\t\"flag\": true, \"name\": \"dup\" } ");
+    CUTE_ASSERT(v.is_dict());
+    auto& d = v.as_dict();
+    CUTE_ASSERT(d.size() == 3);
+    CUTE_ASSERT(d["name"].as_string() == "dup"); // the last duplicate key wins
+    CUTE_ASSERT(d["flag"].as_bool() == true);
+    CUTE_ASSERT(d["list"].size() == 5);
+    CUTE_ASSERT(d["list"].at(0).as_int() == 1);
+    CUTE_ASSERT(d["list"].at(1).as_double() == 2.5);
+    CUTE_ASSERT(d["list"].at(2).is_null());
+    CUTE_ASSERT(d["list"].at(3).is_dict());
+    CUTE_ASSERT(d["list"].at(4).is_array());
+
+    // writing and parsing round trips
+    auto json = mirror::to_json(v);
+    CUTE_ASSERT(mirror::to_json(mirror::parse_json(json)) == json);
+
+    // parsing into an arena
+    mirror::value_arena arena(4096);
+    {
+        auto a = mirror::parse_json(json, &arena);
+        CUTE_ASSERT(arena.bytes_reserved() > 0);
+        CUTE_ASSERT(mirror::to_json(a) == json);
+    }
+
+    // long whitespace runs
+    auto padded = std::string(100, ' ') + "[" + std::string(33, '\n') + "1" + std::string(17, '\t') + "]" + std::string(50, ' ');
+    CUTE_ASSERT(mirror::parse_json(padded).at(0).as_int() == 1);
+}
+
+CUTE_TEST(
+    "Test JSON parse errors",
+    "[json],[parser],[error]"
+) {
+    auto offset_of = [](std::string const& json) -> size_t {
+        try { mirror::parse_json(json); } catch(mirror::json_parse_error const& e) { return e.offset; }
+        return std::string::npos;
+    };
+
+    CUTE_ASSERT(offset_of("")               == 0);
+    CUTE_ASSERT(offset_of("   ")            == 3);
+    CUTE_ASSERT(offset_of("nul")            == 0);
+    CUTE_ASSERT(offset_of("[1,2")           == 4);
+    CUTE_ASSERT(offset_of("[1 2]")          == 3);
+    CUTE_ASSERT(offset_of("{\"a\" 1}")      == 5);
+    CUTE_ASSERT(offset_of("{1:2}")          == 1);
+    CUTE_ASSERT(offset_of("{\"a\":1,}")     == 7);
+    CUTE_ASSERT(offset_of("[1,]")           == 3);
+    CUTE_ASSERT(offset_of("01")             == 0);
+    CUTE_ASSERT(offset_of("-")              == 0);
+    CUTE_ASSERT(offset_of("1.")             == 0);
+    CUTE_ASSERT(offset_of("1e")             == 0);
+    CUTE_ASSERT(offset_of("+1")             == 0);
+    CUTE_ASSERT(offset_of("true false")     == 5);
+    CUTE_ASSERT(offset_of("[\"a\",\"b")     == 5);
+
+    CUTE_ASSERT(offset_of(std::string(513, '[') + std::string(513, ']')) == 512); // nesting too deep
+    CUTE_ASSERT(offset_of(std::string(512, '[') + std::string(512, ']')) == std::string::npos);
+
+    try {
+        mirror::parse_json("[1,2");
+        CUTE_ASSERT(false);
+    } catch(mirror::json_parse_error const& e) {
+        CUTE_ASSERT(std::string(e.what()).find("at offset 4") != std::string::npos);
+    }
+}
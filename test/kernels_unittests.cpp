@@ -0,0 +1,214 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <cute/cute.hpp>
+
+#include <mirror-cpp/kernels.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using mirror::kernels::compare_op;
+using mirror::kernels::isa;
+
+namespace {
+
+    // deterministic pseudo random input data
+    struct test_data {
+        explicit test_data(size_t n) {
+            auto seed = uint64_t(42);
+            for(size_t i = 0; i < n; ++i) {
+                seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+                ints.push_back(static_cast<int64_t>(seed >> 40) - (1ll << 23));
+                doubles.push_back(static_cast<double>(ints.back()) / 1024.0);
+            }
+        }
+
+        std::vector<int64_t>    ints;
+        std::vector<double>     doubles;
+    };
+
+    template<typename T>
+    size_t reference_count(std::vector<T> const& v, compare_op op, T rhs) {
+        size_t c = 0;
+        for(auto x : v) {
+            switch(op) {
+                case compare_op::lt: c += (x <  rhs); break;
+                case compare_op::le: c += (x <= rhs); break;
+                case compare_op::gt: c += (x >  rhs); break;
+                case compare_op::ge: c += (x >= rhs); break;
+                case compare_op::eq: c += (x == rhs); break;
+                case compare_op::ne: c += (x != rhs); break;
+            }
+        }
+        return c;
+    }
+
+    // reference for the (saturating) double -> int64 conversion
+    int64_t reference_to_int(double d) {
+        if(std::isnan(d))                    { return 0; }
+        if(d >=  std::ldexp(1.0, 63))        { return std::numeric_limits<int64_t>::max(); }
+        if(d <= -std::ldexp(1.0, 63))        { return std::numeric_limits<int64_t>::min(); }
+        return static_cast<int64_t>(std::trunc(d));
+    }
+
+    // doubles that cannot be represented as int64
+    std::vector<double> special_doubles() {
+        auto inf = std::numeric_limits<double>::infinity();
+        return {
+            std::numeric_limits<double>::quiet_NaN(), inf, -inf, 1e300, -1e300,
+            std::ldexp(1.0, 63), -std::ldexp(1.0, 63), std::ldexp(1.0, 62),
+            -2.75, 2.75, -0.0
+        };
+    }
+
+    // runs the given check for all instruction sets supported by this CPU
+    template<typename FUNC>
+    void for_each_isa(FUNC func) {
+        auto best = mirror::kernels::best_isa();
+        for(auto i : { isa::scalar, isa::sse2, isa::avx2 }) {
+            if(static_cast<int>(i) > static_cast<int>(best)) { continue; }
+            mirror::kernels::set_isa(i);
+            CUTE_ASSERT((mirror::kernels::active_isa() == i));
+            func();
+        }
+        mirror::kernels::set_isa(best);
+    }
+
+}
+
+CUTE_TEST(
+    "Test span kernels against scalar reference results",
+    "[kernels],[span]"
+) {
+    for(auto n : { 0, 1, 3, 4, 7, 17, 1000, 1003 }) {
+        auto data = test_data(n);
+        auto&& ints = data.ints;
+        auto&& doubles = data.doubles;
+
+        for_each_isa([&]() {
+            auto ref_i = int64_t(0);
+            auto ref_d = 0.0;
+            for(auto x : ints)    { ref_i += x; }
+            for(auto x : doubles) { ref_d += x; }
+            CUTE_ASSERT(mirror::kernels::sum(ints.data(), ints.size()) == ref_i);
+            CUTE_ASSERT(std::abs(mirror::kernels::sum(doubles.data(), doubles.size()) - ref_d) <= 1e-9 * (1.0 + std::abs(ref_d)));
+
+            int64_t imin, imax;
+            double dmin, dmax;
+            CUTE_ASSERT(mirror::kernels::min_max(ints.data(),    ints.size(),    imin, imax) == (n > 0));
+            CUTE_ASSERT(mirror::kernels::min_max(doubles.data(), doubles.size(), dmin, dmax) == (n > 0));
+            if(n > 0) {
+                CUTE_ASSERT(imin == *std::min_element(ints.begin(), ints.end()));
+                CUTE_ASSERT(imax == *std::max_element(ints.begin(), ints.end()));
+                CUTE_ASSERT(dmin == *std::min_element(doubles.begin(), doubles.end()));
+                CUTE_ASSERT(dmax == *std::max_element(doubles.begin(), doubles.end()));
+            }
+
+            for(auto op : { compare_op::lt, compare_op::le, compare_op::gt, compare_op::ge, compare_op::eq, compare_op::ne }) {
+                auto ri = (ints.empty()    ? int64_t(0) : ints[ints.size() / 2]);
+                auto rd = (doubles.empty() ? 0.0        : doubles[doubles.size() / 2]);
+                CUTE_ASSERT(mirror::kernels::count_if(ints.data(),    ints.size(),    op, ri) == reference_count(ints,    op, ri));
+                CUTE_ASSERT(mirror::kernels::count_if(doubles.data(), doubles.size(), op, rd) == reference_count(doubles, op, rd));
+            }
+
+            auto scaled = doubles;
+            mirror::kernels::scale_offset(scaled.data(), scaled.size(), 2.5, -1.0);
+            for(size_t i = 0; i < scaled.size(); ++i) { CUTE_ASSERT(scaled[i] == doubles[i] * 2.5 + -1.0); }
+
+            auto converted = std::vector<double>(ints.size());
+            mirror::kernels::convert(ints.data(), ints.size(), converted.data());
+            auto back = std::vector<int64_t>(ints.size());
+            mirror::kernels::convert(converted.data(), converted.size(), back.data());
+            CUTE_ASSERT((back == ints));
+        });
+    }
+
+    auto specials = special_doubles();
+    for_each_isa([&]() {
+        auto converted = std::vector<int64_t>(specials.size());
+        mirror::kernels::convert(specials.data(), specials.size(), converted.data());
+        for(size_t i = 0; i < specials.size(); ++i) { CUTE_ASSERT(converted[i] == reference_to_int(specials[i])); }
+    });
+}
+
+CUTE_TEST(
+    "Test value kernels",
+    "[kernels],[value]"
+) {
+    auto ints = mirror::value::int_array();
+    ints.as_int_array().assign({ 3, -1, 4, 1, -5, 9, 2, 6 });
+
+    auto doubles = mirror::value::double_array();
+    doubles.as_double_array().assign({ 0.5, 1.5, -2.0, 4.0 });
+
+    auto mixed = mirror::value::array();
+    mixed.push_back(mirror::value(static_cast<int64_t>(2)));
+    mixed.push_back(mirror::value(0.5));
+
+    CUTE_ASSERT(mirror::kernels::sum(ints).is_int());
+    CUTE_ASSERT(mirror::kernels::sum(ints).as_int() == 19);
+    CUTE_ASSERT(mirror::kernels::sum(doubles).as_double() == 4.0);
+    CUTE_ASSERT(mirror::kernels::sum(mixed).as_double() == 2.5);
+    CUTE_ASSERT(mirror::kernels::mean(doubles) == 1.0);
+    CUTE_ASSERT(std::isnan(mirror::kernels::mean(mirror::value::int_array())));
+
+    auto mn = mirror::value(), mx = mirror::value();
+    CUTE_ASSERT(mirror::kernels::min_max(ints, mn, mx));
+    CUTE_ASSERT(mn.as_int() == -5);
+    CUTE_ASSERT(mx.as_int() == 9);
+    CUTE_ASSERT(!mirror::kernels::min_max(mirror::value::double_array(), mn, mx));
+
+    CUTE_ASSERT(mirror::kernels::count_if(ints, compare_op::gt, mirror::value(static_cast<int64_t>(2))) == 4);
+    CUTE_ASSERT(mirror::kernels::count_if(doubles, compare_op::lt, mirror::value(1.0)) == 2);
+    CUTE_ASSERT(mirror::kernels::count_if(mixed, compare_op::ge, mirror::value(1.0)) == 1);
+
+    auto as_doubles = mirror::kernels::to_double_array(ints);
+    CUTE_ASSERT(as_doubles.is_double_array());
+    CUTE_ASSERT(as_doubles.at(5).as_double() == 9.0);
+    CUTE_ASSERT(mirror::kernels::to_int_array(doubles).at(1).as_int() == 1);
+
+    // out of range doubles saturate (NaN becomes 0) in typed and generic arrays
+    auto specials = special_doubles();
+    auto typed_specials = mirror::value::double_array();
+    auto mixed_specials = mirror::value::array();
+    typed_specials.as_double_array().assign(specials.begin(), specials.end());
+    for(auto d : specials) { mixed_specials.push_back(mirror::value(d)); }
+    auto typed_ints = mirror::kernels::to_int_array(typed_specials);
+    auto mixed_ints = mirror::kernels::to_int_array(mixed_specials);
+    for(size_t i = 0; i < specials.size(); ++i) {
+        CUTE_ASSERT(typed_ints.at(i).as_int() == reference_to_int(specials[i]));
+        CUTE_ASSERT(mixed_ints.at(i).as_int() == reference_to_int(specials[i]));
+    }
+
+    mirror::kernels::scale_offset(ints, 2.0, 1.0);
+    CUTE_ASSERT(ints.is_double_array());
+    CUTE_ASSERT(ints.at(0).as_double() == 7.0);
+
+    CUTE_ASSERT_THROWS(mirror::kernels::sum(mirror::value("not an array")));
+    auto strings = mirror::value::array();
+    strings.push_back(mirror::value("a"));
+    CUTE_ASSERT_THROWS(mirror::kernels::sum(strings));
+}
@@ -25,6 +25,11 @@
 
 #include <mirror-cpp/mirror.hpp>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
 struct A {
     A() : a(42), a_const(15) { }
 
@@ -79,6 +84,139 @@ CUTE_TEST(
     CUTE_ASSERT(reg.find_class_by_type<A>().get() == a.get());
 }
 
+CUTE_TEST(
+    "Test registering many classes",
+    "[mirror],[register_class]"
+) {
+    auto reg = mirror::class_registry();
+
+    auto a = mirror::make_class<A>("A");
+    auto b = mirror::make_class<B>("B", a);
+    reg.add_class(a);
+    reg.add_class(b);
+
+    // a type can be registered under more than one name; lookups by type
+    // return the class registered first
+    for(int i = 0; i < 1000; ++i) {
+        reg.add_class(mirror::make_class<C>(("C_" + std::to_string(i)).c_str(), b));
+    }
+
+    CUTE_ASSERT(reg.classes().size() == 1002);
+    CUTE_ASSERT(reg.classes()[0].get() == a.get());
+    CUTE_ASSERT(reg.classes()[1].get() == b.get());
+    CUTE_ASSERT(reg.classes()[2]->name == "C_0");
+    CUTE_ASSERT(reg.classes()[1001]->name == "C_999");
+
+    CUTE_ASSERT(reg.find_class_by_name("A").get() == a.get());
+    CUTE_ASSERT(reg.find_class_by_name("B").get() == b.get());
+    CUTE_ASSERT(reg.find_class_by_name("C_500").get() == reg.classes()[502].get());
+    CUTE_ASSERT(!reg.find_class_by_name("C_1000").get());
+
+    CUTE_ASSERT(reg.find_class_by_type<A>().get() == a.get());
+    CUTE_ASSERT(reg.find_class_by_type<B>().get() == b.get());
+    CUTE_ASSERT(reg.find_class_by_type<C>().get() == reg.classes()[2].get());
+    CUTE_ASSERT(!reg.find_class_by_type<int>().get());
+}
+
+CUTE_TEST(
+    "Test freezing a class registry",
+    "[mirror],[register_class],[freeze]"
+) {
+    auto empty = mirror::class_registry();
+    empty.freeze();
+    CUTE_ASSERT(empty.frozen());
+    CUTE_ASSERT(!empty.find_class_by_name("A").get());
+    CUTE_ASSERT(!empty.find_class_by_type<A>().get());
+
+    auto reg = mirror::class_registry();
+    auto a = mirror::make_class<A>("A");
+    auto b = mirror::make_class<B>("B", a);
+    reg.add_class(a);
+    reg.add_class(b);
+    for(int i = 0; i < 1000; ++i) {
+        reg.add_class(mirror::make_class<C>(("C_" + std::to_string(i)).c_str(), b));
+    }
+
+    CUTE_ASSERT(!reg.frozen());
+    reg.freeze();
+    CUTE_ASSERT(reg.frozen());
+    reg.freeze(); // freezing twice is fine
+
+    CUTE_ASSERT(reg.classes().size() == 1002);
+    for(auto&& c : reg.classes()) {
+        CUTE_ASSERT(reg.find_class_by_name(c->name).get() == c.get());
+    }
+    CUTE_ASSERT(!reg.find_class_by_name("C_1000").get());
+    CUTE_ASSERT(!reg.find_class_by_name("D").get());
+
+    // looking up an unknown name does not intern it
+    auto unknown = mirror::atom();
+    CUTE_ASSERT(!reg.find_class_by_name(std::string("a class name which is only looked up")).get());
+    CUTE_ASSERT(!mirror::atom::find("a class name which is only looked up", unknown));
+
+    CUTE_ASSERT(reg.find_class_by_type<A>().get() == a.get());
+    CUTE_ASSERT(reg.find_class_by_type<B>().get() == b.get());
+    CUTE_ASSERT(reg.find_class_by_type<C>().get() == reg.classes()[2].get());
+    CUTE_ASSERT(!reg.find_class_by_type<int>().get());
+
+    CUTE_ASSERT_THROWS_AS(reg.add_class(mirror::make_class<A>("D")), std::logic_error);
+    CUTE_ASSERT(reg.classes().size() == 1002);
+    CUTE_ASSERT(!reg.find_class_by_name("D").get());
+}
+
+CUTE_TEST(
+    "Test reading a class registry while registering classes",
+    "[mirror],[register_class],[concurrency]"
+) {
+    auto reg = mirror::class_registry();
+    auto a_cls = mirror::make_class<A>("A");
+    a_cls->add_method("func_c", &A::func_c);
+    reg.add_class(a_cls);
+
+    auto b = mirror::make_class<B>("B", a_cls);
+    const int num_classes = 5000;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> lookups(0), failures(0);
+
+    auto reader = [&]() {
+        auto ctx = mirror::context();
+        auto a = mirror::value(std::make_shared<A>());
+        for(size_t i = 0; !done.load() || (i < 1000); ++i) {
+            // everything in a snapshot can be found
+            auto classes = reg.classes();
+            auto const& c = classes[(i * 7919) % classes.size()];
+            if(reg.find_class_by_name(c->name) != c) { ++failures; }
+            if(reg.find_class_by_name(c->name.str()) != c) { ++failures; }
+            if(reg.find_class_by_type(c->type) != ((c->type == typeid(A)) ? a_cls : classes[1])) { ++failures; }
+            if(reg.invoke(ctx, a, "func_c", mirror::values()).as_int() != 42) { ++failures; }
+            ++lookups;
+        }
+    };
+
+    {
+        cute::thread r1(reader), r2(reader), r3(reader);
+        for(int i = 0; i < num_classes; ++i) {
+            reg.add_class(mirror::make_class<C>(("C_" + std::to_string(i)).c_str(), b));
+        }
+        reg.freeze();
+        done = true;
+    }
+
+    CUTE_ASSERT(failures == 0);
+    CUTE_ASSERT(lookups >= 3000);
+    CUTE_ASSERT(reg.classes().size() == num_classes + 1);
+
+    // the superseded indexes are only freed on request
+    reg.reclaim();
+    CUTE_ASSERT(reg.find_class_by_name("C_4999") == reg.classes()[num_classes]);
+    CUTE_ASSERT(reg.find_class_by_type<C>() == reg.classes()[1]);
+
+    auto copy = reg;
+    CUTE_ASSERT(copy.frozen());
+    CUTE_ASSERT(copy.classes().size() == num_classes + 1);
+    CUTE_ASSERT(copy.find_class_by_name("C_17") == reg.classes()[18]);
+}
+
 template<typename T1, typename T2>
 static void check_prop(bool const read_only) {
     auto p = mirror::make_property<T1>("prop");
@@ -155,6 +293,69 @@ CUTE_TEST(
     CUTE_ASSERT(b->find_property_by_name("a_const", true).get());   // "a" is in the base class
 }
 
+CUTE_TEST(
+    "Test the flattened member tables",
+    "[mirror],[register_property],[register_method],[members]"
+) {
+    auto a = mirror::make_class<A>("A");
+    a->add_property("a", &A::a);
+    a->add_method("func_c", &A::func_c);
+    a->add_method("func_a", &A::func_a);
+
+    auto b = mirror::make_class<B>("B", a);
+    b->add_property("b", &B::b);
+
+    auto c = mirror::make_class<C>("C", b);
+    c->add_property("c", &C::c);
+    c->add_method("func_c", static_cast<int (C::*)() const>(&A::func_d)); // shadows A::func_c
+
+    auto const& members = c->members();
+    CUTE_ASSERT(members.properties.size() == 3);
+    CUTE_ASSERT(members.methods.size() == 2);
+    CUTE_ASSERT(members.properties.at("a").property == a->properties[0]);
+    CUTE_ASSERT(members.properties.at("a").depth == 2);
+    CUTE_ASSERT(members.properties.at("c").property == c->properties[0]);
+    CUTE_ASSERT(members.properties.at("c").depth == 0);
+    CUTE_ASSERT(members.methods.at(mirror::member_table::method_key("func_c", 0)).method == c->methods[0]);
+    CUTE_ASSERT(members.methods.at(mirror::member_table::method_key("func_c", 0)).depth == 0);
+    CUTE_ASSERT(members.methods.at(mirror::member_table::method_key("func_a", 0)).method == a->methods[1]);
+    CUTE_ASSERT(members.methods.at(mirror::member_table::method_key("func_a", 0)).depth == 2);
+    CUTE_ASSERT(!members.methods.count(mirror::member_table::method_key("func_a", 1)));
+    CUTE_ASSERT(&c->members() == &members); // cached
+
+    CUTE_ASSERT(c->find_property_by_name("a", true).get() == a->properties[0].get());
+    CUTE_ASSERT(!c->find_property_by_name("a").get());
+    CUTE_ASSERT(!c->find_property_by_name("a_const", true).get());
+    CUTE_ASSERT_THROWS(c->invoke(*std::make_shared<mirror::context>(), mirror::value(), "func_x", mirror::values()));
+
+    // modifying a base class invalidates the tables of the derived classes,
+    // but not those of unrelated classes
+    auto other = mirror::make_class<A>("other");
+    auto const* other_members = &other->members();
+    a->add_property("a_const", &A::a_const);
+    CUTE_ASSERT(c->find_property_by_name("a_const", true).get() == a->properties[1].get());
+    CUTE_ASSERT(c->members().properties.size() == 4);
+    CUTE_ASSERT(&other->members() == other_members);
+
+    // modifying a class nobody has looked at yet invalidates nothing
+    auto epoch = mirror::class_info_base::members_epoch();
+    auto d = mirror::make_class<C>("D", b);
+    d->add_property("c", &C::c);
+    CUTE_ASSERT(mirror::class_info_base::members_epoch() == epoch);
+    CUTE_ASSERT(d->members().properties.size() == 4);
+
+    // superseded tables are freed by reclaim()
+    auto const* c_members = &c->members();
+    c->reclaim();
+    CUTE_ASSERT(&c->members() == c_members);
+    CUTE_ASSERT(c->members().properties.size() == 4);
+
+    b->set_base_class(nullptr);
+    CUTE_ASSERT(!c->find_property_by_name("a", true).get());
+    CUTE_ASSERT(c->find_property_by_name("b", true).get());
+    CUTE_ASSERT(c->members().methods.size() == 1);
+}
+
 CUTE_TEST(
     "Test registering a method",
     "[mirror],[register_method]"
@@ -177,6 +378,15 @@ CUTE_TEST(
     ctx->add_method<void, double>("func_i", &A::func_i);
 
     std::cout << ctx->to_string() << std::endl;
+
+    CUTE_ASSERT(ctx->methods.size() == 10);
+    CUTE_ASSERT(ctx->methods[0]->num_args == 0);
+    CUTE_ASSERT(ctx->methods[4]->num_args == 1);
+    CUTE_ASSERT(ctx->methods[8]->num_args == 2);
+    CUTE_ASSERT(ctx->methods[9]->num_args == 1);
+    CUTE_ASSERT(ctx->methods[8]->type == typeid(int (A::*)(int, double)));
+    CUTE_ASSERT(ctx->methods[9]->type == typeid(void (A::*)(double) const));
+    CUTE_ASSERT(ctx->methods[9]->owner == typeid(A));
 }
 
 CUTE_TEST(
@@ -204,5 +414,697 @@ CUTE_TEST(
     auto nul_val = mirror::value();
     std::cout << "nul_val type: " << nul_val.m_type->name() << std::endl;
 
-    reg.invoke(ctx, a_val, "func_a", mirror::values());
+    auto res = reg.invoke(ctx, a_val, "func_a", mirror::values());
+    CUTE_ASSERT(res.is_null());
+}
+
+struct E {
+    E() : e(7) { }
+    virtual ~E() { }
+
+    int e;
+
+    int get_e() const { return e; }
+    void set_e(int v) { e = v; }
+    std::string describe(std::string const& prefix, double scale) const { return prefix + std::to_string(static_cast<int>(e * scale)); }
+};
+
+struct Pad { double pad[3]; };
+
+struct F : Pad, E { }; // E is not at offset 0
+
+CUTE_TEST(
+    "Test invoking methods with arguments",
+    "[mirror],[method],[invoke]"
+) {
+    auto a_cls = mirror::make_class<A>("A");
+    a_cls->add_method("func_c", &A::func_c);
+    a_cls->add_method("func_h", &A::func_h);
+    a_cls->add_method<int, int, double>("func_i", &A::func_i);
+    a_cls->add_method<void, double>("func_i", &A::func_i);
+
+    auto e_cls = mirror::make_class<E>("E");
+    e_cls->add_method("get_e", &E::get_e);
+    e_cls->add_method("set_e", &E::set_e);
+    e_cls->add_method("describe", &E::describe);
+    auto f_cls = mirror::make_class<F>("F", e_cls);
+
+    auto reg = mirror::class_registry();
+    reg.add_class(a_cls);
+    reg.add_class(e_cls);
+    reg.add_class(f_cls);
+
+    auto ctx = mirror::context();
+    auto a = mirror::value(std::make_shared<A>());
+
+    CUTE_ASSERT(reg.invoke(ctx, a, "func_c", mirror::values()).as_int() == 42);
+    CUTE_ASSERT(reg.invoke(ctx, a, "func_h", mirror::values{ mirror::value(2.5) }).as_int() == 2);
+    CUTE_ASSERT(reg.invoke(ctx, a, "func_i", mirror::values{ mirror::value(int64_t(3)), mirror::value(4.5) }).as_int() == 7);
+    CUTE_ASSERT(reg.invoke(ctx, a, "func_i", mirror::values{ mirror::value(int64_t(3)), mirror::value(int64_t(4)) }).as_int() == 7); // int -> double
+    CUTE_ASSERT(reg.invoke(ctx, a, "func_i", mirror::values{ mirror::value(4.5) }).is_null());
+
+    // an inherited method on an object whose base class is not at offset 0
+    auto f_obj = std::make_shared<F>();
+    auto f = mirror::value(f_obj);
+    CUTE_ASSERT(reg.invoke(ctx, f, "get_e", mirror::values()).as_int() == 7);
+    reg.invoke(ctx, f, "set_e", mirror::values{ mirror::value(int64_t(12)) });
+    CUTE_ASSERT(f_obj->e == 12);
+
+    // integral arguments do not wrap around
+    CUTE_ASSERT_THROWS_AS(reg.invoke(ctx, f, "set_e", mirror::values{ mirror::value(int64_t(1) << 40) }), std::invalid_argument);
+    CUTE_ASSERT(f_obj->e == 12);
+    CUTE_ASSERT(mirror::convert<uint8_t>::from_value(mirror::value(int64_t(255))) == 255);
+    CUTE_ASSERT_THROWS_AS(mirror::convert<uint8_t>::from_value(mirror::value(int64_t(256))), std::invalid_argument);
+    CUTE_ASSERT_THROWS_AS(mirror::convert<unsigned>::from_value(mirror::value(int64_t(-1))), std::invalid_argument);
+    CUTE_ASSERT(mirror::convert<int16_t>::from_value(mirror::value(int64_t(-32768))) == -32768);
+    CUTE_ASSERT(mirror::convert<uint64_t>::from_value(mirror::value(INT64_MAX)) == uint64_t(INT64_MAX));
+    CUTE_ASSERT(reg.invoke(ctx, f, "describe", mirror::values{ mirror::value("e="), mirror::value(0.5) }).as_string() == "e=6");
+
+    // the method_info can be invoked directly as well
+    auto get_e = e_cls->methods[0];
+    auto e_obj = std::make_shared<E>();
+    CUTE_ASSERT(get_e->invoke(ctx, mirror::value(e_obj), mirror::values()).as_int() == 7);
+    CUTE_ASSERT(get_e->call(e_obj.get(), mirror::values()).as_int() == 7);
+
+    CUTE_ASSERT_THROWS_AS(reg.invoke(ctx, a, "func_x", mirror::values()), std::runtime_error);
+    CUTE_ASSERT_THROWS_AS(reg.invoke(ctx, a, "func_h", mirror::values{ mirror::value("2.5") }), std::invalid_argument);
+    CUTE_ASSERT_THROWS_AS(reg.invoke(ctx, mirror::value(int64_t(1)), "func_c", mirror::values()), std::invalid_argument);
+    CUTE_ASSERT_THROWS_AS(reg.invoke(ctx, mirror::value(std::make_shared<C>()), "func_c", mirror::values()), std::runtime_error); // C is not registered
+    CUTE_ASSERT_THROWS_AS(get_e->invoke(ctx, f, mirror::values()), std::invalid_argument); // F is not E
+    CUTE_ASSERT_THROWS_AS(e_cls->methods[1]->call(e_obj.get(), mirror::values()), std::invalid_argument);
+}
+
+CUTE_TEST(
+    "Test calling methods via method handles",
+    "[mirror],[method],[invoke],[method_handle]"
+) {
+    auto a_cls = mirror::make_class<A>("A");
+    a_cls->add_method<int, int, double>("func_i", &A::func_i);
+    a_cls->add_method<void, double>("func_i", &A::func_i);
+
+    auto e_cls = mirror::make_class<E>("E");
+    e_cls->add_method("get_e", &E::get_e);
+    e_cls->add_method("set_e", &E::set_e);
+    auto f_cls = mirror::make_class<F>("F", e_cls);
+
+    auto func_i = a_cls->find_method("func_i", 2);
+    CUTE_ASSERT(static_cast<bool>(func_i));
+    CUTE_ASSERT(func_i.method() == a_cls->methods[0]);
+    CUTE_ASSERT(a_cls->find_method("func_i", 1).method() == a_cls->methods[1]);
+    CUTE_ASSERT(!a_cls->find_method("func_i", 3));
+    CUTE_ASSERT(!a_cls->find_method("func_x", 0));
+
+    auto a = std::make_shared<A>();
+    auto a_val = mirror::value(a);
+    CUTE_ASSERT(func_i(a_val, mirror::values{ mirror::value(int64_t(1)), mirror::value(2.0) }).as_int() == 3);
+
+    mirror::value args[] = { mirror::value(int64_t(5)), mirror::value(6.0) };
+    CUTE_ASSERT(func_i(a_val, args).as_int() == 11);
+    CUTE_ASSERT(func_i.call(a.get(), args).as_int() == 11);
+    CUTE_ASSERT(func_i.call(a.get(), mirror::value_span(args, 2)).as_int() == 11);
+    CUTE_ASSERT_THROWS_AS(func_i.call(a.get(), mirror::value_span(args, 1)), std::invalid_argument);
+
+    // inherited methods get the object pointer adjusted
+    auto f = std::make_shared<F>();
+    auto f_val = mirror::value(f);
+    auto set_e = f_cls->find_method("set_e", 1);
+    auto get_e = f_cls->find_method("get_e", 0);
+    mirror::value v[] = { mirror::value(int64_t(99)) };
+    set_e(f_val, v);
+    CUTE_ASSERT(f->e == 99);
+    CUTE_ASSERT(get_e(f_val, mirror::value_span()).as_int() == 99);
+    CUTE_ASSERT(get_e.call(f.get(), mirror::value_span()).as_int() == 99);
+
+    CUTE_ASSERT_THROWS_AS(get_e(a_val, mirror::value_span()), std::invalid_argument);
+    CUTE_ASSERT_THROWS_AS(get_e(mirror::value(), mirror::value_span()), std::invalid_argument);
+    CUTE_ASSERT_THROWS_AS(mirror::method_handle()(f_val, mirror::value_span()), std::invalid_argument);
+}
+
+struct G : E { };
+
+CUTE_TEST(
+    "Test the inline cache of a call site",
+    "[mirror],[method],[invoke],[call_site]"
+) {
+    auto e_cls = mirror::make_class<E>("E");
+    e_cls->add_method("get_e", &E::get_e);
+    e_cls->add_method("set_e", &E::set_e);
+
+    auto reg = mirror::class_registry();
+    reg.add_class(e_cls);
+    reg.add_class(mirror::make_class<F>("F", e_cls));
+    reg.add_class(mirror::make_class<G>("G", e_cls));
+
+    auto ctx = mirror::context();
+    auto e = mirror::value(std::make_shared<E>());
+    auto f = mirror::value(std::make_shared<F>());
+    auto g = mirror::value(std::make_shared<G>());
+
+    mirror::call_site site;
+    CUTE_ASSERT(site.size() == 0);
+
+    // monomorphic
+    for(int i = 0; i < 10; ++i) {
+        CUTE_ASSERT(site.invoke(reg, ctx, e, "get_e", mirror::value_span()).as_int() == 7);
+    }
+    CUTE_ASSERT(site.misses() == 1);
+    CUTE_ASSERT(site.hits() == 9);
+    CUTE_ASSERT(site.size() == 1);
+
+    // polymorphic
+    mirror::value args[] = { mirror::value(int64_t(3)) };
+    site.reset_stats();
+    for(int i = 0; i < 10; ++i) {
+        site.invoke(reg, ctx, f, "set_e", args);
+        CUTE_ASSERT(site.invoke(reg, ctx, f, "get_e", mirror::value_span()).as_int() == 3);
+        CUTE_ASSERT(site.invoke(reg, ctx, g, "get_e", mirror::value_span()).as_int() == 7);
+    }
+    CUTE_ASSERT(site.misses() == 3);
+    CUTE_ASSERT(site.hits() == 27);
+    CUTE_ASSERT(site.size() == 4);
+
+    // megamorphic: the entries get replaced
+    site.reset_stats();
+    site.invoke(reg, ctx, e, "set_e", args);
+    CUTE_ASSERT(site.misses() == 1);
+    CUTE_ASSERT(site.size() == 4);
+
+    // modifying a class flushes the cache
+    e_cls->add_method("describe", &E::describe);
+    site.reset_stats();
+    CUTE_ASSERT(site.invoke(reg, ctx, e, "get_e", mirror::value_span()).as_int() == 3);
+    CUTE_ASSERT(site.misses() == 1);
+    CUTE_ASSERT(site.size() == 1);
+
+    // failed lookups are not cached
+    CUTE_ASSERT_THROWS_AS(site.invoke(reg, ctx, e, "get_x", mirror::value_span()), std::runtime_error);
+    CUTE_ASSERT_THROWS_AS(site.invoke(reg, ctx, mirror::value(std::make_shared<A>()), "get_e", mirror::value_span()), std::runtime_error);
+    CUTE_ASSERT_THROWS_AS(site.invoke(reg, ctx, mirror::value(), "get_e", mirror::value_span()), std::invalid_argument);
+    CUTE_ASSERT(site.size() == 1);
+}
+
+CUTE_TEST(
+    "Test reading and writing properties",
+    "[mirror],[property],[get_set]"
+) {
+    auto a_cls = mirror::make_class<A>("A");
+    a_cls->add_property("a", &A::a);
+    a_cls->add_property("a_const", &A::a_const);
+
+    auto b_cls = mirror::make_class<B>("B", a_cls);
+    b_cls->add_property("b", &B::b);
+    b_cls->add_property("a2", &B::a2);
+
+    auto c_cls = mirror::make_class<C>("C", b_cls);
+    c_cls->add_property("c", &C::c);
+
+    // A is standard-layout, so its properties are accessed via offsets
+    CUTE_ASSERT(a_cls->properties[0]->offset == static_cast<ptrdiff_t>(offsetof(A, a)));
+    CUTE_ASSERT(a_cls->properties[1]->offset == static_cast<ptrdiff_t>(offsetof(A, a_const)));
+    CUTE_ASSERT(c_cls->properties[0]->offset == -1);
+    CUTE_ASSERT(a_cls->properties[0]->owner == typeid(A));
+
+    auto a_obj = std::make_shared<A>();
+    auto a = mirror::value(a_obj);
+    CUTE_ASSERT(a_cls->get(a, "a").as_int() == 42);
+    a_cls->set(a, "a", mirror::value(int64_t(5)));
+    CUTE_ASSERT(a_obj->a == 5);
+    CUTE_ASSERT(a_cls->get(a, "a_const").as_int() == 15);
+    CUTE_ASSERT_THROWS_AS(a_cls->set(a, "a_const", mirror::value(int64_t(1))), std::logic_error);
+    CUTE_ASSERT_THROWS_AS(a_cls->set(a, "a", mirror::value("5")), std::invalid_argument);
+    CUTE_ASSERT_THROWS_AS(a_cls->get(a, "x"), std::runtime_error);
+
+    auto c_obj = std::make_shared<C>();
+    auto c = mirror::value(c_obj);
+    CUTE_ASSERT(c_cls->get(c, "a").as_int() == 42);
+    CUTE_ASSERT(c_cls->get(c, "b").as_double() == 15.10);
+    c_cls->set(c, "c", mirror::value("hello"));
+    CUTE_ASSERT(c_obj->c == "hello");
+    c_cls->set(c, "a", mirror::value(int64_t(-1)));
+    CUTE_ASSERT(c_obj->a == -1);
+
+    auto a2 = c_cls->get(c, "a2");
+    CUTE_ASSERT(a2.is_ptr_type<A>());
+    CUTE_ASSERT(a2.as_ptr<A>()->a == 42);
+    CUTE_ASSERT_THROWS_AS(c_cls->set(c, "a2", a2), std::logic_error); // A is not assignable
+
+    CUTE_ASSERT_THROWS_AS(c_cls->get(a, "a"), std::invalid_argument);
+    CUTE_ASSERT_THROWS_AS(a_cls->get(c, "a"), std::invalid_argument);
+
+    // many properties of one object
+    mirror::atom names[] = { "a", "b", "c" };
+    mirror::value out[3];
+    c_cls->get(c, names, 3, out);
+    CUTE_ASSERT(out[0].as_int() == -1);
+    CUTE_ASSERT(out[1].as_double() == 15.10);
+    CUTE_ASSERT(out[2].as_string() == "hello");
+
+    // without a member pointer there is no accessor
+    auto untyped = mirror::make_property<int>("x");
+    CUTE_ASSERT_THROWS_AS(untyped->get(a_obj.get()), std::logic_error);
+}
+
+CUTE_TEST(
+    "Test accessing properties via property handles",
+    "[mirror],[property],[get_set],[property_handle]"
+) {
+    auto e_cls = mirror::make_class<E>("E");
+    e_cls->add_property("e", &E::e);
+    auto f_cls = mirror::make_class<F>("F", e_cls);
+
+    CUTE_ASSERT(!f_cls->find_property("x"));
+    auto e = f_cls->find_property("e");
+    CUTE_ASSERT(static_cast<bool>(e));
+    CUTE_ASSERT(e.property() == e_cls->properties[0]);
+
+    // E is not at offset 0 in F
+    std::vector<std::shared_ptr<F>> objs;
+    mirror::values vals;
+    for(int i = 0; i < 5; ++i) {
+        objs.push_back(std::make_shared<F>());
+        vals.push_back(mirror::value(objs.back()));
+        e.set(vals.back(), mirror::value(int64_t(i * 10)));
+        CUTE_ASSERT(objs.back()->e == i * 10);
+    }
+    CUTE_ASSERT(e.get(vals[3]).as_int() == 30);
+    CUTE_ASSERT(e.get(static_cast<void const*>(objs[2].get())).as_int() == 20);
+    e.set(objs[2].get(), mirror::value(int64_t(21)));
+    CUTE_ASSERT(objs[2]->e == 21);
+
+    // one property of many objects
+    mirror::value out[5];
+    e.get(vals, out);
+    CUTE_ASSERT(out[0].as_int() == 0);
+    CUTE_ASSERT(out[2].as_int() == 21);
+    CUTE_ASSERT(out[4].as_int() == 40);
+
+    CUTE_ASSERT_THROWS_AS(e.get(mirror::value(std::make_shared<E>())), std::invalid_argument);
+    CUTE_ASSERT_THROWS_AS(mirror::property_handle().get(vals[0]), std::invalid_argument);
+}
+
+namespace {
+
+    enum color { red, green, blue };
+    enum class shape : uint8_t { circle = 1, square = 2 };
+
+    struct P {
+        P() : c(green), s(shape::square), ptr(nullptr), name("p") { arr[0] = arr[1] = arr[2] = 0; }
+
+        color       c;
+        shape       s;
+        int*        ptr;
+        int         arr[3];
+        char const* name;
+    };
+
+} // namespace
+
+CUTE_TEST(
+    "Test properties of enum and unsupported types",
+    "[mirror],[property],[get_set],[convert]"
+) {
+    auto cls = mirror::make_class<P>("P");
+    cls->add_property("c", &P::c);
+    cls->add_property("s", &P::s);
+    cls->add_property("ptr", &P::ptr);
+    cls->add_property("arr", &P::arr);
+    cls->add_property("name", &P::name);
+
+    auto obj = std::make_shared<P>();
+    auto p = mirror::value(obj);
+
+    // enums convert like their underlying type
+    CUTE_ASSERT(cls->get(p, "c").as_int() == 1);
+    CUTE_ASSERT(cls->get(p, "s").as_int() == 2);
+    cls->set(p, "c", mirror::value(int64_t(2)));
+    cls->set(p, "s", mirror::value(int64_t(1)));
+    CUTE_ASSERT(obj->c == blue);
+    CUTE_ASSERT((obj->s == shape::circle));
+    CUTE_ASSERT_THROWS_AS(cls->set(p, "s", mirror::value(int64_t(256))), std::invalid_argument);
+    CUTE_ASSERT_THROWS_AS(cls->set(p, "c", mirror::value("green")), std::invalid_argument);
+    CUTE_ASSERT((mirror::rank_of<shape>(mirror::value_kind::integer) == mirror::conversion_rank::exact));
+
+    // `char const*` members can only be read
+    CUTE_ASSERT(cls->get(p, "name").as_string() == "p");
+    CUTE_ASSERT_THROWS_AS(cls->set(p, "name", mirror::value("q")), std::logic_error);
+
+    // pointers to non-class types and C arrays have no accessors at all
+    for(auto name : { "ptr", "arr" }) {
+        auto prop = cls->find_property_by_name(name);
+        CUTE_ASSERT((!prop->get_thunk && !prop->set_thunk && !prop->address_thunk));
+        CUTE_ASSERT_THROWS_AS(cls->get(p, name), std::logic_error);
+        CUTE_ASSERT_THROWS_AS(cls->set(p, name, mirror::value()), std::logic_error);
+    }
+}
+
+namespace {
+
+    struct token {
+        explicit token(int v) : v(v) { }
+        token(token&& other) : v(other.v) { other.v = -1; }
+        token(token const&) = delete;
+        int v;
+    };
+
+    struct H {
+        int sum5(int a, int b, int c, int d, double e) const { return static_cast<int>(a + b + c + d + e); }
+        int take(token t) { return t.v; }
+        int sink(token&& t) { token mine(std::move(t)); return mine.v; }
+        int peek(token const& t) const noexcept { return t.v; }
+
+        int lvalue() & { return 1; }
+        int const_lvalue() const& { return 2; }
+        int rvalue() && { return 3; }
+
+        shape flip(shape s) const { return ((s == shape::circle) ? shape::square : shape::circle); }
+        int* raw() { return nullptr; }
+        size_t length(char const* s) const { return std::strlen(s); }
+    };
+
+} // namespace
+
+CUTE_TEST(
+    "Test method signatures",
+    "[mirror],[method],[invoke]"
+) {
+    auto cls = mirror::make_class<H>("H");
+    cls->add_method("sum5", &H::sum5);
+    cls->add_method("take", &H::take);
+    cls->add_method("sink", &H::sink);
+    cls->add_method("peek", &H::peek);
+    cls->add_method("lvalue", &H::lvalue);
+    cls->add_method("const_lvalue", &H::const_lvalue);
+    cls->add_method("rvalue", &H::rvalue);
+
+    auto sum5 = cls->methods[0];
+    CUTE_ASSERT(sum5->num_args == 5);
+    CUTE_ASSERT(sum5->owner == typeid(H));
+    CUTE_ASSERT(sum5->result_type == typeid(int));
+    CUTE_ASSERT(*sum5->arg_types[0] == typeid(int));
+    CUTE_ASSERT(*sum5->arg_types[4] == typeid(double));
+    CUTE_ASSERT(sum5->arg_types[5] == nullptr);
+    CUTE_ASSERT(cls->methods[2]->result_type == typeid(int));
+    CUTE_ASSERT(*cls->methods[2]->arg_types[0] == typeid(token));
+
+    mirror::value obj(std::make_shared<H>());
+    mirror::value args5[] = {
+        mirror::value(int64_t(1)), mirror::value(int64_t(2)), mirror::value(int64_t(3)),
+        mirror::value(int64_t(4)), mirror::value(0.5)
+    };
+    CUTE_ASSERT(cls->find_method("sum5", 5)(obj, args5).as_int() == 10);
+
+    // move-only arguments are moved from the objects held by the values
+    auto t = std::make_shared<token>(7);
+    mirror::value targ[] = { mirror::value(t) };
+    CUTE_ASSERT(cls->find_method("peek", 1)(obj, targ).as_int() == 7);
+    CUTE_ASSERT(t->v == 7);
+    CUTE_ASSERT(cls->find_method("take", 1)(obj, targ).as_int() == 7);
+    CUTE_ASSERT(t->v == -1);
+    t->v = 8;
+    CUTE_ASSERT(cls->find_method("sink", 1)(obj, targ).as_int() == 8);
+    CUTE_ASSERT(t->v == -1);
+
+    CUTE_ASSERT(cls->find_method("lvalue", 0)(obj, mirror::value_span()).as_int() == 1);
+    CUTE_ASSERT(cls->find_method("const_lvalue", 0)(obj, mirror::value_span()).as_int() == 2);
+    CUTE_ASSERT(cls->find_method("rvalue", 0)(obj, mirror::value_span()).as_int() == 3);
+
+    // enums convert like integers; signatures `convert` does not support
+    // can be registered, but the methods throw when called
+    cls->add_method("flip", &H::flip);
+    cls->add_method("raw", &H::raw);
+    cls->add_method("length", &H::length);
+    mirror::value sarg[] = { mirror::value(int64_t(1)) };
+    CUTE_ASSERT(cls->find_method("flip", 1)(obj, sarg).as_int() == 2);
+    CUTE_ASSERT_THROWS_AS(cls->find_method("raw", 0)(obj, mirror::value_span()), std::invalid_argument);
+    mirror::value carg[] = { mirror::value("text") };
+    CUTE_ASSERT_THROWS_AS(cls->find_method("length", 1)(obj, carg), std::invalid_argument);
+}
+
+namespace {
+
+    struct K {
+        std::string f(int64_t)      { return "int";    }
+        std::string f(double)       { return "double"; }
+        std::string f(std::string)  { return "string"; }
+        std::string f(mirror::value){ return "value";  }
+
+        std::string g(double, double)   { return "double,double"; }
+        std::string g(int, double)      { return "int,double";    }
+    };
+
+    struct L : K {
+        std::string f(bool) { return "bool"; }
+    };
+
+} // namespace
+
+CUTE_TEST(
+    "Test overload resolution by argument kinds",
+    "[mirror],[method],[invoke],[overload]"
+) {
+    auto k_cls = mirror::make_class<K>("K");
+    k_cls->add_method<std::string, int64_t>("f", &K::f);
+    k_cls->add_method<std::string, double>("f", &K::f);
+    k_cls->add_method<std::string, std::string>("f", &K::f);
+    k_cls->add_method<std::string, mirror::value>("f", &K::f);
+    k_cls->add_method<std::string, double, double>("g", &K::g);
+    k_cls->add_method<std::string, int, double>("g", &K::g);
+
+    auto l_cls = mirror::make_class<L, K>("L", k_cls);
+    l_cls->add_method("f", &L::f);
+
+    auto reg = mirror::class_registry();
+    reg.add_class(k_cls);
+    reg.add_class(l_cls);
+
+    auto ctx = mirror::context();
+    auto k = mirror::value(std::make_shared<K>());
+    auto call = [&](mirror::value const& obj, char const* m, mirror::values const& args) {
+        return reg.invoke(ctx, obj, m, args).as_string();
+    };
+
+    // exact matches win over promotions and generic arguments
+    CUTE_ASSERT(call(k, "f", { mirror::value(int64_t(1)) }) == "int");
+    CUTE_ASSERT(call(k, "f", { mirror::value(1.5) }) == "double");
+    CUTE_ASSERT(call(k, "f", { mirror::value("abc") }) == "string");
+    CUTE_ASSERT(call(k, "f", { mirror::value(true) }) == "value");
+    CUTE_ASSERT(call(k, "g", { mirror::value(int64_t(1)), mirror::value(2.0) }) == "int,double");
+    CUTE_ASSERT(call(k, "g", { mirror::value(1.0), mirror::value(int64_t(2)) }) == "double,double");
+    CUTE_ASSERT(call(k, "g", { mirror::value(int64_t(1)), mirror::value(int64_t(2)) }) == "int,double"); // one promotion instead of two
+    CUTE_ASSERT_THROWS_AS(call(k, "g", { mirror::value("a"), mirror::value(2.0) }), std::invalid_argument);
+
+    // resolved once per argument kinds
+    auto const& overloads = k_cls->members().overloads;
+    auto f_set = overloads.find(mirror::member_table::method_key("f", 1));
+    CUTE_ASSERT(overloads.count(mirror::member_table::method_key("f", 1)) == 1);
+    CUTE_ASSERT(f_set->second.candidates.size() == 4);
+    auto resolved = f_set->second.resolved.load();
+    CUTE_ASSERT(resolved && (resolved->size() == 4));
+    CUTE_ASSERT(call(k, "f", { mirror::value(int64_t(2)) }) == "int");
+    CUTE_ASSERT(f_set->second.resolved.load() == resolved); // a known signature publishes nothing
+
+    // own overloads shadow the inherited ones
+    auto l = mirror::value(std::make_shared<L>());
+    CUTE_ASSERT(call(l, "f", { mirror::value(true) }) == "bool");
+    CUTE_ASSERT_THROWS_AS(call(l, "f", { mirror::value(1.5) }), std::invalid_argument);
+    CUTE_ASSERT(call(l, "g", { mirror::value(int64_t(1)), mirror::value(2.0) }) == "int,double");
+
+    // call sites cache per argument kinds for overloaded methods
+    mirror::call_site site;
+    mirror::value a1[] = { mirror::value(int64_t(1)) };
+    mirror::value a2[] = { mirror::value(1.5) };
+    CUTE_ASSERT(site.invoke(reg, ctx, k, "f", a1).as_string() == "int");
+    CUTE_ASSERT(site.invoke(reg, ctx, k, "f", a2).as_string() == "double");
+    CUTE_ASSERT(site.invoke(reg, ctx, k, "f", a1).as_string() == "int");
+    CUTE_ASSERT(site.invoke(reg, ctx, k, "f", a2).as_string() == "double");
+    CUTE_ASSERT(site.size() == 2);
+    CUTE_ASSERT(site.hits() == 2);
+}
+
+namespace {
+
+    std::atomic<int> g_lazy_builds(0);
+
+    mirror::class_base_ptr build_lazy_a(mirror::atom const& name) {
+        ++g_lazy_builds;
+        auto a_cls = mirror::make_class<A>(name);
+        a_cls->add_method("func_c", &A::func_c);
+        return a_cls;
+    }
+
+    mirror::class_base_ptr build_lazy_h(mirror::atom const& name) { ++g_lazy_builds; return mirror::make_class<H>(name); }
+    mirror::class_base_ptr build_lazy_k(mirror::atom const& name) { ++g_lazy_builds; return mirror::make_class<K>(name); }
+    mirror::class_base_ptr build_wrong_l(mirror::atom const& name) { return mirror::make_class<K>(name); }
+
+} // namespace
+
+CUTE_TEST(
+    "Test registering classes lazily",
+    "[mirror],[register_class],[lazy]"
+) {
+    g_lazy_builds = 0;
+
+    auto reg = mirror::class_registry();
+    reg.add_lazy_class<A>("A", &build_lazy_a);
+    reg.add_class(mirror::make_class<B>("B"));
+    reg.add_lazy_class<H>("H", &build_lazy_h);
+    reg.add_lazy_class<K>("K", &build_lazy_k);
+
+    auto stats = reg.stats();
+    CUTE_ASSERT(stats.classes == 4);
+    CUTE_ASSERT(stats.lazy == 3);
+    CUTE_ASSERT(stats.materialized == 0);
+
+    // built on the first lookup, by name or by type, and only once
+    auto a_cls = reg.find_class_by_name("A");
+    CUTE_ASSERT(a_cls && (a_cls->type == typeid(A)));
+    CUTE_ASSERT(reg.find_class_by_type<A>() == a_cls);
+    CUTE_ASSERT(reg.find_class_by_name("A") == a_cls);
+    CUTE_ASSERT(g_lazy_builds == 1);
+    CUTE_ASSERT(reg.stats().materialized == 1);
+
+    // invoking builds the class of the object
+    auto ctx = mirror::context();
+    auto a = mirror::value(std::make_shared<A>());
+    CUTE_ASSERT(reg.invoke(ctx, a, "func_c", mirror::values()).as_int() == 42);
+    CUTE_ASSERT(g_lazy_builds == 1);
+
+    // a builder for a different class
+    auto bad = mirror::class_registry();
+    bad.add_lazy_class<L>("L", &build_wrong_l);
+    CUTE_ASSERT_THROWS_AS(bad.find_class_by_name("L"), std::logic_error);
+    CUTE_ASSERT(bad.stats().materialized == 0);
+
+    // concurrent lookups build a class once
+    {
+        std::vector<mirror::class_base_ptr> found(4);
+        std::vector<cute::thread> threads;
+        for(size_t i = 0; i < found.size(); ++i) {
+            threads.emplace_back([&, i]() { found[i] = reg.find_class_by_type<H>(); });
+        }
+        for(auto&& t : threads) { t.join(); }
+        for(auto&& c : found) { CUTE_ASSERT(c && (c == found[0])); }
+    }
+    CUTE_ASSERT(g_lazy_builds == 2);
+
+    // freezing and copying keep the classes lazy
+    reg.freeze();
+    auto copy = reg;
+    CUTE_ASSERT(reg.stats().materialized == 2);
+    CUTE_ASSERT(copy.stats().materialized == 2);
+    CUTE_ASSERT(copy.find_class_by_name("H") == reg.find_class_by_name("H"));
+    CUTE_ASSERT(reg.find_class_by_type<K>()->type == typeid(K));
+    CUTE_ASSERT(g_lazy_builds == 3);
+
+    // iterating over the classes builds them
+    size_t n = 0;
+    for(auto&& c : copy.classes()) { n += (c ? 1 : 0); }
+    CUTE_ASSERT(n == 4);
+    CUTE_ASSERT(copy.stats().materialized == 3);
+    CUTE_ASSERT(g_lazy_builds == 4);
+
+    // building a class neither flushes the caches of the others nor
+    // rebuilds their member tables
+    auto e_cls = mirror::make_class<E>("E");
+    e_cls->add_method("get_e", &E::get_e);
+    auto more = mirror::class_registry();
+    more.add_class(e_cls);
+    more.add_lazy_class<A>("A", &build_lazy_a);
+
+    auto e = mirror::value(std::make_shared<E>());
+    mirror::call_site site;
+    site.invoke(more, ctx, e, "get_e", mirror::value_span());
+    auto const* e_members = &e_cls->members();
+    auto epoch = mirror::class_info_base::members_epoch();
+    CUTE_ASSERT(more.find_class_by_name("A") && (g_lazy_builds == 5));
+    CUTE_ASSERT(site.invoke(more, ctx, e, "get_e", mirror::value_span()).as_int() == 7);
+    CUTE_ASSERT(site.hits() == 1);
+    CUTE_ASSERT(mirror::class_info_base::members_epoch() == epoch);
+    CUTE_ASSERT(&e_cls->members() == e_members);
+}
+
+CUTE_TEST(
+    "Test converting objects from and to values",
+    "[mirror],[property],[serialize]"
+) {
+    auto a_cls = mirror::make_class<A>("A");
+    a_cls->add_property("a", &A::a);
+    a_cls->add_property("a_const", &A::a_const);
+    auto b_cls = mirror::make_class<B>("B", a_cls);
+    b_cls->add_property("b", &B::b);
+    b_cls->add_property("b_const", &B::b_const);
+    b_cls->add_property("a2", &B::a2);
+    b_cls->add_property("a2_const", &B::a2_const);
+    auto c_cls = mirror::make_class<C>("C", b_cls);
+    c_cls->add_property("c", &C::c);
+    c_cls->add_property("c_const", &C::c_const);
+
+    auto reg = mirror::class_registry();
+    reg.add_class(a_cls);
+    reg.add_class(b_cls);
+    reg.add_class(c_cls);
+
+    auto c_obj = std::make_shared<C>();
+    c_obj->a = 1;
+    c_obj->b = 2.5;
+    c_obj->a2.a = 7;
+    c_obj->c = "x";
+
+    // inherited properties and nested objects
+    auto v = mirror::to_value(reg, mirror::value(c_obj));
+    CUTE_ASSERT(v.is_dict());
+    auto const& dict = v.as_dict();
+    CUTE_ASSERT(dict.size() == 8);
+    CUTE_ASSERT(dict.at("a").as_int() == 1);
+    CUTE_ASSERT(dict.at("a_const").as_int() == 15);
+    CUTE_ASSERT(dict.at("b").as_double() == 2.5);
+    CUTE_ASSERT(dict.at("c").as_string() == "x");
+    CUTE_ASSERT(dict.at("a2").is_dict());
+    CUTE_ASSERT(dict.at("a2").as_dict().at("a").as_int() == 7);
+    CUTE_ASSERT(dict.at("a2_const").as_dict().at("a").as_int() == 42);
+
+    // only the writable properties get assigned, nested ones in place
+    v.as_dict()["a"] = mirror::value(int64_t(3));
+    v.as_dict()["a_const"] = mirror::value(int64_t(4));
+    v.as_dict()["a2"].as_dict()["a"] = mirror::value(int64_t(8));
+    v.as_dict()["a2_const"].as_dict()["a"] = mirror::value(int64_t(9));
+    v.as_dict().erase("c");
+
+    auto c2_obj = std::make_shared<C>();
+    c2_obj->c = "y";
+    mirror::from_value(reg, v, mirror::value(c2_obj));
+    CUTE_ASSERT(c2_obj->a == 3);
+    CUTE_ASSERT(c2_obj->a_const == 15);
+    CUTE_ASSERT(c2_obj->b == 2.5);
+    CUTE_ASSERT(c2_obj->a2.a == 8);
+    CUTE_ASSERT(c2_obj->a2_const.a == 42);
+    CUTE_ASSERT(c2_obj->c == "y");
+
+    // compiled once per class, until a class gets modified
+    auto const& codec = c_cls->codec(reg);
+    CUTE_ASSERT(&c_cls->codec(reg) == &codec);
+    CUTE_ASSERT(codec.steps.size() == 8);
+    CUTE_ASSERT(codec.upcasts.size() == 3);
+    c_cls->add_property("c_extra", &C::c);
+    CUTE_ASSERT(c_cls->codec(reg).steps.size() == 9);
+
+    // members become nested dicts once their class gets registered, no
+    // matter in which order things happen
+    auto late = mirror::class_registry();
+    late.add_class(b_cls);
+    late.add_class(c_cls);
+    CUTE_ASSERT(mirror::to_value(late, mirror::value(c_obj)).as_dict().at("a2").is_ptr_type<A>());
+    auto generation = late.generation();
+    late.add_class(a_cls);
+    CUTE_ASSERT(late.generation() != generation);
+    CUTE_ASSERT(mirror::to_value(late, mirror::value(c_obj)).as_dict().at("a2").as_dict().at("a").as_int() == 7);
+
+    // ... and stop being ones if it is gone (the codec does not dangle)
+    late = mirror::class_registry();
+    late.add_class(c_cls);
+    CUTE_ASSERT(mirror::to_value(late, mirror::value(c_obj)).as_dict().at("a2").is_ptr_type<A>());
+
+    CUTE_ASSERT_THROWS_AS(mirror::from_value(reg, mirror::value(int64_t(1)), mirror::value(c2_obj)), std::invalid_argument);
+    CUTE_ASSERT_THROWS_AS(mirror::to_value(reg, mirror::value(std::make_shared<E>())), std::runtime_error);
+    CUTE_ASSERT_THROWS_AS(mirror::to_value(reg, mirror::value(int64_t(1))), std::invalid_argument);
 }
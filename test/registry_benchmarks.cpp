@@ -0,0 +1,435 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "bench.hpp"
+
+#include <mirror-cpp/mirror.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    struct dummy { int x; };
+
+    struct vec3 { double x, y, z; };
+
+    struct particle {
+        int64_t     id;
+        double      mass;
+        std::string name;
+        vec3        pos;
+        vec3        vel;
+    };
+
+    struct counter {
+        int64_t total = 0;
+        int64_t add(int64_t a, double b) { total += a + static_cast<int64_t>(b); return total; }
+    };
+
+    std::vector<mirror::atom> make_names(size_t n) {
+        std::vector<mirror::atom> names;
+        for(size_t i = 0; i < n; ++i) { names.push_back(mirror::atom(("class_" + std::to_string(i)).c_str())); }
+        return names;
+    }
+
+} // namespace
+
+BENCHMARK(class_registry) {
+    const size_t n = 5000;
+    auto names = make_names(n);
+
+    mirror::class_registry reg;
+    auto secs = bench::measure([&]() {
+        reg = mirror::class_registry();
+        for(auto&& name : names) { reg.add_class(mirror::make_class<dummy>(name)); }
+    }, 1);
+    bench::report_ops("add_class", secs, n);
+
+    std::vector<mirror::atom> lookups;
+    for(size_t i = 0; i < 10000; ++i) { lookups.push_back(names[(i * 7919) % n]); }
+
+    secs = bench::measure([&]() {
+        size_t found = 0;
+        for(auto&& name : lookups) { found += (reg.find_class_by_name(name) ? 1 : 0); }
+        bench::do_not_optimize(found);
+    }, 10);
+    bench::report_ops("find_class_by_name (hashed)", secs, lookups.size());
+
+    // the former linear lookup, for comparison
+    auto classes = reg.classes();
+    secs = bench::measure([&]() {
+        size_t found = 0;
+        for(auto&& name : lookups) {
+            auto it = std::find_if(classes.begin(), classes.end(), [&](mirror::class_base_ptr const& c) { return (c->name == name); });
+            found += ((it != classes.end()) ? 1 : 0);
+        }
+        bench::do_not_optimize(found);
+    }, 1);
+    bench::report_ops("find_class_by_name (linear scan)", secs, lookups.size());
+
+    secs = bench::measure([&]() {
+        size_t found = 0;
+        for(size_t i = 0; i < lookups.size(); ++i) { found += (reg.find_class_by_type<dummy>() ? 1 : 0); }
+        bench::do_not_optimize(found);
+    }, 10);
+    bench::report_ops("find_class_by_type", secs, lookups.size());
+}
+
+BENCHMARK(frozen_registry) {
+    for(size_t n : { size_t(1000), size_t(100000) }) {
+        auto names = make_names(n);
+
+        mirror::class_registry live;
+        for(auto&& name : names) { live.add_class(mirror::make_class<dummy>(name)); }
+
+        mirror::class_registry frozen = live;
+        auto secs = bench::measure([&]() { auto copy = live; copy.freeze(); }, 1);
+        frozen.freeze();
+        std::printf("  %zu classes\n", n);
+        bench::report_ops("freeze", secs, n);
+
+        std::vector<mirror::atom> lookups;
+        for(size_t i = 0; i < 10000; ++i) { lookups.push_back(names[(i * 7919) % n]); }
+
+        for(auto* reg : { &live, &frozen }) {
+            secs = bench::measure([&]() {
+                size_t found = 0;
+                for(auto&& name : lookups) { found += (reg->find_class_by_name(name) ? 1 : 0); }
+                bench::do_not_optimize(found);
+            }, 10);
+            bench::report_ops(reg->frozen() ? "find_class_by_name (frozen)" : "find_class_by_name (live)", secs, lookups.size());
+        }
+
+        for(auto* reg : { &live, &frozen }) {
+            secs = bench::measure([&]() {
+                size_t found = 0;
+                for(size_t i = 0; i < lookups.size(); ++i) { found += (reg->find_class_by_type<dummy>() ? 1 : 0); }
+                bench::do_not_optimize(found);
+            }, 10);
+            bench::report_ops(reg->frozen() ? "find_class_by_type (frozen)" : "find_class_by_type (live)", secs, lookups.size());
+        }
+    }
+}
+
+BENCHMARK(member_lookup) {
+    // an 8 level deep hierarchy with 8 properties per level
+    const size_t levels = 8, props = 8;
+    std::vector<mirror::atom> names;
+    mirror::class_base_ptr leaf;
+    for(size_t l = 0; l < levels; ++l) {
+        auto c = mirror::make_class<dummy>(("level_" + std::to_string(l)).c_str(), leaf);
+        for(size_t p = 0; p < props; ++p) {
+            names.push_back(mirror::atom(("prop_" + std::to_string(l) + "_" + std::to_string(p)).c_str()));
+            c->add_property(names.back(), &dummy::x);
+        }
+        leaf = c;
+    }
+
+    std::vector<mirror::atom> lookups;
+    for(size_t i = 0; i < 10000; ++i) { lookups.push_back(names[(i * 7919) % names.size()]); }
+
+    // the former lookup: a linear scan per level of the hierarchy
+    auto secs = bench::measure([&]() {
+        size_t found = 0;
+        for(auto&& name : lookups) {
+            for(auto c = leaf.get(); c; c = c->base_class.get()) {
+                if(c->find_property_by_name(name)) { ++found; break; }
+            }
+        }
+        bench::do_not_optimize(found);
+    }, 10);
+    bench::report_ops("find_property_by_name (per level scan)", secs, lookups.size());
+
+    secs = bench::measure([&]() {
+        size_t found = 0;
+        for(auto&& name : lookups) { found += (leaf->find_property_by_name(name, true) ? 1 : 0); }
+        bench::do_not_optimize(found);
+    }, 10);
+    bench::report_ops("find_property_by_name (flattened)", secs, lookups.size());
+}
+
+BENCHMARK(method_invoke) {
+    const size_t n = 100000;
+
+    auto cls = mirror::make_class<counter>("counter");
+    cls->add_method("add", &counter::add);
+    mirror::class_registry reg;
+    reg.add_class(cls);
+
+    auto obj = std::make_shared<counter>();
+    auto obj_val = mirror::value(obj);
+    auto args = mirror::values{ mirror::value(int64_t(1)), mirror::value(2.0) };
+    mirror::context ctx;
+    mirror::atom add("add");
+
+    // keeps the compiler from inlining the direct call
+    int64_t (counter::* volatile direct)(int64_t, double) = &counter::add;
+    auto secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { bench::do_not_optimize(((*obj).*direct)(1, 2.0)); }
+    }, 10);
+    bench::report_ops("direct call", secs, n);
+
+    std::function<mirror::value(counter&, mirror::values const&)> func = [](counter& c, mirror::values const& a) {
+        return mirror::value(c.add(a[0].as_int(), a[1].as_double()));
+    };
+    secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { bench::do_not_optimize(func(*obj, args)); }
+    }, 10);
+    bench::report_ops("std::function with values", secs, n);
+
+    auto m = cls->methods[0];
+    secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { bench::do_not_optimize(m->call(obj.get(), args)); }
+    }, 10);
+    bench::report_ops("method_info::call", secs, n);
+
+    auto handle = cls->find_method(add, 2);
+    secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { bench::do_not_optimize(handle(obj_val, args)); }
+    }, 10);
+    bench::report_ops("method_handle", secs, n);
+
+    mirror::value arg_array[] = { mirror::value(int64_t(1)), mirror::value(2.0) };
+    secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { bench::do_not_optimize(handle.call(obj.get(), arg_array)); }
+    }, 10);
+    bench::report_ops("method_handle::call, argument array", secs, n);
+
+    secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { bench::do_not_optimize(cls->invoke(ctx, obj_val, add, args)); }
+    }, 10);
+    bench::report_ops("class_info::invoke", secs, n);
+
+    secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { bench::do_not_optimize(reg.invoke(ctx, obj_val, add, args)); }
+    }, 10);
+    bench::report_ops("class_registry::invoke", secs, n);
+
+    mirror::call_site site;
+    secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { bench::do_not_optimize(site.invoke(reg, ctx, obj_val, add, arg_array)); }
+    }, 10);
+    bench::report_ops("call_site::invoke", secs, n);
+    std::printf("  call site: %zu hits, %zu misses\n", site.hits(), site.misses());
+}
+
+BENCHMARK(property_access) {
+    const size_t n = 100000;
+
+    auto cls = mirror::make_class<counter>("counter");
+    cls->add_property("total", &counter::total);
+
+    std::vector<std::shared_ptr<counter>> objs;
+    mirror::values vals;
+    for(size_t i = 0; i < 1000; ++i) {
+        objs.push_back(std::make_shared<counter>());
+        objs.back()->total = static_cast<int64_t>(i);
+        vals.push_back(mirror::value(objs.back()));
+    }
+
+    auto secs = bench::measure([&]() {
+        int64_t sum = 0;
+        for(size_t i = 0; i < n; ++i) { sum += objs[i % objs.size()]->total; }
+        bench::do_not_optimize(sum);
+    }, 10);
+    bench::report_ops("direct read", secs, n);
+
+    mirror::atom total("total");
+    secs = bench::measure([&]() {
+        int64_t sum = 0;
+        for(size_t i = 0; i < n; ++i) { sum += cls->get(vals[i % vals.size()], total).as_int(); }
+        bench::do_not_optimize(sum);
+    }, 10);
+    bench::report_ops("class_info::get by name", secs, n);
+
+    auto handle = cls->find_property(total);
+    secs = bench::measure([&]() {
+        int64_t sum = 0;
+        for(size_t i = 0; i < n; ++i) { sum += handle.get(vals[i % vals.size()]).as_int(); }
+        bench::do_not_optimize(sum);
+    }, 10);
+    bench::report_ops("property_handle::get", secs, n);
+
+    std::vector<mirror::value> out(vals.size());
+    secs = bench::measure([&]() {
+        int64_t sum = 0;
+        for(size_t i = 0; i < n; i += vals.size()) {
+            handle.get(vals, out.data());
+            for(auto&& v : out) { sum += v.as_int(); }
+        }
+        bench::do_not_optimize(sum);
+    }, 10);
+    bench::report_ops("property_handle::get, batched", secs, n);
+
+    secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { handle.set(vals[i % vals.size()], mirror::value(static_cast<int64_t>(i))); }
+    }, 10);
+    bench::report_ops("property_handle::set", secs, n);
+}
+
+// readers never lock, so lookups scale with the number of threads even
+// while classes get registered; uses std::thread since cute::thread needs a
+// running unit test
+BENCHMARK(concurrent_registry) {
+    const size_t n = 10000;
+    const size_t lookups_per_thread = 1000000;
+    auto names = make_names(2 * n);
+
+    for(size_t num_readers : { size_t(1), size_t(2), size_t(4) }) {
+        for(bool writing : { false, true }) {
+            mirror::class_registry reg;
+            for(size_t i = 0; i < n; ++i) { reg.add_class(mirror::make_class<dummy>(names[i])); }
+
+            // only the lookups are timed
+            std::atomic<bool> stop(false);
+            std::thread writer([&]() {
+                for(size_t i = n; writing && !stop && (i < names.size()); ++i) { reg.add_class(mirror::make_class<dummy>(names[i])); }
+            });
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> readers;
+            for(size_t t = 0; t < num_readers; ++t) {
+                readers.emplace_back([&, t]() {
+                    size_t found = 0;
+                    for(size_t i = 0; i < lookups_per_thread; ++i) { found += (reg.find_class_by_name(names[(i * 7919 + t) % n]) ? 1 : 0); }
+                    bench::do_not_optimize(found);
+                });
+            }
+            for(auto&& r : readers) { r.join(); }
+            auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            stop = true;
+            writer.join();
+
+            std::printf("  %zu reader(s)%s\n", num_readers, (writing ? ", 1 writer" : ""));
+            bench::report_ops("find_class_by_name", secs, num_readers * lookups_per_thread);
+        }
+    }
+}
+
+// startup cost of registering classes eagerly vs. lazily, and of building
+// the lazily registered ones on first use
+BENCHMARK(lazy_registry) {
+    const size_t n = 5000;
+    auto names = make_names(n);
+
+    auto build = [](mirror::atom const& name) -> mirror::class_base_ptr {
+        auto cls = mirror::make_class<counter>(name);
+        cls->add_property("total", &counter::total);
+        cls->add_method("add", &counter::add);
+        return cls;
+    };
+
+    auto secs = bench::measure([&]() {
+        mirror::class_registry reg;
+        for(auto&& name : names) { reg.add_class(build(name)); }
+    }, 1);
+    bench::report_ops("add_class", secs, n);
+
+    secs = bench::measure([&]() {
+        mirror::class_registry reg;
+        for(auto&& name : names) { reg.add_lazy_class<counter>(name, build); }
+    }, 1);
+    bench::report_ops("add_lazy_class", secs, n);
+
+    // lookups of the 10% of the classes actually used
+    secs = bench::measure([&]() {
+        mirror::class_registry reg;
+        for(auto&& name : names) { reg.add_lazy_class<counter>(name, build); }
+        size_t found = 0;
+        for(size_t i = 0; i < n; i += 10) { found += (reg.find_class_by_name(names[i]) ? 1 : 0); }
+        bench::do_not_optimize(found);
+    }, 1);
+    bench::report_ops("add_lazy_class, 10% used", secs, n);
+
+    mirror::class_registry reg;
+    for(auto&& name : names) { reg.add_lazy_class<counter>(name, build); }
+    for(size_t i = 0; i < n; i += 10) { reg.find_class_by_name(names[i]); }
+    secs = bench::measure([&]() {
+        size_t found = 0;
+        for(size_t i = 0; i < n; i += 10) { found += (reg.find_class_by_name(names[i]) ? 1 : 0); }
+        bench::do_not_optimize(found);
+    }, 100);
+    bench::report_ops("find_class_by_name, built", secs, n / 10);
+
+    auto stats = reg.stats();
+    std::printf("  %zu classes, %zu lazy, %zu materialized\n", stats.classes, stats.lazy, stats.materialized);
+}
+
+BENCHMARK(serialize) {
+    auto vec3_cls = mirror::make_class<vec3>("vec3");
+    vec3_cls->add_property("x", &vec3::x);
+    vec3_cls->add_property("y", &vec3::y);
+    vec3_cls->add_property("z", &vec3::z);
+    auto particle_cls = mirror::make_class<particle>("particle");
+    particle_cls->add_property("id", &particle::id);
+    particle_cls->add_property("mass", &particle::mass);
+    particle_cls->add_property("name", &particle::name);
+    particle_cls->add_property("pos", &particle::pos);
+    particle_cls->add_property("vel", &particle::vel);
+
+    mirror::class_registry reg;
+    reg.add_class(vec3_cls);
+    reg.add_class(particle_cls);
+
+    const size_t n = 100000;
+    auto p = std::make_shared<particle>();
+    p->id = 1; p->mass = 2.0; p->name = "p"; p->pos = vec3{ 1, 2, 3 }; p->vel = vec3{ 4, 5, 6 };
+    auto obj = mirror::value(p);
+
+    // the per property walk by name, for comparison
+    std::vector<mirror::atom> names = { "id", "mass", "name", "pos", "vel" };
+    std::vector<mirror::atom> vec_names = { "x", "y", "z" };
+    auto secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) {
+            auto res = mirror::value::dict();
+            for(auto&& name : names) {
+                auto v = particle_cls->get(obj, name);
+                if(v.is_ptr()) {
+                    auto nested = mirror::value::dict();
+                    for(auto&& vn : vec_names) { nested.as_dict()[vn] = vec3_cls->get(v, vn); }
+                    v = nested;
+                }
+                res.as_dict()[name] = v;
+            }
+            bench::do_not_optimize(res);
+        }
+    }, 1);
+    bench::report_ops("to_value, by name", secs, n);
+
+    secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { bench::do_not_optimize(mirror::to_value(reg, obj)); }
+    }, 1);
+    bench::report_ops("to_value, codec", secs, n);
+
+    auto v = mirror::to_value(reg, obj);
+    secs = bench::measure([&]() {
+        for(size_t i = 0; i < n; ++i) { mirror::from_value(reg, v, obj); }
+    }, 1);
+    bench::report_ops("from_value, codec", secs, n);
+}
@@ -0,0 +1,418 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 by Konstantin (Kosta) Baumann & Autodesk Inc.
+//
+// Permission is hereby granted, free of charge,  to any person obtaining a copy of
+// this software and  associated documentation  files  (the "Software"), to deal in
+// the  Software  without  restriction,  including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software,  and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this  permission notice  shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE  SOFTWARE  IS  PROVIDED  "AS IS",  WITHOUT  WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE  AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE  LIABLE FOR ANY CLAIM,  DAMAGES OR OTHER LIABILITY, WHETHER
+// IN  AN  ACTION  OF  CONTRACT,  TORT  OR  OTHERWISE,  ARISING  FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <cute/cute.hpp>
+
+#include <mirror-cpp/value.hpp>
+
+#include <atomic>
+#include <map>
+#include <thread>
+#include <vector>
+
+CUTE_TEST(
+    "Test scalar values are stored inline",
+    "[value],[scalar]"
+) {
+    auto n = mirror::value();
+    CUTE_ASSERT(n.is_null());
+    CUTE_ASSERT(!n.m_obj);
+
+    auto b = mirror::value(true);
+    CUTE_ASSERT(b.is_bool());
+    CUTE_ASSERT(!b.is_null());
+    CUTE_ASSERT(!b.is_ptr());
+    CUTE_ASSERT(!b.m_obj);
+    CUTE_ASSERT(b.as_bool() == true);
+
+    auto i = mirror::value(static_cast<int64_t>(-42));
+    CUTE_ASSERT(i.is_int());
+    CUTE_ASSERT(!i.is_ptr());
+    CUTE_ASSERT(!i.m_obj);
+    CUTE_ASSERT(i.as_int() == -42);
+    CUTE_ASSERT(i.as_double() == 0.0);
+
+    auto d = mirror::value(3.25);
+    CUTE_ASSERT(d.is_double());
+    CUTE_ASSERT(!d.is_ptr());
+    CUTE_ASSERT(!d.m_obj);
+    CUTE_ASSERT(d.as_double() == 3.25);
+    CUTE_ASSERT(d.as_int() == 0);
+}
+
+CUTE_TEST(
+    "Test heap backed values",
+    "[value],[string],[array],[dict],[ptr]"
+) {
+    auto s = mirror::value("Hello world");
+    CUTE_ASSERT(s.is_string());
+    CUTE_ASSERT(s.as_string() == "Hello world");
+    CUTE_ASSERT(mirror::value(static_cast<char const*>(nullptr)).is_null());
+
+    auto a = mirror::value::array();
+    a.as_array().emplace_back(static_cast<int64_t>(1));
+    a.as_array().emplace_back(2.5);
+    CUTE_ASSERT(a.is_array());
+    CUTE_ASSERT(a.as_array().size() == 2);
+    CUTE_ASSERT(a.as_array()[0].as_int() == 1);
+    CUTE_ASSERT(a.as_array()[1].as_double() == 2.5);
+
+    auto d = mirror::value();
+    d.as_dict()["key"] = mirror::value(true);
+    CUTE_ASSERT(d.is_dict());
+    CUTE_ASSERT(d.as_dict().size() == 1);
+    CUTE_ASSERT(d.as_dict()["key"].as_bool());
+
+    auto p = mirror::value(std::make_shared<int>(7));
+    CUTE_ASSERT(p.is_ptr());
+    CUTE_ASSERT(p.is_ptr_type<int>());
+    CUTE_ASSERT(!p.is_ptr_type<double>());
+    CUTE_ASSERT(*p.as_ptr<int>() == 7);
+    CUTE_ASSERT(mirror::value(std::shared_ptr<int>()).is_null());
+}
+
+namespace {
+    struct kind_name_visitor {
+        std::string operator()(std::nullptr_t)                                      const { return "null";   }
+        std::string operator()(bool)                                                const { return "bool";   }
+        std::string operator()(int64_t)                                             const { return "int";    }
+        std::string operator()(double)                                              const { return "double"; }
+        std::string operator()(std::string const&)                                  const { return "string"; }
+        std::string operator()(mirror::value::array_t const&)                       const { return "array";  }
+        std::string operator()(mirror::value::dict_t const&)                        const { return "dict";   }
+        std::string operator()(mirror::value::int_array_t const&)                   const { return "ints";   }
+        std::string operator()(mirror::value::double_array_t const&)                const { return "doubles";}
+        std::string operator()(mirror::value::bool_array_t const&)                  const { return "bools";  }
+        std::string operator()(mirror::string_ref)                                  const { return "string_ref"; }
+        std::string operator()(std::shared_ptr<void> const&, std::type_info const&) const { return "object"; }
+    };
+}
+
+CUTE_TEST(
+    "Test value kind tag and visit",
+    "[value],[kind],[visit]"
+) {
+    CUTE_ASSERT((mirror::value().kind()                              == mirror::value_kind::null));
+    CUTE_ASSERT((mirror::value(false).kind()                         == mirror::value_kind::boolean));
+    CUTE_ASSERT((mirror::value(static_cast<int64_t>(1)).kind()       == mirror::value_kind::integer));
+    CUTE_ASSERT((mirror::value(1.0).kind()                           == mirror::value_kind::floating));
+    CUTE_ASSERT((mirror::value("s").kind()                           == mirror::value_kind::string));
+    CUTE_ASSERT((mirror::value::array().kind()                       == mirror::value_kind::array));
+    CUTE_ASSERT((mirror::value::dict().kind()                        == mirror::value_kind::dict));
+    CUTE_ASSERT((mirror::value(std::make_shared<int>(1)).kind()      == mirror::value_kind::object));
+
+    auto vis = kind_name_visitor();
+    CUTE_ASSERT(mirror::value().visit(vis)                          == "null");
+    CUTE_ASSERT(mirror::value(true).visit(vis)                      == "bool");
+    CUTE_ASSERT(mirror::value(static_cast<int64_t>(1)).visit(vis)   == "int");
+    CUTE_ASSERT(mirror::value(1.0).visit(vis)                       == "double");
+    CUTE_ASSERT(mirror::value("s").visit(vis)                       == "string");
+    CUTE_ASSERT(mirror::value::array().visit(vis)                   == "array");
+    CUTE_ASSERT(mirror::value::dict().visit(vis)                    == "dict");
+    CUTE_ASSERT(mirror::value(std::make_shared<int>(1)).visit(vis)  == "object");
+    CUTE_ASSERT(mirror::value::int_array().visit(vis)               == "ints");
+    CUTE_ASSERT(mirror::value::double_array().visit(vis)            == "doubles");
+    CUTE_ASSERT(mirror::value::bool_array().visit(vis)              == "bools");
+    CUTE_ASSERT(mirror::value::borrow_string("s", 1).visit(vis)     == "string_ref");
+
+    auto p = mirror::value(std::make_shared<int>(1));
+    CUTE_ASSERT(*p.m_type == typeid(int));
+}
+
+CUTE_TEST(
+    "Test dict lookup, ordering and erase",
+    "[value],[dict]"
+) {
+    for(auto n : { 5, 100 }) { // small (binary search) and large (hash indexed) dicts
+        auto d = mirror::value::dict();
+        auto& dict = d.as_dict();
+        for(int i = n - 1; i >= 0; --i) {
+            dict[std::to_string(1000 + i)] = mirror::value(static_cast<int64_t>(i));
+        }
+        CUTE_ASSERT(dict.size() == static_cast<size_t>(n));
+
+        // iteration is ordered by the characters of the keys
+        auto prev = mirror::atom();
+        for(auto&& kv : d.as_dict()) {
+            CUTE_ASSERT(prev < kv.first);
+            CUTE_ASSERT(prev.str() < kv.first.str());
+            CUTE_ASSERT(kv.first == std::to_string(1000 + kv.second.as_int()));
+            prev = kv.first;
+        }
+
+        for(int i = 0; i < n; ++i) {
+            auto it = dict.find(std::to_string(1000 + i));
+            CUTE_ASSERT((it != dict.end()));
+            CUTE_ASSERT(it->second.as_int() == i);
+        }
+        CUTE_ASSERT((dict.find("missing") == dict.end()));
+        CUTE_ASSERT(dict.count("missing") == 0);
+
+        CUTE_ASSERT(dict.erase(std::to_string(1000)) == 1);
+        CUTE_ASSERT(dict.erase(std::to_string(1000)) == 0);
+        CUTE_ASSERT(dict.count(std::to_string(1000)) == 0);
+        CUTE_ASSERT(dict.at(std::to_string(1001)).as_int() == 1);
+        CUTE_ASSERT(dict.size() == static_cast<size_t>(n - 1));
+        CUTE_ASSERT_THROWS_AS(dict.at("missing"), std::out_of_range);
+    }
+
+    // the order does not depend on the order the keys got interned in
+    auto z = mirror::atom("zz: interned first");
+    auto a = mirror::atom("aa: interned second");
+    auto d = mirror::value::dict();
+    d.as_dict()[z] = mirror::value(true);
+    d.as_dict()[a] = mirror::value(false);
+    CUTE_ASSERT(a < z);
+    CUTE_ASSERT(!(z < a));
+    CUTE_ASSERT(!(a < a));
+    CUTE_ASSERT(d.as_dict().begin()->first == a);
+
+#if !defined(MIRROR_CPP_DICT_STD_MAP)
+    // looking up a string key does not intern it
+    auto found = mirror::atom();
+    CUTE_ASSERT((d.as_dict().find("a key which is only looked up") == d.as_dict().end()));
+    CUTE_ASSERT(d.as_dict().count(std::string("another key which is only looked up")) == 0);
+    CUTE_ASSERT_THROWS_AS(static_cast<mirror::value const&>(d).as_dict().at("a third key which is only looked up"), std::out_of_range);
+    CUTE_ASSERT(!mirror::atom::find("a key which is only looked up", found));
+    CUTE_ASSERT(!mirror::atom::find("another key which is only looked up", found));
+    CUTE_ASSERT(!mirror::atom::find("a third key which is only looked up", found));
+#endif // !defined(MIRROR_CPP_DICT_STD_MAP)
+    CUTE_ASSERT(d.as_dict().find("zz: interned first")->second.as_bool());
+}
+
+CUTE_TEST(
+    "Test many inserts and erases on a large dict",
+    "[value],[dict]"
+) {
+    auto d = mirror::value::dict();
+    auto& dict = d.as_dict();
+    auto expected = std::map<mirror::atom, int64_t>();
+
+    auto rnd = uint32_t(12345);
+    auto next = [&]() { rnd = rnd * 1103515245u + 12345u; return ((rnd >> 8) % 2000); };
+
+    for(int i = 0; i < 20000; ++i) {
+        auto key = mirror::atom("key_" + std::to_string(next()));
+        if(i % 3 == 2) {
+            CUTE_ASSERT(dict.erase(key) == expected.erase(key));
+        } else {
+            dict[key] = mirror::value(static_cast<int64_t>(i));
+            expected[key] = i;
+        }
+
+        if(i % 1000 == 999) {
+            CUTE_ASSERT(dict.size() == expected.size());
+            auto it = expected.begin();
+            for(auto&& kv : dict) {
+                CUTE_ASSERT(kv.first == it->first);
+                CUTE_ASSERT(kv.second.as_int() == it->second);
+                ++it;
+            }
+            for(auto&& kv : expected) {
+                CUTE_ASSERT(dict.at(kv.first).as_int() == kv.second);
+            }
+        }
+    }
+
+    // shrinking below the hash threshold falls back to the binary search
+    while(dict.size() > 3) { dict.erase(dict.begin()->first); expected.erase(expected.begin()); }
+    for(auto&& kv : expected) { CUTE_ASSERT(dict.at(kv.first).as_int() == kv.second); }
+    CUTE_ASSERT(dict.count("key_not_there") == 0);
+}
+
+CUTE_TEST(
+    "Test interning atoms",
+    "[value],[atom]"
+) {
+    auto a1 = mirror::atom("key");
+    auto a2 = mirror::atom(std::string("key"));
+    auto b  = mirror::atom("other key");
+
+    CUTE_ASSERT(a1 == a2);
+    CUTE_ASSERT(a1.id() == a2.id());
+    CUTE_ASSERT(&a1.str() == &a2.str());
+    CUTE_ASSERT(a1 != b);
+    CUTE_ASSERT(a1 == "key");
+    CUTE_ASSERT(a1.str() == "key");
+
+    CUTE_ASSERT(mirror::atom().empty());
+    CUTE_ASSERT(mirror::atom("") == mirror::atom());
+    CUTE_ASSERT(mirror::atom().id() == 0);
+    CUTE_ASSERT(a1.id() > 0);
+
+    auto found = mirror::atom();
+    CUTE_ASSERT(mirror::atom::find("key", found));
+    CUTE_ASSERT(found == a1);
+    CUTE_ASSERT(!mirror::atom::find("a key that has never been interned", found));
+
+    // lookups by (pointer, length) need no terminated string
+    auto text = std::string("key and more");
+    CUTE_ASSERT(mirror::atom::find(text.data(), 3, found));
+    CUTE_ASSERT(found == a1);
+    CUTE_ASSERT(mirror::atom(text.data(), 3) == a1);
+}
+
+CUTE_TEST(
+    "Test looking up atoms while others are interned",
+    "[value],[atom],[threads]"
+) {
+    auto name = [](int i) { return "concurrent atom #" + std::to_string(i); };
+
+    // the readers look up existing atoms while the writer grows the table
+    auto known = std::vector<mirror::atom>();
+    for(int i = 0; i < 100; ++i) { known.emplace_back(name(i)); }
+
+    std::atomic<bool> done(false);
+    std::atomic<int> failures(0);
+    auto readers = std::vector<std::thread>();
+    for(int t = 0; t < 2; ++t) {
+        readers.emplace_back([&]() {
+            while(!done.load()) {
+                for(int i = 0; i < 100; ++i) {
+                    auto found = mirror::atom();
+                    auto s = name(i);
+                    if(!mirror::atom::find(s, found) || (found != known[i]) || (mirror::atom(s) != known[i])) { ++failures; }
+                }
+            }
+        });
+    }
+
+    for(int i = 100; i < 20000; ++i) { mirror::atom(name(i)); }
+    done.store(true);
+    for(auto&& t : readers) { t.join(); }
+
+    CUTE_ASSERT(failures.load() == 0);
+    for(int i = 0; i < 20000; ++i) {
+        auto found = mirror::atom();
+        CUTE_ASSERT(mirror::atom::find(name(i), found));
+        CUTE_ASSERT(found.str() == name(i));
+    }
+}
+
+CUTE_TEST(
+    "Test building a value tree in an arena",
+    "[value],[arena]"
+) {
+    mirror::value_arena arena(4096);
+    CUTE_ASSERT(arena.chunk_count() == 0);
+    {
+        auto root = mirror::value::array(&arena);
+        for(int i = 0; i < 100; ++i) {
+            auto d = mirror::value::dict(&arena);
+            d.as_dict()["index"] = mirror::value(static_cast<int64_t>(i));
+            d.as_dict()["name"]  = mirror::value("item", &arena);
+            root.as_array().emplace_back(std::move(d));
+        }
+
+        CUTE_ASSERT(root.as_array().get_allocator().arena() == &arena);
+        CUTE_ASSERT(root.as_array().size() == 100);
+        CUTE_ASSERT(root.as_array()[42].as_dict().at("index").as_int() == 42);
+        CUTE_ASSERT(root.as_array()[42].as_dict().at("name").is_string_ref());
+        CUTE_ASSERT(root.as_array()[42].as_dict().at("name").as_string_ref() == "item");
+        CUTE_ASSERT(arena.chunk_count() > 1);
+    }
+
+    // strings of any length keep their characters in the arena and are
+    // not reference counted
+    {
+        auto text = std::string(5000, 'x'); // bigger than a chunk
+        auto used = arena.bytes_reserved();
+        auto s = mirror::value(text, &arena);
+        CUTE_ASSERT(s.is_string_ref());
+        CUTE_ASSERT(s.as_string_ref() == text);
+        CUTE_ASSERT(s.m_obj.use_count() == 0);
+        CUTE_ASSERT(mirror::value(text.c_str(), &arena).as_string_ref() == text);
+        CUTE_ASSERT(mirror::value::copy_string(text.data(), 10, &arena).as_string_ref() == text.substr(0, 10));
+        CUTE_ASSERT(arena.bytes_reserved() > used);
+
+        // without an arena strings are owned
+        CUTE_ASSERT(mirror::value::copy_string(text.data(), 10).is_string());
+        CUTE_ASSERT(mirror::value(text).as_string() == text);
+    }
+
+    // oversized allocations get their own chunk
+    auto before = arena.chunk_count();
+    CUTE_ASSERT(arena.allocate(10000, 8) != nullptr);
+    CUTE_ASSERT(arena.chunk_count() == before + 1);
+
+    arena.release();
+    CUTE_ASSERT(arena.chunk_count() == 0);
+    CUTE_ASSERT(arena.bytes_reserved() == 0);
+}
+
+CUTE_TEST(
+    "Test typed arrays and promotion to a generic array",
+    "[value],[typed_array]"
+) {
+    auto ints = mirror::value::int_array();
+    for(int64_t i = 0; i < 10; ++i) { ints.push_back(mirror::value(i)); }
+    CUTE_ASSERT(ints.is_int_array());
+    CUTE_ASSERT(ints.is_any_array());
+    CUTE_ASSERT(!ints.is_array());
+    CUTE_ASSERT(ints.size() == 10);
+    CUTE_ASSERT(ints.as_int_array()[7] == 7);
+    CUTE_ASSERT(ints.at(7).as_int() == 7);
+
+    auto doubles = mirror::value::double_array();
+    doubles.as_double_array().assign({ 0.5, 1.5, 2.5 });
+    CUTE_ASSERT(doubles.size() == 3);
+    CUTE_ASSERT(doubles.at(1).as_double() == 1.5);
+
+    auto bools = mirror::value::bool_array();
+    bools.push_back(mirror::value(true));
+    bools.push_back(mirror::value(false));
+    CUTE_ASSERT(bools.is_bool_array());
+    CUTE_ASSERT(bools.at(0).as_bool());
+    CUTE_ASSERT(!bools.at(1).as_bool());
+
+    // adding a mixed element promotes to a generic array
+    ints.push_back(mirror::value("eleven"));
+    CUTE_ASSERT(ints.is_array());
+    CUTE_ASSERT(ints.size() == 11);
+    CUTE_ASSERT(ints.at(3).as_int() == 3);
+    CUTE_ASSERT(ints.at(10).as_string() == "eleven");
+
+    // as_array() promotes as well
+    CUTE_ASSERT(doubles.as_array().size() == 3);
+    CUTE_ASSERT(doubles.is_array());
+    CUTE_ASSERT(doubles.as_array()[2].as_double() == 2.5);
+
+    // const readers of a typed array go through size() and at(); the const
+    // as_array() only serves generic arrays as it can not promote
+    auto const& cbools = bools;
+    CUTE_ASSERT(cbools.is_typed_array());
+    CUTE_ASSERT(cbools.size() == 2);
+    CUTE_ASSERT(cbools.at(0).as_bool());
+    CUTE_ASSERT(cbools.as_bool_array().size() == 2);
+    auto const& cints = ints;
+    CUTE_ASSERT(!cints.is_typed_array());
+    CUTE_ASSERT(cints.as_array().size() == 11);
+    CUTE_ASSERT(cints.as_array()[4].as_int() == 4);
+    auto const one = mirror::value(int64_t(1));
+    CUTE_ASSERT(one.as_array().empty());
+
+    auto n = mirror::value();
+    n.push_back(mirror::value(1.0));
+    CUTE_ASSERT(n.is_array());
+    CUTE_ASSERT(n.size() == 1);
+}